@@ -42,11 +42,14 @@
 #pragma link C++ namespace TCConfig;
 #pragma link C++ namespace TCUtils;
 #pragma link C++ namespace TCFitUtils;
+#pragma link C++ namespace TCInstrument;
+#pragma link C++ class TCFitFuncPool+;
 #pragma link C++ class TCFileManager+;
 #pragma link C++ class TCReadConfig+;
 #pragma link C++ class TCConfigElement+;
 #pragma link C++ class TCReadARCalib+;
 #pragma link C++ class TCWriteARCalib+;
+#pragma link C++ class TCDataGenerator+;
 #pragma link C++ class TCARElement+;
 #pragma link C++ class TCLine+;
 #pragma link C++ class TCARTimeWalk+;
@@ -54,9 +57,12 @@
 #pragma link C++ class TCReadACQU+;
 #pragma link C++ class TCACQUFile+;
 #pragma link C++ class TCMySQLManager+;
+#pragma link C++ class TCQueryPattern+;
+#pragma link C++ class TCQueryLog+;
 #pragma link C++ class TCContainer+;
-#pragma link C++ class TCRun+;
-#pragma link C++ class TCCalibration+;
+#pragma link C++ class TCRun-;
+#pragma link C++ class TCCalibration-;
+#pragma link C++ class TCDataQueue+;
 #pragma link C++ class TCCalibData+;
 #pragma link C++ class TCCalibType+;
 #pragma link C++ class TCCalib+;
@@ -45,14 +45,15 @@ public:
         fHistoDirectory(0) { }
     virtual ~TCARHistoLoader() { }
 
-    static TH1* GetHisto(const TFile* f, const Char_t* hname, Bool_t detach = kTRUE);
+    static TH1* GetHisto(const TFile* f, const Char_t* hname, Bool_t detach = kTRUE, Char_t* keydata = 0);
+    static Char_t* ReadKey(TFile* f, const Char_t* hname);
     static TH1** GetHistos(const TFile* f, const Char_t* hpatt, Int_t& nhistos, Bool_t detach = kTRUE);
 
     void SetHistoDirectory(TDirectory* histodir) { fHistoDirectory = histodir; };
     const TDirectory* GetHistoDirectory() const { return fHistoDirectory; };
 
     TH1* GetHistoForRun(const Char_t* hname, Int_t runnumber, const Char_t* houtnamepatt = 0);
-    TH1* GetHistoForIndex(const Char_t* hname, Int_t index, const Char_t* houtnamepatt = 0);
+    TH1* GetHistoForIndex(const Char_t* hname, Int_t index, const Char_t* houtnamepatt = 0, Char_t* keydata = 0);
 
     TH1** GetHistosForRun(const Char_t* hpatt, Int_t runnumber, Int_t& nhistos, const Char_t* houtnamepatt = 0);
     TH1** GetHistosForIndex(const Char_t* hpatt, Int_t index, Int_t& nhistos, const Char_t* houtnamepatt = 0);
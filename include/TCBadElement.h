@@ -8,6 +8,9 @@
 //                                                                      //
 // Class containing an array of bad elements.                           //
 //                                                                      //
+// The sorted list of bad elements is backed by a bitset, hence         //
+// look-ups are O(1) and merging is linear in the number of elements.   //
+//                                                                      //
 // Have fun!                                                            //
 //                                                                      //
 //////////////////////////////////////////////////////////////////////////
@@ -25,17 +28,38 @@ protected:
     Int_t fNElem;                       // total number of elements
     Int_t fNBad;                        // number of bad elements
     Int_t* fBad;              //[fNBad] // list of bad elements
+    Int_t fNAlloc;                      //! allocated size of the list
+    Int_t fNWords;                      //! number of words of the bitset
+    UInt_t* fBits;                      //! bitset of bad elements
 
     static Int_t MergeNSort(Int_t nbad, const Int_t* bad, Int_t* &bad_sort, Int_t nelem = -1);
 
+    Bool_t IsInRange(Int_t elem) const { return elem >= 0 && (fNElem < 0 || elem < fNElem); }
+    Bool_t TestBadBit(Int_t elem) const
+    {
+        return elem >= 0 && (elem >> 5) < fNWords && (fBits[elem >> 5] >> (elem & 31)) & 1;
+    }
+    void SetBadBit(Int_t elem) { ExpandBits(elem+1); fBits[elem >> 5] |= 1u << (elem & 31); }
+    void ClearBadBit(Int_t elem) { if ((elem >> 5) < fNWords) fBits[elem >> 5] &= ~(1u << (elem & 31)); }
+    void ExpandBits(Int_t nbits);
+    void ExpandList(Int_t n);
+    void BuildList();
+
 public:
     TCBadElement()
       : fNElem(-1),
         fNBad(0),
-        fBad(0) { };
+        fBad(0),
+        fNAlloc(0),
+        fNWords(0),
+        fBits(0) { };
     TCBadElement(const TCBadElement &elem);
     TCBadElement(Int_t nbad, const Int_t* bad, Int_t nelem = -1);
-    virtual ~TCBadElement() { if (fBad) delete [] fBad; };
+    virtual ~TCBadElement()
+    {
+        if (fBad) delete [] fBad;
+        if (fBits) delete [] fBits;
+    };
 
     Int_t GetNElem() const { return fNElem; };
     Int_t GetNBad() const { return fNBad; };
@@ -47,11 +71,15 @@ public:
     void UnSNElem() { fNElem = -1; };
 
     Bool_t IsBad(Int_t bad) const;
+    Bool_t IsEqual(const TCBadElement &elem) const;
 
     Int_t AddBad(const Int_t bad);
     Int_t AddBad(const Int_t nbad, const Int_t* bad);
+    Int_t AddBad(const TCBadElement &elem);
 
     Int_t RemBad(Int_t &bad);
+    Int_t RemBad(Int_t nbad, const Int_t* bad);
+    Int_t RemBad(const TCBadElement &elem);
     void RemBad();
 
     ClassDef(TCBadElement, 0) // Bad element class
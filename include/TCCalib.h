@@ -19,6 +19,10 @@
 class TH1;
 class TF1;
 class TCanvas;
+class TCFitFuncPool;
+class TCFileManager;
+class TMutex;
+class TThread;
 
 class TCCalib : public TNamed
 {
@@ -41,6 +45,8 @@ protected:
     TH1* fMainHisto;                // main histogram
     TH1* fFitHisto;                 // fitting histogram
     TF1* fFitFunc;                  // fitting function
+    TCFitFuncPool* fFitFuncPool;    // pool of reusable fitting functions
+    Bool_t fFastPeakFit;            // use fast peak fitter instead of MINUIT
 
     TH1* fOverviewHisto;            // overview result histogram
 
@@ -54,13 +60,35 @@ protected:
 
     Int_t fNIgnore;                 // number of elements to ignore
     Int_t* fIgnore;                 // list of elements to ignore
+    Int_t fFitFormat[3];            // configuration handles of the fit histogram formatting
+
+    Int_t fPrefetch;                // number of elements prefetched after the current one
+    Char_t*** fPrefetchKeys;        //! key data read by the prefetch thread
+    TH1** fPrefetchHisto;           //! histograms prepared from the key data in the main thread
+    Bool_t* fPrefetchDone;          //! flags for elements already read or being read
+    Int_t fPrefetchIndex;           //! current element seen by the prefetch thread
+    Bool_t fPrefetchStop;           //! stop flag of the prefetch thread
+    TMutex* fPrefetchMutex;         //! mutex for the prefetch members
+    TMutex* fIOMutex;               //! mutex for the file access
+    TThread* fPrefetchThread;       //! prefetch thread
+    TTimer* fPrefetchTimer;         //! timer preparing the prefetched elements
 
     virtual void Init() = 0;
     virtual void Fit(Int_t elem) = 0;
     virtual void Calculate(Int_t elem) = 0;
     void SaveCanvas(TCanvas* c, const Char_t* name);
+    Int_t FitPeak(TH1* h, TF1* f, Option_t* option);
     Bool_t IsIgnored(Int_t elem);
 
+    virtual TCFileManager* GetElementFiles(Int_t elem, TString& outName) { return 0; }
+    virtual void PrepareElement(Int_t elem, TH1* h) { }
+    TH1* GetElementHisto(Int_t elem);
+    TH1* LoadElement(Int_t elem, Char_t** keys);
+    void DeleteElementKeys(Int_t elem);
+    void StartPrefetch();
+    void StopPrefetch();
+    static void* PrefetchThread(void* arg);
+
 public:
     TCCalib() : TNamed(),
                 fData(),
@@ -70,12 +98,15 @@ public:
                 fOldVal(0), fNewVal(0),
                 fAvr(0), fAvrDiff(0), fNcalc(0),
                 fConvergenceFactor(1),
-                fMainHisto(0), fFitHisto(0), fFitFunc(0),
+                fMainHisto(0), fFitHisto(0), fFitFunc(0), fFitFuncPool(0), fFastPeakFit(kFALSE),
                 fOverviewHisto(0),
                 fCanvasFit(0), fCanvasResult(0),
                 fTimer(0), fTimerRunning(kFALSE),
                 fIsReFit(kFALSE),
-                fNIgnore(0), fIgnore(0) { }
+                fNIgnore(0), fIgnore(0),
+                fPrefetch(0), fPrefetchKeys(0), fPrefetchHisto(0), fPrefetchDone(0),
+                fPrefetchIndex(0), fPrefetchStop(kFALSE),
+                fPrefetchMutex(0), fIOMutex(0), fPrefetchThread(0), fPrefetchTimer(0) { }
     TCCalib(const Char_t* name, const Char_t* title,
             const Char_t* data, Int_t nElem)
         : TNamed(name, title),
@@ -85,12 +116,15 @@ public:
           fNelem(nElem), fCurrentElem(0),
           fOldVal(0), fNewVal(0),
           fAvr(0), fAvrDiff(0), fNcalc(0),
-          fMainHisto(0), fFitHisto(0), fFitFunc(0),
+          fMainHisto(0), fFitHisto(0), fFitFunc(0), fFitFuncPool(0), fFastPeakFit(kFALSE),
           fOverviewHisto(0),
           fCanvasFit(0), fCanvasResult(0),
           fTimer(0), fTimerRunning(kFALSE),
           fIsReFit(kFALSE),
-          fNIgnore(0), fIgnore(0) { }
+          fNIgnore(0), fIgnore(0),
+          fPrefetch(0), fPrefetchKeys(0), fPrefetchHisto(0), fPrefetchDone(0),
+          fPrefetchIndex(0), fPrefetchStop(kFALSE),
+          fPrefetchMutex(0), fIOMutex(0), fPrefetchThread(0), fPrefetchTimer(0) { }
     virtual ~TCCalib();
 
     virtual void WriteValues();
@@ -105,6 +139,7 @@ public:
     virtual void ReFit();
     void Ignore();
     void StopProcessing();
+    void PrepareNext();
 
     TString GetCalibData() { return fData; }
 
@@ -45,10 +45,23 @@ private:
     Bool_t fUseEnergyWeight;            // flag for energy weight
     Bool_t fUsePointDensityWeight;      // flag for energy weight
     WalkCorrType_t fWalkType;           // correction type
+    Bool_t fBatchFit;                   // flag for batch slice fitting
+    TH1** fBatchHisto;                  // histograms loaded in batch mode
+    Int_t* fBatchNPoint;                // number of batch fit points (-1 if none)
+    Double_t** fBatchEnergy;            // energies of batch fit points
+    Double_t** fBatchMean;              // time means of batch fit points
+    Double_t** fBatchError;             // time mean errors of batch fit points
+    Double_t fSliceLow;                 // lower energy limit of the slice fits
+    Double_t fSliceHigh;                // upper energy limit of the slice fits
+
+    void FitSlicesBatch(Double_t lowLimit, Double_t highLimit);
+    void DeleteBatch();
 
     virtual void Init();
     virtual void Fit(Int_t elem);
     virtual void Calculate(Int_t elem);
+    virtual TCFileManager* GetElementFiles(Int_t elem, TString& outName);
+    virtual void PrepareElement(Int_t elem, TH1* h);
 
 public:
     TCCalibCBTimeWalk();
@@ -32,6 +32,7 @@ private:
     virtual void Init();
     virtual void Fit(Int_t elem);
     virtual void Calculate(Int_t elem);
+    virtual TCFileManager* GetElementFiles(Int_t elem, TString& outName);
 
     void ReadADC();
 
@@ -18,6 +18,8 @@
 
 #include "TNamed.h"
 
+class TTimer;
+
 class TCCalibRun : public TNamed
 {
 
@@ -36,6 +38,10 @@ protected:
 
     static Bool_t fIsStarted;           // is started flag
     Bool_t fIsReProcess;                // re-process flag
+    Bool_t fIsHeadless;                 // headless flag (no canvases, no GUI processing)
+
+    Int_t fPrefetch;                    // number of runs prepared ahead of the current run
+    TTimer* fPrefetchTimer;         //! // timer preparing the next runs while idle
 
     //---------------------------- member methods ------------------------------
 
@@ -48,6 +54,10 @@ protected:
     virtual void ProcessCurr() = 0;
     virtual void SaveValCurr() = 0;
     virtual void CleanUpCurr() = 0;
+    virtual Bool_t PrepareRun(Int_t index) { return kFALSE; }
+
+    // prefetch functions
+    void StartPrefetchTimer();
 
     // graphic functions
     virtual void UpdateCanvas() { }
@@ -57,21 +67,27 @@ public:
         : TNamed(),
           fCalibration(0), fCalibData(0), fIsTrueCalib(kFALSE),
           fNRuns(0), fRuns(0), fIndex(0),
-          fIsReProcess(kFALSE) { }
+          fIsReProcess(kFALSE), fIsHeadless(kFALSE),
+          fPrefetch(0), fPrefetchTimer(0) { }
     TCCalibRun(const Char_t* name, const Char_t* title, const Char_t* data, Bool_t istruecalib = kFALSE)
         : TNamed(name, title),
           fCalibration(0), fCalibData(new TString(data)), fIsTrueCalib(istruecalib),
           fNRuns(0), fRuns(0), fIndex(0),
-          fIsReProcess(kFALSE) { }
+          fIsReProcess(kFALSE), fIsHeadless(kFALSE),
+          fPrefetch(0), fPrefetchTimer(0) { }
     virtual ~TCCalibRun();
 
     void SetIsTrueCalib(Bool_t istruecalib = kTRUE) { fIsTrueCalib = istruecalib; }
     virtual Bool_t IsTrueCalib() const { return fIsTrueCalib; }
 
+    void SetHeadless(Bool_t headless = kTRUE) { fIsHeadless = headless; }
+    Bool_t IsHeadless() const { return fIsHeadless; }
+
     // start functions
     Bool_t Start(Int_t nruns, const Int_t* runs);
     Bool_t Start(const Char_t* calibration);
     Bool_t IsStarted() { return fIsStarted; }
+    void Stop();
 
     // navigation functions
     virtual void ProcessAuto(Bool_t start = kTRUE, Int_t msecDelay = -1);
@@ -80,6 +96,7 @@ public:
     virtual void Next();
     virtual void ReProcess();
     virtual void Skip();
+    void PrepareNext();
     virtual void Finish() { }
     virtual Bool_t Write() = 0;
 
@@ -27,6 +27,8 @@ class TH2;
 class TCanvas;
 class TCBadScRElement;
 class TCARHistoLoader;
+class TMutex;
+class TThread;
 
 class TCCalibRunBadScR : public TCCalibRun
 {
@@ -36,6 +38,17 @@ protected:
 
     TCARHistoLoader* fHistoLoader;      //         histo loader
     Bool_t fLoadHistosInAdvance;        //         load histos in advance (and keep in memory)
+    Int_t fCacheSize;                   //         number of runs kept in memory before the current run (paging mode)
+
+    Char_t** fPageMain;                 //!        key data of the main histos read by the prefetch thread
+    Char_t** fPageScaler;               //!        key data of the scaler histos read by the prefetch thread
+    Bool_t* fPageDone;                  //!        flags for runs already loaded or being loaded
+    Int_t fPageIndex;                   //!        current run index seen by the prefetch thread
+    Int_t fPageLoading;                 //!        run index being loaded by the prefetch thread
+    Bool_t fPrefetchStop;               //!        stop flag of the prefetch thread
+    TMutex* fPageMutex;                 //!        mutex for the prefetch members
+    TMutex* fIOMutex;                   //!        mutex for file access
+    TThread* fPrefetchThread;           //!        prefetch thread
 
     const Char_t* fMainHistoName;       //         name of main histo
     const Char_t* fScalerHistoName;     //         name of scaler histo
@@ -80,6 +93,9 @@ protected:
     TCanvas* fCanvasOverview;           //         overview canvas
 
     const Char_t* fCalibMethod;         //         automatic calibration method name
+    Double_t fDetectTolerance;          //         relative tolerance of the automatic methods
+    Double_t fDetectNSigma;             //         significance threshold of the automatic methods
+    Int_t fDetectWindow;                //         window size of the changepoint method
 
     //---------------------------- member methods ------------------------------
 
@@ -87,6 +103,16 @@ protected:
     void LoadHistos(Int_t i);
     void LoadScalerHistos(Int_t i);
     void NormalizeHisto(Int_t i);
+    void NormalizeHistos(Int_t first, Int_t last);
+    void UnloadHistos(Int_t i);
+
+    // paging functions
+    inline Bool_t IsPaging() const { return fPrefetch > 0 || fCacheSize > 0; }
+    inline Bool_t IsInPage(Int_t i) const { return i >= fIndex - fCacheSize && i <= fIndex + fPrefetch; }
+    void PageWindow();
+    void StartPrefetch();
+    void StopPrefetch();
+    static void* PrefetchThread(void* arg);
 
     void SetBadScalerReads(Int_t bscr1, Int_t bscr2);
     void SetBadScalerRead(Int_t bscr);
@@ -95,6 +121,12 @@ protected:
     void ChangeInterval(Int_t i);
 
     virtual void CalibMethodDefault();
+    virtual Bool_t IsDefaultGeneric() const { return kTRUE; }
+    void CalibMethodData(Int_t method);
+    TH1* GetDetectHisto(Int_t i, Int_t method);
+    Bool_t DetectSequential();
+    Bool_t DetectParallel(Int_t method);
+    Bool_t WriteDetectReport(const Char_t* report, const Char_t* method) const;
 
     void UpdateOverviewHisto();
 
@@ -107,14 +139,26 @@ protected:
     virtual void ProcessCurr();
     virtual void SaveValCurr();
     virtual void CleanUpCurr();
+    virtual Bool_t PrepareRun(Int_t index);
 
     // graphic functions
     virtual void UpdateCanvas();
 
 public:
+    enum EDetectMethod
+    {
+        kDetectDefault,                 // iterative rejection of deviations from the mean
+        kDetectMedianMAD,               // robust rejection using median and MAD
+        kDetectChangepoint,             // sliding-window changepoint test
+        kDetectUnknown
+    };
+
     TCCalibRunBadScR()
       : TCCalibRun(),
-        fHistoLoader(0), fLoadHistosInAdvance(kTRUE),
+        fHistoLoader(0), fLoadHistosInAdvance(kTRUE), fCacheSize(0),
+        fPageMain(0), fPageScaler(0), fPageDone(0),
+        fPageIndex(0), fPageLoading(-1), fPrefetchStop(kFALSE),
+        fPageMutex(0), fIOMutex(0), fPrefetchThread(0),
         fMainHistoName(0), fScalerHistoName(0),
         fMainHistos(0), fProjHistos(0), fProjNormHistos(0),
         fScalerP2Histos(0), fScalerLiveHistos(), fScalerFreeHistos(0),
@@ -129,10 +173,14 @@ public:
         fRunMarker(0),
         fLastMouseBin(0), fUserInterval(100), fUserLastInterval(1),
         fCanvasMain(0), fCanvasOverview(0),
-        fCalibMethod(0) { }
+        fCalibMethod(0),
+        fDetectTolerance(0.1), fDetectNSigma(5), fDetectWindow(10) { }
     TCCalibRunBadScR(const Char_t* name, const Char_t* title, const Char_t* data, Bool_t istruecalib)
       : TCCalibRun(name, title, data, istruecalib),
-        fHistoLoader(0), fLoadHistosInAdvance(kTRUE),
+        fHistoLoader(0), fLoadHistosInAdvance(kTRUE), fCacheSize(0),
+        fPageMain(0), fPageScaler(0), fPageDone(0),
+        fPageIndex(0), fPageLoading(-1), fPrefetchStop(kFALSE),
+        fPageMutex(0), fIOMutex(0), fPrefetchThread(0),
         fMainHistoName(0), fScalerHistoName(0),
         fMainHistos(0), fProjHistos(0), fProjNormHistos(0),
         fScalerP2Histos(0), fScalerLiveHistos(), fScalerFreeHistos(0),
@@ -147,11 +195,26 @@ public:
         fRunMarker(0),
         fLastMouseBin(0), fUserInterval(100), fUserLastInterval(1),
         fCanvasMain(0), fCanvasOverview(0),
-        fCalibMethod(0) { }
+        fCalibMethod(0),
+        fDetectTolerance(0.1), fDetectNSigma(5), fDetectWindow(10) { }
     virtual ~TCCalibRunBadScR();
 
     virtual Bool_t Write();
 
+    // normalization kernel
+    static void NormalizeScR(Int_t n, const Double_t* hits, const Double_t* sc_p2,
+                             const Double_t* sc_live, const Double_t* sc_free, Double_t* out);
+
+    // headless detection
+    Bool_t DetectAll(const Char_t* method = 0, const Char_t* report = 0);
+    Int_t Detect(Int_t method, Int_t n, const Double_t* y, Bool_t* bad) const;
+
+    static Int_t GetDetectMethod(const Char_t* name);
+    static Int_t DetectDefault(Int_t n, const Double_t* y, Bool_t* bad, Double_t tol = 0.1);
+    static Int_t DetectMedianMAD(Int_t n, const Double_t* y, Bool_t* bad, Double_t nsigma = 5);
+    static Int_t DetectChangepoint(Int_t n, const Double_t* y, Bool_t* bad,
+                                   Int_t win = 10, Double_t nsigma = 5, Double_t tol = 0.1);
+
     virtual void EventHandler(Int_t event, Int_t ox, Int_t oy, TObject* selected);
 
     ClassDef(TCCalibRunBadScR, 0) // Bad scaler read calibration module class
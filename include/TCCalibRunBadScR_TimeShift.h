@@ -24,6 +24,7 @@ class TCCalibRunBadScR_TimeShift : public TCCalibRunBadScR
 
 protected:
     virtual void CalibMethodDefault();
+    virtual Bool_t IsDefaultGeneric() const { return kFALSE; }
 
 public:
     TCCalibRunBadScR_TimeShift()
@@ -32,8 +32,27 @@ private:
     virtual void Fit(Int_t elem);
     virtual void Calculate(Int_t elem);
 
+protected:
+    // detector specific fit policy (set in InitFitPolicy())
+    Double_t fFitRange;                 // half range of the first fit iteration
+    Double_t fFitFactor;                // sigma factor of the range of the second fit iteration
+    Bool_t fFitBackground;              // fit linear background
+    Double_t fFitSigma;                 // start value of sigma
+    Double_t fFitSigmaMin;              // lower limit of sigma
+    Double_t fFitSigmaMax;              // upper limit of sigma
+    TString fTimeGainData;              // calibration data of individual TDC gains
+    Bool_t fUseTimeGain;                // use TDC gain (otherwise add peak position directly)
+    Bool_t fInvertPWO;                  // invert offset correction for TAPS PWO elements
+    Bool_t fMarkCBHoles;                // mark CB holes in the user information
+
+    virtual void InitFitPolicy();
+
 public:
-    TCCalibTime() : TCCalib(), fTimeGain(0), fMean(0), fLine(0) { }
+    TCCalibTime() : TCCalib(), fTimeGain(0), fMean(0), fLine(0),
+                    fFitRange(3.8), fFitFactor(2.5), fFitBackground(kFALSE),
+                    fFitSigma(8), fFitSigmaMin(0), fFitSigmaMax(20),
+                    fTimeGainData(), fUseTimeGain(kTRUE),
+                    fInvertPWO(kFALSE), fMarkCBHoles(kFALSE) { }
     TCCalibTime(const Char_t* name, const Char_t* title, const Char_t* data,
                 Int_t nElem);
     virtual ~TCCalibTime();
@@ -44,6 +63,17 @@ public:
 class TCCalibTaggerTime : public TCCalibTime
 {
 
+protected:
+    virtual void InitFitPolicy()
+    {
+        TCCalibTime::InitFitPolicy();
+        fFitRange = 5;
+        fFitFactor = 10;
+        fFitBackground = kTRUE;
+        fFitSigmaMin = 0.01;
+        fFitSigmaMax = 2;
+    }
+
 public:
     TCCalibTaggerTime()
         : TCCalibTime("Tagger.Time", "Tagger time calibration",
@@ -57,6 +87,13 @@ public:
 class TCCalibCBTime : public TCCalibTime
 {
 
+protected:
+    virtual void InitFitPolicy()
+    {
+        TCCalibTime::InitFitPolicy();
+        fMarkCBHoles = kTRUE;
+    }
+
 public:
     TCCalibCBTime()
         : TCCalibTime("CB.Time", "CB time calibration",
@@ -70,6 +107,16 @@ public:
 class TCCalibCBRiseTime : public TCCalibTime
 {
 
+protected:
+    virtual void InitFitPolicy()
+    {
+        TCCalibTime::InitFitPolicy();
+        fFitFactor = 10;
+        fFitBackground = kTRUE;
+        fUseTimeGain = kFALSE;
+        fMarkCBHoles = kTRUE;
+    }
+
 public:
     TCCalibCBRiseTime()
         : TCCalibTime("CB.RiseTime", "CB rise time calibration",
@@ -83,6 +130,20 @@ public:
 class TCCalibTAPSTime : public TCCalibTime
 {
 
+protected:
+    virtual void InitFitPolicy()
+    {
+        TCCalibTime::InitFitPolicy();
+        fFitRange = 3;
+        fFitFactor = 1.5;
+        fFitBackground = kTRUE;
+        fFitSigma = 0.5;
+        fFitSigmaMin = 0.001;
+        fFitSigmaMax = 1;
+        fTimeGainData = "Data.TAPS.T1";
+        fInvertPWO = kTRUE;
+    }
+
 public:
     TCCalibTAPSTime()
         : TCCalibTime("TAPS.Time", "TAPS time calibration",
@@ -96,6 +157,13 @@ public:
 class TCCalibPIDTime : public TCCalibTime
 {
 
+protected:
+    virtual void InitFitPolicy()
+    {
+        TCCalibTime::InitFitPolicy();
+        fFitFactor = 1.5;
+    }
+
 public:
     TCCalibPIDTime()
         : TCCalibTime("PID.Time", "PID time calibration",
@@ -109,6 +177,14 @@ public:
 class TCCalibVetoTime : public TCCalibTime
 {
 
+protected:
+    virtual void InitFitPolicy()
+    {
+        TCCalibTime::InitFitPolicy();
+        fFitBackground = kTRUE;
+        fTimeGainData = "Data.Veto.T1";
+    }
+
 public:
     TCCalibVetoTime()
         : TCCalibTime("Veto.Time", "Veto time calibration",
@@ -122,6 +198,13 @@ public:
 class TCCalibPizzaTime : public TCCalibTime
 {
 
+protected:
+    virtual void InitFitPolicy()
+    {
+        TCCalibTime::InitFitPolicy();
+        fFitFactor = 1.5;
+    }
+
 public:
     TCCalibPizzaTime()
         : TCCalibTime("Pizza.Time", "Pizza time calibration",
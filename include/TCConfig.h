@@ -45,10 +45,13 @@ namespace TCConfig
     extern const Char_t* kCalibMainTableFormat;
     extern const Char_t* kCalibDataTableHeader;
     extern const Char_t* kCalibDataTableSettings;
+    extern const Char_t* kCalibBadScRTableName;
+    extern const Char_t* kCalibBadScRTableFormat;
 
     // version numbers etc.
     extern const Char_t kCaLibVersion[];
     extern const Int_t kContainerFormatVersion;
+    extern const Int_t kContainerFormatVersionOld;
     extern const Char_t kCaLibDumpName[];
     extern const Int_t kNScREventHBin;
 
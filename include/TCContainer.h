@@ -16,131 +16,123 @@
 
 #include "TNamed.h"
 
+class TFile;
+class TTree;
+
 class TCRun : public TObject
 {
 
 private:
     Int_t fRun;                     // run number
-    Char_t fPath[256];              // file path
-    Char_t fFileName[256];          // file name
-    Char_t fTime[256];              // time
-    Char_t fDescription[256];       // description
-    Char_t fRunNote[256];           // run note
+    TString fPath;                  // file path
+    TString fFileName;              // file name
+    TString fTime;                  // time
+    TString fDescription;           // description
+    TString fRunNote;               // run note
     Long64_t fSize;                 // file size
     Int_t fNScR;                    // number of scaler reads
-    Char_t fScRBad[65536];          // list of bad scaler reads
-    Char_t fTarget[20];             // target
-    Char_t fTargetPol[128];         // target polarization
+    TString fScRBad;                // list of bad scaler reads
+    TString fTarget;                // target
+    TString fTargetPol;             // target polarization
     Double_t fTargetPolDeg;         // target polarization degree
-    Char_t fBeamPol[128];           // beam polarization
+    TString fBeamPol;               // beam polarization
     Double_t fBeamPolDeg;           // beam polarization degree
 
 public:
     TCRun() : TObject()
     {
         fRun = 0;
-        fPath[0] = '\0';
-        fFileName[0] = '\0';
-        fTime[0] = '\0';
-        fDescription[0] = '\0';
-        fRunNote[0] = '\0';
         fSize = 0;
         fNScR = 0;
-        fScRBad[0] = '\0';
-        fTarget[0] = '\0';
-        fTargetPol[0] = '\0';
         fTargetPolDeg = 0;
-        fBeamPol[0] = '\0';
         fBeamPolDeg = 0;
     }
     virtual ~TCRun() { }
 
     void SetRun(Int_t run) { fRun = run; }
-    void SetPath(const Char_t* path) { strcpy(fPath, path); }
-    void SetFileName(const Char_t* fname) { strcpy(fFileName, fname); }
-    void SetTime(const Char_t* time) { strcpy(fTime, time); }
-    void SetDescription(const Char_t* desc) { strcpy(fDescription, desc); }
-    void SetRunNote(const Char_t* rnote) { strcpy(fRunNote, rnote); }
+    void SetPath(const Char_t* path) { fPath = path; }
+    void SetFileName(const Char_t* fname) { fFileName = fname; }
+    void SetTime(const Char_t* time) { fTime = time; }
+    void SetDescription(const Char_t* desc) { fDescription = desc; }
+    void SetRunNote(const Char_t* rnote) { fRunNote = rnote; }
     void SetSize(Long64_t size) { fSize = size; }
     void SetNScalerReads(Int_t n) { fNScR = n; }
-    void SetBadScalerReads(const Char_t* b) { strcpy(fScRBad, b); }
-    void SetTarget(const Char_t* target) { strcpy(fTarget, target); }
-    void SetTargetPol(const Char_t* targetPol) { strcpy(fTargetPol, targetPol); }
+    void SetBadScalerReads(const Char_t* b) { fScRBad = b; }
+    void SetTarget(const Char_t* target) { fTarget = target; }
+    void SetTargetPol(const Char_t* targetPol) { fTargetPol = targetPol; }
     void SetTargetPolDeg(Double_t deg) { fTargetPolDeg = deg; }
-    void SetBeamPol(const Char_t* beamPol) { strcpy(fBeamPol, beamPol); }
+    void SetBeamPol(const Char_t* beamPol) { fBeamPol = beamPol; }
     void SetBeamPolDeg(Double_t deg) { fBeamPolDeg = deg; }
 
     Int_t GetRun() const { return fRun; }
-    const Char_t* GetPath() const { return fPath; }
-    const Char_t* GetFileName() const { return fFileName; }
-    const Char_t* GetTime() const { return fTime; }
-    const Char_t* GetDescription() const { return fDescription; }
-    const Char_t* GetRunNote() const { return fRunNote; }
+    const Char_t* GetPath() const { return fPath.Data(); }
+    const Char_t* GetFileName() const { return fFileName.Data(); }
+    const Char_t* GetTime() const { return fTime.Data(); }
+    const Char_t* GetDescription() const { return fDescription.Data(); }
+    const Char_t* GetRunNote() const { return fRunNote.Data(); }
     Long64_t GetSize() const { return fSize; }
     Int_t GetNScalerReads() const { return fNScR; }
-    const Char_t* GetBadScalerReads() const { return fScRBad; }
-    const Char_t* GetTarget() const { return fTarget; }
-    const Char_t* GetTargetPol() const { return fTargetPol; }
+    const Char_t* GetBadScalerReads() const { return fScRBad.Data(); }
+    const Char_t* GetTarget() const { return fTarget.Data(); }
+    const Char_t* GetTargetPol() const { return fTargetPol.Data(); }
     Double_t GetTargetPolDeg() const { return fTargetPolDeg; }
-    const Char_t* GetBeamPol() const { return fBeamPol; }
+    const Char_t* GetBeamPol() const { return fBeamPol.Data(); }
     Double_t GetBeamPolDeg() const { return fBeamPolDeg; }
 
     virtual void Print(Option_t* option = "") const
     {
         printf("CaLib Run Information\n");
         printf("Run               : %d\n", fRun);
-        printf("Path              : %s\n", fPath);
-        printf("File name         : %s\n", fFileName);
-        printf("Time              : %s\n", fTime);
-        printf("Description       : %s\n", fDescription);
-        printf("Run note          : %s\n", fRunNote);
+        printf("Path              : %s\n", fPath.Data());
+        printf("File name         : %s\n", fFileName.Data());
+        printf("Time              : %s\n", fTime.Data());
+        printf("Description       : %s\n", fDescription.Data());
+        printf("Run note          : %s\n", fRunNote.Data());
         printf("Size in bytes     : %lld\n", fSize);
         printf("# of scaler reads : %d\n", fNScR);
-        printf("Bad scaler reads  : %s\n", fScRBad);
-        printf("Target            : %s\n", fTarget);
-        printf("Target pol.       : %s\n", fTargetPol);
+        printf("Bad scaler reads  : %s\n", fScRBad.Data());
+        printf("Target            : %s\n", fTarget.Data());
+        printf("Target pol.       : %s\n", fTargetPol.Data());
         printf("Target pol. deg.  : %lf\n", fTargetPolDeg);
-        printf("Beam pol.         : %s\n", fBeamPol);
+        printf("Beam pol.         : %s\n", fBeamPol.Data());
         printf("Beam pol. deg.    : %lf\n", fBeamPolDeg);
         printf("\n");
     }
 
-    ClassDef(TCRun, 1) // Run storage class
+    friend class TCContainer;
+
+    ClassDef(TCRun, 2) // Run storage class
 };
 
 class TCCalibration : public TObject
 {
 
 private:
-    Char_t fData[256];                  // calibration data type
-    Char_t fCalibration[256];           // name
-    Char_t fDescription[256];           // description
+    TString fData;                      // calibration data type
+    TString fCalibration;               // name
+    TString fDescription;               // description
     Int_t fFirstRun;                    // first run
     Int_t fLastRun;                     // last run
-    Char_t fChangeTime[64];             // fill time
+    TString fChangeTime;                // fill time
     Int_t fNpar;                        // number of parameters
     Double_t* fPar;                     //[fNpar] parameters
 
 public:
     TCCalibration() : TObject()
     {
-        fData[0] = '\0';
-        fCalibration[0] = '\0';
-        fDescription[0] = '\0';
         fFirstRun = 0;
         fLastRun = 0;
-        fChangeTime[0] = '\0';
         fNpar = 0;
         fPar = 0;
     }
     virtual ~TCCalibration() { if (fPar) delete [] fPar; }
 
-    void SetCalibData(const Char_t* data)  { strcpy(fData, data); }
-    void SetCalibration(const Char_t* calib) { strcpy(fCalibration, calib); }
-    void SetDescription(const Char_t* desc) { strcpy(fDescription, desc); }
+    void SetCalibData(const Char_t* data)  { fData = data; }
+    void SetCalibration(const Char_t* calib) { fCalibration = calib; }
+    void SetDescription(const Char_t* desc) { fDescription = desc; }
     void SetFirstRun(Int_t run) { fFirstRun = run; }
     void SetLastRun(Int_t run) { fLastRun = run; }
-    void SetChangeTime(const Char_t* ctime) { strcpy(fChangeTime, ctime); }
+    void SetChangeTime(const Char_t* ctime) { fChangeTime = ctime; }
     void SetParameters(Int_t npar, Double_t* par)
     {
         fNpar = npar;
@@ -149,31 +141,33 @@ public:
         for (Int_t i = 0; i < fNpar; i++) fPar[i] = par[i];
     }
 
-    const Char_t* GetCalibData() const { return fData; }
-    const Char_t* GetCalibration() const { return fCalibration; }
-    const Char_t* GetDescription() const { return fDescription; }
+    const Char_t* GetCalibData() const { return fData.Data(); }
+    const Char_t* GetCalibration() const { return fCalibration.Data(); }
+    const Char_t* GetDescription() const { return fDescription.Data(); }
     Int_t GetFirstRun() const { return fFirstRun; }
     Int_t GetLastRun() const { return fLastRun; }
-    const Char_t* GetChangeTime() const { return fChangeTime; }
+    const Char_t* GetChangeTime() const { return fChangeTime.Data(); }
     Int_t GetNParameters() const { return fNpar; }
     Double_t* GetParameters() const { return fPar; }
 
     virtual void Print(Option_t* option = "") const
     {
         printf("CaLib Calibration Information\n");
-        printf("Calibration data : %s\n", fData);
-        printf("Calibration      : %s\n", fCalibration);
-        printf("Description      : %s\n", fDescription);
+        printf("Calibration data : %s\n", fData.Data());
+        printf("Calibration      : %s\n", fCalibration.Data());
+        printf("Description      : %s\n", fDescription.Data());
         printf("First run        : %d\n", fFirstRun);
         printf("Last run         : %d\n", fLastRun);
-        printf("Change time      : %s\n", fChangeTime);
+        printf("Change time      : %s\n", fChangeTime.Data());
         printf("Number of par.   : %d\n", fNpar);
         for (Int_t i = 0; i < fNpar; i++) printf("Par_%03d          : %.17g\n", i, fPar[i]);
         printf("\n");
         printf("\n");
     }
 
-    ClassDef(TCCalibration, 1) // Calibration storage class
+    friend class TCContainer;
+
+    ClassDef(TCCalibration, 2) // Calibration storage class
 };
 
 class TCContainer : public TNamed
@@ -183,9 +177,16 @@ private:
     Int_t fVersion;                 // container format version
     TList* fRuns;                   //-> run list
     TList* fCalibrations;           //-> calibration list
+    TFile* fFile;                   //! file used for incremental saving
+    TTree* fRunTree;                //! run tree used for incremental I/O
+    TTree* fCalibTree;              //! calibration tree used for incremental I/O
+
+    void SetRunAddresses(TCRun* r);
+    void SetCalibrationAddresses(TCCalibration* c);
 
 public:
-    TCContainer() : TNamed(), fVersion(0), fRuns(0), fCalibrations(0) { }
+    TCContainer() : TNamed(), fVersion(0), fRuns(0), fCalibrations(0),
+                    fFile(0), fRunTree(0), fCalibTree(0) { }
     TCContainer(const Char_t* name);
     virtual ~TCContainer();
 
@@ -201,11 +202,24 @@ public:
     TCCalibration* AddCalibration(const Char_t* calibration);
     Bool_t Save(const Char_t* filename, Bool_t silence = kFALSE);
 
+    Bool_t BeginSave(const Char_t* filename, Bool_t silence = kFALSE);
+    Bool_t SaveRun(TCRun* r);
+    Bool_t SaveCalibration(TCCalibration* c);
+    Bool_t EndSave(Bool_t silence = kFALSE);
+
+    Bool_t BeginLoad(TFile* f);
+    Long64_t GetNSavedRuns() const;
+    Long64_t GetNSavedCalibrations() const;
+    Bool_t LoadRun(Long64_t n, TCRun* r);
+    Bool_t LoadCalibration(Long64_t n, TCCalibration* c);
+    Bool_t LoadAll();
+    void EndLoad();
+
     virtual void Print(Option_t* option = "") const;
     void ShowRuns();
     void ShowCalibrations();
 
-    ClassDef(TCContainer, 1) // CaLib storage class
+    ClassDef(TCContainer, 2) // CaLib storage class
 };
 
 #endif
@@ -0,0 +1,87 @@
+/*************************************************************************
+ * Author: Dominik Werthmueller
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TCDataGenerator                                                      //
+//                                                                      //
+// Generate synthetic AcquRoot histogram files with known peak          //
+// positions and bad scaler reads for benchmarks and tests.             //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+
+#ifndef TCDATAGENERATOR_H
+#define TCDATAGENERATOR_H
+
+#include "TString.h"
+
+class TList;
+class TRandom;
+
+class TCDataGenerator
+{
+
+private:
+    TString fFilePatt;                  // output file pattern ('RUN' replaced by the run number)
+    Int_t fNTimeBins;                   // number of time bins
+    Double_t fTimeMin;                  // lower time limit [ns]
+    Double_t fTimeMax;                  // upper time limit [ns]
+    Double_t fPeakSigma;                // time peak width [ns]
+    Double_t fPeakCounts;               // counts in the peak per element
+    Double_t fBackground;               // background counts per bin
+    Int_t fNScR;                        // number of scaler reads per run
+    Double_t fBadScRFraction;           // fraction of bad scaler reads
+    Double_t fBadScRFactor;             // hit rate factor of bad scaler reads
+    Bool_t fNoise;                      // Poisson fluctuations toggle
+    UInt_t fSeed;                       // random seed
+
+    UInt_t GetHash(Int_t run, Int_t i) const;
+    Double_t Sample(TRandom* rand, Double_t mu) const;
+    void AddTimeHistos(TList* list, TRandom* rand) const;
+    void AddBadScRHistos(TList* list, TRandom* rand, Int_t run) const;
+
+public:
+    TCDataGenerator()
+        : fFilePatt(), fNTimeBins(200), fTimeMin(-100), fTimeMax(100),
+          fPeakSigma(4), fPeakCounts(1000), fBackground(2),
+          fNScR(100), fBadScRFraction(0.05), fBadScRFactor(0.3),
+          fNoise(kTRUE), fSeed(4711) { }
+    TCDataGenerator(const Char_t* filePatt);
+    virtual ~TCDataGenerator() { }
+
+    void SetTimeBinning(Int_t n, Double_t min, Double_t max)
+    {
+        fNTimeBins = n;
+        fTimeMin = min;
+        fTimeMax = max;
+    }
+    void SetPeak(Double_t counts, Double_t sigma, Double_t background)
+    {
+        fPeakCounts = counts;
+        fPeakSigma = sigma;
+        fBackground = background;
+    }
+    void SetScalerReads(Int_t nScR, Double_t badFraction, Double_t badFactor = 0.3)
+    {
+        fNScR = nScR;
+        fBadScRFraction = badFraction;
+        fBadScRFactor = badFactor;
+    }
+    void SetNoise(Bool_t n) { fNoise = n; }
+    void SetSeed(UInt_t s) { fSeed = s; }
+
+    static Double_t GetPeakPosition(Int_t elem);
+    Bool_t IsBadScR(Int_t run, Int_t scr) const;
+    Int_t GetBadScR(Int_t run, Int_t* outBadScR) const;
+    Int_t GetNScR() const { return fNScR; }
+
+    Bool_t WriteRun(Int_t run) const;
+    Int_t WriteRuns(Int_t first_run, Int_t last_run) const;
+
+    ClassDef(TCDataGenerator, 0) // Synthetic AcquRoot file generator
+};
+
+#endif
+
@@ -0,0 +1,55 @@
+/*************************************************************************
+ * Author: Dominik Werthmueller
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TCDataQueue                                                          //
+//                                                                      //
+// Bounded thread-safe queue of objects passed between the stages of a  //
+// producer/consumer pipeline.                                          //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+
+#ifndef TCDATAQUEUE_H
+#define TCDATAQUEUE_H
+
+#include "TObject.h"
+
+class TList;
+class TMutex;
+class TCondition;
+
+class TCDataQueue : public TObject
+{
+
+private:
+    Int_t fCapacity;                    // maximum number of queued objects
+    Int_t fMaxSize;                     // maximum number of queued objects reached
+    Bool_t fClosed;                     // closed flag
+    TList* fList;                       // queued objects
+    TMutex* fMutex;                     // queue mutex
+    TCondition* fNotEmpty;              // signaled when an object was pushed or the queue was closed
+    TCondition* fNotFull;               // signaled when an object was popped or the queue was closed
+
+public:
+    TCDataQueue() : TObject(), fCapacity(0), fMaxSize(0), fClosed(kFALSE),
+                    fList(0), fMutex(0), fNotEmpty(0), fNotFull(0) { }
+    TCDataQueue(Int_t capacity);
+    virtual ~TCDataQueue();
+
+    Bool_t Push(TObject* obj);
+    TObject* Pop();
+    void Close();
+
+    Int_t GetCapacity() const { return fCapacity; }
+    Int_t GetMaxSize() const { return fMaxSize; }
+    Int_t GetSize() const;
+    Bool_t IsClosed() const;
+
+    ClassDef(TCDataQueue, 0) // Bounded thread-safe object queue
+};
+
+#endif
+
@@ -39,7 +39,10 @@ public:
                   Int_t nSet, Int_t* set, const Char_t* filePat = 0);
     virtual ~TCFileManager();
 
-    TH1* GetHistogram(const Char_t* name);
+    TH1* GetHistogram(const Char_t* name, Char_t** keys = 0);
+    Char_t** ReadKeys(const Char_t* name);
+    void DeleteKeys(Char_t** keys) const;
+    Int_t GetHistograms(Int_t n, const Char_t* const* names, TH1** outHistos);
 
     ClassDef(TCFileManager, 0) // Histogram building class
 };
@@ -0,0 +1,67 @@
+/*************************************************************************
+ * Author: Dominik Werthmueller
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TCFitFuncPool                                                        //
+//                                                                      //
+// Pool of compiled fit functions that are created once per module and  //
+// reset and reused for every element.                                  //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+
+#ifndef TCFITFUNCPOOL_H
+#define TCFITFUNCPOOL_H
+
+#include "TString.h"
+
+class TF1;
+
+class TCFitFuncPool
+{
+
+public:
+    enum EFitFuncType {
+        kGaus,              // gaus(0)
+        kGausPol1,          // gaus(0)+pol1(3)
+        kGausPol3,          // gaus(0)+pol3(3)
+        kPol1Gaus,          // pol1(0)+gaus(2)
+        kWalkDefault,       // [0] + [1] / (x + [2])^[3]
+        kWalkStrub,         // [0] + [1] / (x - 1)^[3] + x*[2]
+        kNFitFuncType
+    };
+    typedef EFitFuncType FitFuncType_t;
+
+private:
+    TString fName;                      // pool name (prefix of function names)
+    TF1* fFunc[kNFitFuncType];          // pooled functions
+
+    TF1* Create(FitFuncType_t type);
+
+public:
+    TCFitFuncPool() : fName() { for (Int_t i = 0; i < kNFitFuncType; i++) fFunc[i] = 0; }
+    TCFitFuncPool(const Char_t* name);
+    virtual ~TCFitFuncPool();
+
+    TF1* Get(FitFuncType_t type);
+    TF1* Get(FitFuncType_t type, Double_t xmin, Double_t xmax);
+    Bool_t Owns(const TF1* f) const;
+    FitFuncType_t GetType(const TF1* f) const;
+
+    static Bool_t GetPeakLayout(FitFuncType_t type, Int_t* outGausPar,
+                                Int_t* outBgPar, Int_t* outBgDeg);
+
+    static Double_t Gaus(Double_t* x, Double_t* par);
+    static Double_t GausPol1(Double_t* x, Double_t* par);
+    static Double_t GausPol3(Double_t* x, Double_t* par);
+    static Double_t Pol1Gaus(Double_t* x, Double_t* par);
+    static Double_t WalkDefault(Double_t* x, Double_t* par);
+    static Double_t WalkStrub(Double_t* x, Double_t* par);
+
+    ClassDef(TCFitFuncPool, 0) // Pool of compiled fit functions
+};
+
+#endif
+
@@ -27,6 +27,13 @@ namespace TCFitUtils
     TF1* GetBestChi2Func(TF1* f1, TF1* f);
     void RandomizeParameter(TF1* f, Int_t i);
     void RandomizeParameters(TF1* f, Bool_t* isrand = 0);
+    Int_t FitPeak(TH1* h, TF1* f, Int_t gausPar, Int_t bgPar, Int_t bgDeg,
+                  Int_t maxIter = 100);
+    Int_t FitPeak(Int_t n, const Double_t* x, const Double_t* y, const Double_t* w,
+                  Int_t npar, Double_t* par, Double_t* err,
+                  const Double_t* parMin, const Double_t* parMax,
+                  Int_t gausPar, Int_t bgPar, Int_t bgDeg,
+                  Double_t* outChi2 = 0, Int_t* outNDF = 0, Int_t maxIter = 100);
 }
 
 #endif
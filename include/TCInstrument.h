@@ -0,0 +1,89 @@
+/*************************************************************************
+ * Author: Dominik Werthmueller
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TCInstrument                                                         //
+//                                                                      //
+// CaLib timing and counter instrumentation namespace.                  //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+
+#ifndef TCINSTRUMENT_H
+#define TCINSTRUMENT_H
+
+#include "Rtypes.h"
+
+// instrumentation counters
+enum EInstrCounter
+{
+    kINSTR_QUERIES,             // SQL queries and commands sent
+    kINSTR_ROWS,                // SQL result rows fetched
+    kINSTR_BYTES_READ,          // bytes read from ROOT and calibration files
+    kINSTR_FILES_OPENED,        // ROOT and calibration files opened
+    kINSTR_HISTOS_SUMMED,       // histograms added to summed-up histograms
+    kINSTR_FITS,                // fits performed
+    kINSTR_FIT_ITERATIONS,      // fit iterations (function calls for MINUIT)
+    kINSTR_NCOUNTER
+};
+typedef EInstrCounter InstrCounter_t;
+
+namespace TCInstrument
+{
+    extern Bool_t gEnabled;
+
+    inline Bool_t IsEnabled() { return gEnabled; }
+    void Enable(const Char_t* reportFile = 0);
+    void Disable();
+    void Reset();
+    void Count(InstrCounter_t c, Long64_t n = 1);
+    Int_t GetStageID(const Char_t* name);
+    void AddStageTime(Int_t id, Long64_t nsec);
+    Long64_t GetTime();
+    Long64_t GetCounter(InstrCounter_t c);
+    const Char_t* GetCounterName(InstrCounter_t c);
+    void Print();
+    Bool_t WriteReport(const Char_t* filename);
+}
+
+// scoped stage timer
+class TCInstrumentScope
+{
+
+private:
+    Int_t fID;                  // stage id (-1 if disabled)
+    Long64_t fStart;            // start time [ns]
+
+    TCInstrumentScope(const TCInstrumentScope&);
+    TCInstrumentScope& operator=(const TCInstrumentScope&);
+
+public:
+    TCInstrumentScope(Int_t& id, const Char_t* name) : fID(-1), fStart(0)
+    {
+        // register the stage on the first use with enabled instrumentation
+        if (!TCInstrument::gEnabled) return;
+        if (id < 0) id = TCInstrument::GetStageID(name);
+        fID = id;
+        fStart = fID < 0 ? 0 : TCInstrument::GetTime();
+    }
+    ~TCInstrumentScope()
+    {
+        if (fID >= 0) TCInstrument::AddStageTime(fID, TCInstrument::GetTime() - fStart);
+    }
+};
+
+// count 'n' for the counter 'c' if the instrumentation is enabled
+#define TCINSTR_COUNT(c, n) \
+    do { if (TCInstrument::gEnabled) TCInstrument::Count(c, n); } while (0)
+
+// time the enclosing scope as the stage 'name' if the instrumentation is enabled
+#define TCINSTR_SCOPE_CAT2(a, b) a##b
+#define TCINSTR_SCOPE_CAT(a, b) TCINSTR_SCOPE_CAT2(a, b)
+#define TCINSTR_SCOPE(name) \
+    static Int_t TCINSTR_SCOPE_CAT(gInstrStage_, __LINE__) = -1; \
+    TCInstrumentScope TCINSTR_SCOPE_CAT(instrScope_, __LINE__)(TCINSTR_SCOPE_CAT(gInstrStage_, __LINE__), name)
+
+#endif
+
@@ -14,6 +14,8 @@
 #ifndef TCMYSQLMANAGER_H
 #define TCMYSQLMANAGER_H
 
+#include "TString.h"
+
 #include "TCConfig.h"
 
 class TSQLServer;
@@ -22,6 +24,8 @@ class THashList;
 class TList;
 class TCBadScRElement;
 class TCContainer;
+class TCDataQueue;
+class TFile;
 class TCCalibType;
 class TCCalibData;
 
@@ -72,8 +76,27 @@ private:
                          Int_t set1, Int_t set2);
 
     Bool_t ReadAllBadScR(Int_t run, TCBadScRElement**& badscr_data, Int_t& ndata);
+    Bool_t WriteBadScR(Int_t run, const Char_t* data, Int_t nbadscr, const Int_t* badscr);
+    Bool_t ParseBadScR(const Char_t* str, TCBadScRElement**& badscr_data, Int_t& ndata);
+    TString FormatBadScR(TCBadScRElement** badscr_data, Int_t ndata);
+    Bool_t MigrateBadScR();
+    Bool_t TouchRun(Int_t run);
+    Bool_t CreateChangeIndex(const Char_t* table);
+
+    Int_t* GetRunList(Int_t first_run, Int_t last_run, Int_t* outNruns = 0);
+    TCContainer* OpenContainer(const Char_t* filename, TFile*& outFile);
+    void ExportStream(TCContainer* file, TCMySQLManager* db,
+                      Int_t first_run, Int_t last_run, TList* calibrations,
+                      const Char_t* location, Int_t* outNRunsDump, Int_t* outNCalibDump,
+                      Int_t* outNRunsWrite, Int_t* outNCalibWrite);
+    void ImportStream(TCContainer* container, Bool_t runs, Bool_t calibrations,
+                      const Char_t* newCalibName = 0, Int_t* outNRuns = 0, Int_t* outNCalib = 0);
+    Bool_t DeleteReplicaRows(TCMySQLManager* target, const Char_t* table, const Char_t* since);
+    Long64_t ReplicateTable(TCMySQLManager* target, const Char_t* table, Bool_t incremental);
+    Bool_t Replicate(TCMySQLManager* target, Bool_t incremental);
 
     TCMySQLManager();
+    TCMySQLManager(TSQLServer* db, ServerType_t type);
 
 public:
     virtual ~TCMySQLManager();
@@ -90,6 +113,7 @@ public:
     TCCalibData* GetCalibData(const Char_t* data) const;
 
     void CreateMainTable();
+    Bool_t CreateBadScRTable();
     Bool_t CreateDataTable(const Char_t* data, Int_t nElem);
 
     TList* GetAllCalibrations(const Char_t* data = "Data.Tagger.T0");
@@ -105,6 +129,11 @@ public:
     void GetChangeTimeOfSet(const Char_t* data, const Char_t* calibration,
                             Int_t set, Char_t* outTime);
     Int_t* GetRunsOfCalibration(const Char_t* calibration, Int_t* outNruns = 0);
+
+    TString GetLastChange();
+    Bool_t HasChanged(const Char_t* since);
+    Int_t* GetChangedRuns(const Char_t* since, Int_t* outNruns = 0);
+    TList* GetChangedSets(const Char_t* since, const Char_t* calibration = 0);
     Int_t* GetRunsOfSet(const Char_t* data, const Char_t* calibration,
                         Int_t set, Int_t* outNruns);
     Int_t GetSetForRun(const Char_t* data, const Char_t* calibration, Int_t run);
@@ -113,6 +142,8 @@ public:
                           Double_t* par, Int_t length);
     Bool_t ReadParametersRun(const Char_t* data, const Char_t* calibration, Int_t run,
                              Double_t* par, Int_t length);
+    Int_t ReadSets(const Char_t* data, const Char_t* calibration,
+                   Int_t*& outFirst, Int_t*& outLast, Double_t*& outPar, Int_t length);
     Bool_t WriteParameters(const Char_t* data, const Char_t* calibration, Int_t set,
                            Double_t* par, Int_t length);
 
@@ -128,6 +159,11 @@ public:
 
     Bool_t ChangeRunBadScR(Int_t run, Int_t nbadscr, const Int_t* badscr, const Char_t* data);
     Bool_t GetRunBadScR(Int_t run, Int_t& nbadscr, Int_t*& badscr, const Char_t* data = 0);
+    Bool_t GetRunsBadScR(Int_t first_run, Int_t last_run, const Char_t* data,
+                         TCBadScRElement**& badscr_data, Int_t& nrun);
+    Bool_t ReadRunsBadScR(Int_t nrun, const Int_t* runs, const Char_t* data,
+                          Int_t* outNScR, TCBadScRElement** outBadScR);
+    Bool_t WriteRunsBadScR(Int_t nrun, TCBadScRElement** badscr, const Char_t* data);
 
     Bool_t ChangeCalibrationRunRange(const Char_t* calibration, const UInt_t firstRun,
                                      const UInt_t lastRun);
@@ -154,7 +190,7 @@ public:
                     Int_t first_run, Int_t last_run);
 
     Bool_t InitDatabase(Bool_t interact = kTRUE);
-    Bool_t UpgradeDatabase(Int_t version);
+    Bool_t UpgradeDatabase(Int_t version, Bool_t interact = kTRUE);
     Bool_t AddNewDataTable(const Char_t* data);
 
     TCContainer* LoadContainer(const Char_t* filename);
@@ -172,8 +208,10 @@ public:
     void Export(const Char_t* filename, Int_t first_run, Int_t last_run,
                 const Char_t* calibration);
     void Import(const Char_t* filename, Bool_t runs, Bool_t calibrations,
-                const Char_t* newCalibName = 0);
-    Bool_t ExportDatabase(const Char_t* filename);
+                const Char_t* newCalibName = 0, Bool_t interact = kTRUE);
+    Bool_t ExportDatabase(const Char_t* filename, Bool_t incremental = kFALSE);
+    Bool_t ReplicateDatabase(const Char_t* url, const Char_t* user = "", const Char_t* pass = "",
+                             Bool_t incremental = kFALSE);
 
     static TCMySQLManager* GetManager();
 
@@ -0,0 +1,105 @@
+/*************************************************************************
+ * Author: Dominik Werthmueller
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TCQueryLog                                                           //
+//                                                                      //
+// Record the SQL statements sent to the database and aggregate them    //
+// into per-pattern latency statistics.                                 //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+
+#ifndef TCQUERYLOG_H
+#define TCQUERYLOG_H
+
+#include "TNamed.h"
+#include "TString.h"
+
+class THashList;
+class TMutex;
+
+class TCQueryPattern : public TNamed
+{
+
+public:
+    enum {
+        kNBins = 24,            // number of latency bins (powers of 2 in microseconds)
+        kNCaller = 8            // maximum number of distinct calling sites
+    };
+
+private:
+    Long64_t fCalls;                    // number of calls
+    Long64_t fTime;                     // total latency [ns]
+    Long64_t fTimeMax;                  // maximum latency [ns]
+    Long64_t fRows;                     // number of returned rows (if known)
+    Long64_t fHist[kNBins];             // latency histogram
+    Int_t fNCaller;                     // number of calling sites
+    void* fCallerAddr[kNCaller];        //! return addresses of the calling sites
+    Long64_t fCallerCalls[kNCaller];    // number of calls per calling site
+    Long64_t fCallerOther;              // calls from further calling sites
+
+public:
+    TCQueryPattern() : TNamed(), fCalls(0), fTime(0), fTimeMax(0), fRows(0),
+                       fNCaller(0), fCallerOther(0)
+    {
+        for (Int_t i = 0; i < kNBins; i++) fHist[i] = 0;
+        for (Int_t i = 0; i < kNCaller; i++) { fCallerAddr[i] = 0; fCallerCalls[i] = 0; }
+    }
+    TCQueryPattern(const Char_t* pattern);
+    virtual ~TCQueryPattern() { }
+
+    void Add(Long64_t nsec, Long64_t rows, void* caller);
+
+    Long64_t GetCalls() const { return fCalls; }
+    Long64_t GetTime() const { return fTime; }
+    Long64_t GetTimeMax() const { return fTimeMax; }
+    Long64_t GetRows() const { return fRows; }
+    const Long64_t* GetHistogram() const { return fHist; }
+    Double_t GetQuantile(Double_t q) const;
+    TString GetCallers() const;
+
+    ClassDef(TCQueryPattern, 0) // SQL statement pattern statistics
+};
+
+class TCQueryLog
+{
+
+private:
+    THashList* fPatterns;               // statement patterns
+    TMutex* fMutex;                     // pattern list mutex
+    Int_t fNPrint;                      // number of patterns printed at exit
+    static Bool_t fgEnabled;            // recording toggle
+    static TCQueryLog* fgQueryLog;      // pointer to static instance of this class
+
+    TCQueryLog();
+
+public:
+    virtual ~TCQueryLog();
+
+    static Bool_t IsEnabled() { return fgEnabled; }
+    static void Enable(Int_t nPrint = 0);
+    static void Disable() { fgEnabled = kFALSE; }
+    static TString Normalise(const Char_t* sql);
+
+    void Record(const Char_t* sql, Long64_t nsec, Long64_t rows, void* caller);
+    void Reset();
+    Int_t GetNPatterns() const;
+    Int_t GetNPrint() const { return fNPrint; }
+    TString GetReport(Int_t n = 20, Bool_t verbose = kTRUE);
+    void Print(Int_t n = 20);
+
+    static TCQueryLog* GetLog()
+    {
+        // return a pointer to the static instance of this class
+        if (!fgQueryLog) fgQueryLog = new TCQueryLog();
+        return fgQueryLog;
+    }
+
+    ClassDef(TCQueryLog, 0) // SQL statement log
+};
+
+#endif
+
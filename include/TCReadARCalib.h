@@ -16,6 +16,43 @@
 
 #include "TObject.h"
 
+class TList;
+
+// fields of the element statements of AcquRoot calibration files
+enum EARElementField
+{
+    kARELEM_ADC = 0,
+    kARELEM_ELOW,
+    kARELEM_EHIGH,
+    kARELEM_PED,
+    kARELEM_ADCGAIN,
+    kARELEM_TDC,
+    kARELEM_TLOW,
+    kARELEM_THIGH,
+    kARELEM_OFFSET,
+    kARELEM_TDCGAIN,
+    kARELEM_X,
+    kARELEM_Y,
+    kARELEM_Z,
+    kARELEM_TAGGCALIB,
+    kARELEM_TAGGOVERLAP,
+    kARELEM_TAGGSCALER,
+    kARELEM_NFIELD
+};
+typedef EARElementField ARElementField_t;
+
+// fields of the time walk statements of AcquRoot calibration files
+enum EARTimeWalkField
+{
+    kARTW_INDEX = 0,
+    kARTW_PAR0,
+    kARTW_PAR1,
+    kARTW_PAR2,
+    kARTW_PAR3,
+    kARTW_NFIELD
+};
+typedef EARTimeWalkField ARTimeWalkField_t;
+
 class TCARElement : public TObject
 {
 
@@ -67,8 +104,8 @@ public:
     void SetPedestal(Double_t ped) { fPed = ped; }
     void SetADCGain(Double_t gain) { fADCGain = gain; }
     void SetTDC(const Char_t* tdc) { strcpy(fTDC, tdc); }
-    void SetTimeLow(Double_t low) { fEnergyLow = low; }
-    void SetTimeHigh(Double_t high) { fEnergyHigh = high; }
+    void SetTimeLow(Double_t low) { fTimeLow = low; }
+    void SetTimeHigh(Double_t high) { fTimeHigh = high; }
     void SetOffset(Double_t off) { fOffset = off; }
     void SetTDCGain(Double_t gain) { fTDCGain = gain; }
     void SetX(Double_t x) { fX = x; }
@@ -144,24 +181,64 @@ class TCReadARCalib
 {
 
 private:
-    TList* fElements;               // list of detector elements
-    TList* fTimeWalks;              // list of time walk elements
-    TList* fNeighbours;             // list of neighbour statements
-
+    Char_t* fBuffer;                            //! file content (memory-mapped or read)
+    Long64_t fBufferSize;                       //! size of the file content
+    Long64_t fFileSize;                         //! size of the file
+    Bool_t fMapped;                             //! memory mapping flag
+    Bool_t fIsTagger;                           // tagger toggle
+    Int_t fNElem;                               // number of detector elements
+    Double_t* fElemValue[kARELEM_NFIELD];       //! values of the element fields
+    Int_t* fElemLine;                           //! start and length of the element lines
+    Int_t* fElemSpan;                           //! start and length of the element fields
+    Int_t fNTW;                                 // number of time walk elements
+    Double_t* fTWValue[kARTW_NFIELD];           //! values of the time walk fields
+    Int_t* fTWLine;                             //! start and length of the time walk lines
+    Int_t* fTWSpan;                             //! start and length of the time walk fields
+    mutable TList* fElements;                   // list of detector elements (created on demand)
+    mutable TList* fTimeWalks;                  // list of time walk elements (created on demand)
+    TList* fNeighbours;                         // list of neighbour statements
+
+    void Init();
+    Bool_t MapFile(const Char_t* filename);
     void ReadCalibFile(const Char_t* filename, Bool_t isTagger,
                        const Char_t* elemIdent, const Char_t* nebrIdent);
+    void MakeElements() const;
+    void MakeTimeWalks() const;
 
 public:
-    TCReadARCalib() : fElements(0), fTimeWalks(0), fNeighbours(0) { }
+    TCReadARCalib() { Init(); }
     TCReadARCalib(const Char_t* calibFile, Bool_t isTagger,
                   const Char_t* elemIdent = "Element:", const Char_t* nebrIdent = "Next-Neighbour:");
     virtual ~TCReadARCalib();
 
-    TList* GetElements() const { return fElements; }
-    Int_t GetNelements() const;
+    Bool_t IsTagger() const { return fIsTagger; }
+    const Char_t* GetBuffer() const { return fBuffer; }
+    Long64_t GetBufferSize() const { return fBufferSize; }
+    Long64_t GetFileSize() const { return fFileSize; }
+
+    Double_t GetElementValue(Int_t n, ARElementField_t f) const { return fElemValue[f][n]; }
+    const Double_t* GetElementValues(ARElementField_t f) const { return fElemValue[f]; }
+    Int_t GetElementLineStart(Int_t n) const { return fElemLine[2*n]; }
+    Int_t GetElementLineLength(Int_t n) const { return fElemLine[2*n+1]; }
+    Int_t GetElementFieldStart(Int_t n, ARElementField_t f) const
+    { return fElemSpan[2*(n*kARELEM_NFIELD+f)]; }
+    Int_t GetElementFieldLength(Int_t n, ARElementField_t f) const
+    { return fElemSpan[2*(n*kARELEM_NFIELD+f)+1]; }
+
+    Double_t GetTimeWalkValue(Int_t n, ARTimeWalkField_t f) const { return fTWValue[f][n]; }
+    const Double_t* GetTimeWalkValues(ARTimeWalkField_t f) const { return fTWValue[f]; }
+    Int_t GetTimeWalkLineStart(Int_t n) const { return fTWLine[2*n]; }
+    Int_t GetTimeWalkLineLength(Int_t n) const { return fTWLine[2*n+1]; }
+    Int_t GetTimeWalkFieldStart(Int_t n, ARTimeWalkField_t f) const
+    { return fTWSpan[2*(n*kARTW_NFIELD+f)]; }
+    Int_t GetTimeWalkFieldLength(Int_t n, ARTimeWalkField_t f) const
+    { return fTWSpan[2*(n*kARTW_NFIELD+f)+1]; }
+
+    TList* GetElements() const;
+    Int_t GetNelements() const { return fNElem; }
     TCARElement* GetElement(Int_t n) const;
-    TList* GetTimeWalks() const { return fTimeWalks; }
-    Int_t GetNtimeWalks() const;
+    TList* GetTimeWalks() const;
+    Int_t GetNtimeWalks() const { return fNTW; }
     TCARTimeWalk* GetTimeWalk(Int_t n) const;
     TList* GetNeighbours() const { return fNeighbours; }
     Int_t GetNneighbours() const;
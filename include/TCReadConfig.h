@@ -18,6 +18,30 @@
 #include "TString.h"
 
 class THashTable;
+class TMutex;
+
+// types of the typed configuration handles
+enum EConfigType
+{
+    kConfigString = 0,
+    kConfigInt,
+    kConfigDouble,
+    kConfigPair,
+    kConfigList,
+    kConfigNType
+};
+typedef EConfigType ConfigType_t;
+
+// parsed value of a typed configuration handle
+struct TCConfigValue
+{
+    Bool_t set;                 // flag for existing and valid configuration value
+    Int_t i;                    // integer value
+    Double_t d[2];              // floating point value(s)
+    Int_t n;                    // number of list entries
+    Int_t* list;                // list entries
+    const TString* s;           // string value
+};
 
 class TCConfigElement : public TObject
 {
@@ -25,14 +49,20 @@ class TCConfigElement : public TObject
 private:
     TString key;                // config key
     TString value;              // config value
+    Int_t handle[kConfigNType]; // typed handles of the value
 
 public:
-    TCConfigElement(const Char_t* k, const Char_t* v) : key(k), value(v) {  }
+    TCConfigElement(const Char_t* k, const Char_t* v) : key(k), value(v)
+    {
+        for (Int_t i = 0; i < kConfigNType; i++) handle[i] = -1;
+    }
     virtual ~TCConfigElement() { }
     TString* GetKey() { return &key; }
     TString* GetValue() { return &value; }
     virtual const Char_t* GetName() const { return key.Data(); }
     virtual ULong_t Hash() const { return key.Hash(); }
+    Int_t GetHandle(ConfigType_t type) const { return handle[type]; }
+    void SetHandle(ConfigType_t type, Int_t h) { handle[type] = h; }
 
     ClassDef(TCConfigElement, 0) // Key-value based configuration element
 };
@@ -43,19 +73,34 @@ class TCReadConfig
 private:
     THashTable* fConfigTable;           // hash table containing config elements
     TString fCaLibPath;                 // path of the calib source
+    Int_t fNValues;                     // number of typed configuration values
+    TCConfigValue* fValues[256];        //! blocks of 256 typed configuration values (index = handle)
+    TMutex* fMutex;                     //! mutex for the creation of handles
     static TCReadConfig* fgReadConfig;  // pointer to the static instance of this class
 
     void ReadConfigFile(const Char_t* cfgFile);
     TCConfigElement* CreateConfigElement(TString line);
+    Bool_t ParseValue(const TString* v, ConfigType_t type, TCConfigValue* out);
+    TCConfigValue& Value(Int_t h) const { return fValues[h >> 8][h & 255]; }
 
 public:
     TCReadConfig();
     virtual ~TCReadConfig();
 
-    TString* GetConfig(TString configKey);
-    Int_t GetConfigInt(TString configKey);
-    Double_t GetConfigDouble(TString configKey);
-    Bool_t GetConfigDoubleDouble(TString configKey, Double_t* out1, Double_t* out2);
+    TString* GetConfig(const Char_t* configKey);
+    Int_t GetConfigInt(const Char_t* configKey);
+    Double_t GetConfigDouble(const Char_t* configKey);
+    Bool_t GetConfigDoubleDouble(const Char_t* configKey, Double_t* out1, Double_t* out2);
+
+    Int_t GetHandle(const Char_t* configKey, ConfigType_t type);
+    Bool_t IsSet(Int_t h) const { return Value(h).set; }
+    const Char_t* GetString(Int_t h) const { return Value(h).s ? Value(h).s->Data() : 0; }
+    Int_t GetInt(Int_t h) const { return Value(h).i; }
+    Double_t GetDouble(Int_t h) const { return Value(h).d[0]; }
+    Double_t GetFirst(Int_t h) const { return Value(h).d[0]; }
+    Double_t GetSecond(Int_t h) const { return Value(h).d[1]; }
+    Int_t GetListSize(Int_t h) const { return Value(h).n; }
+    const Int_t* GetList(Int_t h) const { return Value(h).list; }
 
     static TCReadConfig* GetReader()
     {
@@ -22,11 +22,17 @@ namespace TCUtils
 {
     void FindBackground(TH1* h, Double_t peak, Double_t low, Double_t high,
                         Double_t* outPar0, Double_t* outPar1);
+    Double_t GetBinIntegral3(TH1* h, Int_t bin);
     TH1* DeriveHistogram(TH1* inH);
     void ZeroBins(TH1* inH, Double_t th = 0);
     Double_t Pi0Func(Double_t* x, Double_t* par);
     Double_t GetHistogramMinimum(TH1* h);
     Double_t GetHistogramMinimumPosition(TH1* h);
+    Int_t GetCellContents(TH1* h, Double_t* out);
+    void GetBinContents(TH1* h, Int_t n, Double_t* out);
+    void SetBinContents(TH1* h, Int_t n, const Double_t* in);
+    void GetHistogramFormat(const Char_t* ident, Int_t* outHandles);
+    void FormatHistogram(TH1* h, const Int_t* handles);
     void FormatHistogram(TH1* h, const Char_t* ident);
     Bool_t IsCBHole(Int_t elem);
     Int_t GetVetoInFrontOfElement(Int_t id, Int_t maxTAPS);
@@ -34,6 +40,8 @@ namespace TCUtils
     Bool_t IsTAPSPWO(Int_t id, Int_t maxTAPS);
     Double_t GetDiffPercent(Double_t oldValue, Double_t newValue);
     Int_t ReadCommaSepList(const TString* s, Int_t* outList);
+    Int_t GetNumberOfThreads();
+    void ParallelFor(Int_t n, void (*func)(Int_t, void*), void* arg, Int_t nThreads = 0);
 }
 
 #endif
@@ -14,7 +14,10 @@
 #ifndef TCWRITEARCALIB_H
 #define TCWRITEARCALIB_H
 
+#include "TString.h"
+
 #include "TCConfig.h"
+#include "TCReadARCalib.h"
 
 class TCWriteARCalib
 {
@@ -22,18 +25,32 @@ class TCWriteARCalib
 private:
     CalibDetector_t fDetector;              // detector type
     Char_t fTemplate[256];                  // template calibration file
+    TCReadARCalib* fReader;                 //! elements and time walks of the template file
+    TCReadARCalib* fReaderSG;               //! TAPS SG elements of the template file
+    Double_t* fElem[kARELEM_NFIELD];        //! current values of the element fields
+    Double_t* fTW[kARTW_NFIELD];            //! current values of the time walk fields
+    Double_t* fSG[kARELEM_NFIELD];          //! current values of the TAPS SG element fields
+
+    Bool_t ReadTemplate();
+    void ResetParameters();
+    Int_t GetNParameters(Int_t type) const;
+    void SetParameters(Int_t type, const Double_t* par);
+    void Format(TString& out);
 
 public:
-    TCWriteARCalib()
+    TCWriteARCalib() : fDetector(kDETECTOR_NODET), fReader(0), fReaderSG(0)
     {
-        fDetector = kDETECTOR_NODET;
         fTemplate[0] = '\0';
+        for (Int_t i = 0; i < kARELEM_NFIELD; i++) fElem[i] = fSG[i] = 0;
+        for (Int_t i = 0; i < kARTW_NFIELD; i++) fTW[i] = 0;
     }
     TCWriteARCalib(CalibDetector_t det, const Char_t* templateFile);
-    virtual ~TCWriteARCalib() { }
+    virtual ~TCWriteARCalib();
 
     void Write(const Char_t* calibFile,
                const Char_t* calibration, Int_t run);
+    Int_t WriteRuns(const Char_t* calibFiles, const Char_t* calibration,
+                    Int_t first_run, Int_t last_run, Bool_t perRun = kFALSE);
 
     ClassDef(TCWriteARCalib, 0) // AcquRoot calibration file writer
 };
@@ -0,0 +1,369 @@
+/*************************************************************************
+ * Author: Dominik Werthmueller
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// CaLibBenchmark                                                       //
+//                                                                      //
+// Benchmark the database, file loading and fitting hot paths of CaLib  //
+// on a synthetic SQLite database and synthetic AcquRoot files.         //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "TROOT.h"
+#include "TSystem.h"
+#include "TH1.h"
+#include "TMath.h"
+#include "TDatime.h"
+#include "THashList.h"
+
+#include "TCMySQLManager.h"
+#include "TCCalibType.h"
+#include "TCContainer.h"
+#include "TCFileManager.h"
+#include "TCARHistoLoader.h"
+#include "TCCalibTime.h"
+#include "TCInstrument.h"
+#include "TCDataGenerator.h"
+
+// benchmark configuration
+Int_t gNRuns = 200;                     // number of runs
+Int_t gRunsPerSet = 20;                 // number of runs per set
+Int_t gNRep = 5;                        // number of repetitions of fast benchmarks
+Int_t gFirstRun = 10000;                // first run number
+Bool_t gFastFit = kFALSE;               // use the fast peak fitter
+TString gWorkDir = "calib_benchmark";   // working directory
+TString gOutput;                        // output file (stdout if empty)
+
+// benchmark constants
+const Char_t* gCalibration = "Benchmark";
+const Char_t* gTimeHisto = "CaLib_CB_Time";
+const Int_t gNElemCB = 720;
+
+// benchmark results
+const Int_t gMaxResult = 64;
+Int_t gNResult = 0;
+TString gResultName[gMaxResult];
+Long64_t gResultCalls[gMaxResult];
+Long64_t gResultTime[gMaxResult];
+Long64_t gResultCounter[gMaxResult][kINSTR_NCOUNTER];
+Long64_t gStart;
+
+//______________________________________________________________________________
+void StartBenchmark()
+{
+    // Start the timing of a benchmark.
+
+    TCInstrument::Reset();
+    gStart = TCInstrument::GetTime();
+}
+
+//______________________________________________________________________________
+void StopBenchmark(const Char_t* name, Long64_t calls)
+{
+    // Stop the timing of the benchmark 'name' consisting of 'calls' calls and
+    // save the result.
+
+    Long64_t t = TCInstrument::GetTime() - gStart;
+    if (gNResult == gMaxResult) return;
+
+    gResultName[gNResult] = name;
+    gResultCalls[gNResult] = calls;
+    gResultTime[gNResult] = t;
+    for (Int_t i = 0; i < kINSTR_NCOUNTER; i++)
+        gResultCounter[gNResult][i] = TCInstrument::GetCounter((InstrCounter_t)i);
+    gNResult++;
+
+    fprintf(stderr, "%-28s %8lld calls %12.3f ms %10.3f ms/call\n",
+            name, calls, t / 1e6, calls ? t / 1e6 / calls : 0.);
+}
+
+//______________________________________________________________________________
+Bool_t WriteResults()
+{
+    // Write the results to the output file or to stdout. The CSV format is
+    // used if the output file ends with '.csv', otherwise the JSON format.
+    // Return kFALSE if an error occurred, otherwise kTRUE.
+
+    // open the output
+    FILE* fout = stdout;
+    if (gOutput.Length() && !(fout = fopen(gOutput.Data(), "w")))
+    {
+        fprintf(stderr, "Could not open the output file '%s'!\n", gOutput.Data());
+        return kFALSE;
+    }
+
+    // write CSV
+    if (gOutput.EndsWith(".csv"))
+    {
+        fprintf(fout, "name,calls,total_ms,ms_per_call");
+        for (Int_t j = 0; j < kINSTR_NCOUNTER; j++)
+            fprintf(fout, ",%s", TCInstrument::GetCounterName((InstrCounter_t)j));
+        fprintf(fout, "\n");
+        for (Int_t i = 0; i < gNResult; i++)
+        {
+            fprintf(fout, "%s,%lld,%.3f,%.6f", gResultName[i].Data(), gResultCalls[i],
+                    gResultTime[i] / 1e6, gResultCalls[i] ? gResultTime[i] / 1e6 / gResultCalls[i] : 0.);
+            for (Int_t j = 0; j < kINSTR_NCOUNTER; j++)
+                fprintf(fout, ",%lld", gResultCounter[i][j]);
+            fprintf(fout, "\n");
+        }
+    }
+    // write JSON
+    else
+    {
+        TDatime now;
+        fprintf(fout, "{\n");
+        fprintf(fout, "  \"version\": \"%s\",\n", TCConfig::kCaLibVersion);
+        fprintf(fout, "  \"date\": \"%s\",\n", now.AsSQLString());
+        fprintf(fout, "  \"config\": { \"runs\": %d, \"runs_per_set\": %d, \"repetitions\": %d, "
+                      "\"fast_fit\": %s },\n",
+                gNRuns, gRunsPerSet, gNRep, gFastFit ? "true" : "false");
+        fprintf(fout, "  \"results\": [\n");
+        for (Int_t i = 0; i < gNResult; i++)
+        {
+            fprintf(fout, "    { \"name\": \"%s\", \"calls\": %lld, \"total_ms\": %.3f, \"ms_per_call\": %.6f",
+                    gResultName[i].Data(), gResultCalls[i], gResultTime[i] / 1e6,
+                    gResultCalls[i] ? gResultTime[i] / 1e6 / gResultCalls[i] : 0.);
+            for (Int_t j = 0; j < kINSTR_NCOUNTER; j++)
+                fprintf(fout, ", \"%s\": %lld", TCInstrument::GetCounterName((InstrCounter_t)j),
+                        gResultCounter[i][j]);
+            fprintf(fout, " }%s\n", i < gNResult-1 ? "," : "");
+        }
+        fprintf(fout, "  ]\n");
+        fprintf(fout, "}\n");
+    }
+
+    if (fout != stdout) fclose(fout);
+
+    return kTRUE;
+}
+
+//______________________________________________________________________________
+Bool_t SetupWorkDir()
+{
+    // Create the working directory containing the configuration of the
+    // synthetic database and the synthetic AcquRoot files. The CaLib data and
+    // type definitions are linked from the CaLib source directory.
+    // Return kFALSE if an error occurred, otherwise kTRUE.
+
+    // get the CaLib source directory
+    TString calib = gSystem->Getenv("CALIB") ? gSystem->Getenv("CALIB") : gSystem->pwd();
+    if (gSystem->AccessPathName(TString::Format("%s/data/data.def", calib.Data())))
+    {
+        fprintf(stderr, "Cannot find the CaLib data definitions in '%s/data'!\n", calib.Data());
+        return kFALSE;
+    }
+
+    // create the directories
+    gSystem->mkdir(gWorkDir.Data(), kTRUE);
+    gSystem->mkdir(TString::Format("%s/config", gWorkDir.Data()), kTRUE);
+    gSystem->mkdir(TString::Format("%s/files", gWorkDir.Data()), kTRUE);
+    if (!gSystem->IsAbsoluteFileName(gWorkDir.Data()))
+        gWorkDir = TString::Format("%s/%s", gSystem->pwd(), gWorkDir.Data());
+
+    // link the data definitions
+    TString data = TString::Format("%s/data", gWorkDir.Data());
+    gSystem->Unlink(data.Data());
+    if (gSystem->Symlink(TString::Format("%s/data", calib.Data()), data.Data()))
+    {
+        fprintf(stderr, "Could not link the CaLib data definitions!\n");
+        return kFALSE;
+    }
+
+    // remove an old database
+    gSystem->Unlink(TString::Format("%s/benchmark.db", gWorkDir.Data()));
+
+    // write the configuration
+    FILE* fout = fopen(TString::Format("%s/config/config.cfg", gWorkDir.Data()), "w");
+    if (!fout)
+    {
+        fprintf(stderr, "Could not write the benchmark configuration!\n");
+        return kFALSE;
+    }
+    fprintf(fout, "# CaLib benchmark configuration (generated)\n");
+    fprintf(fout, "File.Input.Rootfiles: %s/files/ARHistograms_CBTaggTAPS_RUN.root\n", gWorkDir.Data());
+    fprintf(fout, "DB.File: %s/benchmark.db\n", gWorkDir.Data());
+    fprintf(fout, "CB.Time.Histo.Fit.Name: %s\n", gTimeHisto);
+    fprintf(fout, "CB.Time.Histo.Fit.Xaxis.Range: -50 50\n");
+    fprintf(fout, "CB.Time.TDCGain: 0.11771\n");
+    if (gFastFit) fprintf(fout, "CB.Time.Fit.Method: Fast\n");
+    fclose(fout);
+
+    // use the working directory as CaLib directory
+    gSystem->Setenv("CALIB", gWorkDir.Data());
+
+    return kTRUE;
+}
+
+//______________________________________________________________________________
+Int_t Usage()
+{
+    // Print the usage.
+
+    printf("Usage: calib_benchmark [-n runs] [-s runs per set] [-r repetitions]\n"
+           "                       [-w working directory] [-o output.json|output.csv] [-f]\n"
+           "  -n  number of synthetic runs (default: %d)\n"
+           "  -s  number of runs per set (default: %d)\n"
+           "  -r  number of repetitions of the fast benchmarks (default: %d)\n"
+           "  -w  working directory (default: %s)\n"
+           "  -o  output file (default: JSON to stdout)\n"
+           "  -f  use the fast peak fitter\n",
+           gNRuns, gRunsPerSet, gNRep, gWorkDir.Data());
+
+    return 1;
+}
+
+//______________________________________________________________________________
+Int_t main(Int_t argc, Char_t* argv[])
+{
+    // Main method.
+
+    // parse the arguments
+    for (Int_t i = 1; i < argc; i++)
+    {
+        TString a(argv[i]);
+        if (a == "-f") gFastFit = kTRUE;
+        else if (i+1 < argc && a == "-n") gNRuns = atoi(argv[++i]);
+        else if (i+1 < argc && a == "-s") gRunsPerSet = atoi(argv[++i]);
+        else if (i+1 < argc && a == "-r") gNRep = atoi(argv[++i]);
+        else if (i+1 < argc && a == "-w") gWorkDir = argv[++i];
+        else if (i+1 < argc && a == "-o") gOutput = argv[++i];
+        else return Usage();
+    }
+    if (gNRuns < 1 || gRunsPerSet < 1 || gNRep < 1) return Usage();
+    Int_t nSet = (gNRuns + gRunsPerSet - 1) / gRunsPerSet;
+
+    // no graphics
+    gROOT->SetBatch(kTRUE);
+
+    // create the working directory and the configuration
+    if (!SetupWorkDir()) return 1;
+
+    // enable the counters
+    TCInstrument::Enable();
+
+    // create the synthetic files
+    StartBenchmark();
+    TCDataGenerator gen(TString::Format("%s/files/ARHistograms_CBTaggTAPS_RUN.root", gWorkDir.Data()));
+    gen.WriteRuns(gFirstRun, gFirstRun+gNRuns-1);
+    StopBenchmark("setup.create_files", gNRuns);
+
+    // create the database
+    TCMySQLManager* db = TCMySQLManager::GetManager();
+    if (!db || !db->IsConnected())
+    {
+        fprintf(stderr, "Could not create the benchmark database!\n");
+        return 1;
+    }
+    db->SetSilenceMode(kTRUE);
+    StartBenchmark();
+    db->InitDatabase(kFALSE);
+    StopBenchmark("setup.init_database", 1);
+
+    // add the runs
+    StartBenchmark();
+    for (Int_t i = 0; i < gNRuns; i++) db->AddRun(gFirstRun+i, "LH2", "benchmark run");
+    StopBenchmark("db.add_run", gNRuns);
+
+    // add the sets of all calibration types
+    StartBenchmark();
+    Long64_t nAdd = 0;
+    TIter next(db->GetTypeTable());
+    TCCalibType* t;
+    while ((t = (TCCalibType*)next()))
+    {
+        for (Int_t i = 0; i < nSet; i++)
+        {
+            Int_t first = gFirstRun + i*gRunsPerSet;
+            Int_t last = TMath::Min(first + gRunsPerSet, gFirstRun + gNRuns) - 1;
+            db->AddSet(t->GetName(), gCalibration, "benchmark set", first, last, 0);
+            nAdd++;
+        }
+    }
+    StopBenchmark("db.add_set", nAdd);
+
+    // run look-up
+    StartBenchmark();
+    for (Int_t r = 0; r < gNRep; r++)
+    {
+        for (Int_t i = 0; i < nSet; i++)
+        {
+            Int_t n;
+            Int_t* runs = db->GetRunsOfSet("Data.CB.T0", gCalibration, i, &n);
+            if (runs) delete [] runs;
+        }
+    }
+    StopBenchmark("db.get_runs_of_set", gNRep*nSet);
+
+    // dump the runs
+    StartBenchmark();
+    for (Int_t r = 0; r < gNRep; r++)
+    {
+        TCContainer c("benchmark");
+        db->DumpRuns(&c);
+    }
+    StopBenchmark("db.dump_runs", gNRep);
+
+    // export and import
+    TString dump = TString::Format("%s/benchmark_dump.root", gWorkDir.Data());
+    gSystem->Unlink(dump.Data());
+    StartBenchmark();
+    db->Export(dump.Data(), 0, 0, gCalibration);
+    StopBenchmark("db.export", 1);
+    StartBenchmark();
+    db->Import(dump.Data(), kFALSE, kTRUE, "Benchmark_Import", kFALSE);
+    StopBenchmark("db.import", 1);
+
+    // open the files of the first set
+    Int_t set = 0;
+    StartBenchmark();
+    TCFileManager* fm = new TCFileManager("Data.CB.T0", gCalibration, 1, &set);
+    StopBenchmark("file.open_set", 1);
+
+    // sum up the histograms of the first set
+    StartBenchmark();
+    for (Int_t r = 0; r < gNRep; r++)
+    {
+        TH1* h = fm->GetHistogram(gTimeHisto);
+        if (h) delete h;
+    }
+    StopBenchmark("file.get_histogram", gNRep);
+    delete fm;
+
+    // projections of all runs
+    Int_t nRuns;
+    Int_t* runs = db->GetRunsOfCalibration(gCalibration, &nRuns);
+    StartBenchmark();
+    {
+        TCARHistoLoader hl(nRuns, runs, TString::Format("%s/files/ARHistograms_CBTaggTAPS_RUN.root",
+                                                        gWorkDir.Data()));
+        TH1** proj = hl.CreateHistoArrayOfProj(gTimeHisto, 'X');
+        if (proj)
+        {
+            for (Int_t i = 0; i < nRuns; i++)
+                if (proj[i]) delete proj[i];
+            delete [] proj;
+        }
+    }
+    StopBenchmark("loader.projections", nRuns);
+    if (runs) delete [] runs;
+
+    // headless time calibration of the first set
+    StartBenchmark();
+    {
+        TCCalibCBTime c;
+        c.Start(gCalibration, 1, &set);
+        c.ProcessAll();
+    }
+    StopBenchmark("calib.cb_time", gNElemCB);
+
+    // write the results
+    return WriteResults() ? 0 : 1;
+}
+
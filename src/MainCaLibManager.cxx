@@ -15,6 +15,7 @@
 #include <signal.h>
 
 #include "TList.h"
+#include "TObjArray.h"
 #include "TObjString.h"
 #include "THashList.h"
 
@@ -22,6 +23,7 @@
 #include "TCCalibType.h"
 #include "TCContainer.h"
 #include "TCCalibData.h"
+#include "TCQueryLog.h"
 
 #define KEY_ENTER_MINE 13
 #define KEY_ESC 27
@@ -2185,6 +2187,68 @@ void CalibEditor()
     }
 }
 
+//______________________________________________________________________________
+void ShowQueryLog()
+{
+    // Show the statistics of the recorded SQL statements.
+
+    // loop until exit
+    for (;;)
+    {
+        // clear the screen
+        clear();
+
+        // draw header
+        DrawHeader();
+
+        // draw title
+        attron(A_UNDERLINE);
+        mvprintw(4, 2, "SQL STATEMENT STATISTICS");
+        attroff(A_UNDERLINE);
+
+        // check if recording is enabled
+        if (!TCQueryLog::IsEnabled())
+        {
+            mvprintw(6, 2, "The recording of the SQL statements is disabled.");
+            mvprintw(7, 2, "Hit 'e' to enable it or set 'DB.QueryLog' in the configuration file.");
+        }
+        else
+        {
+            // get the report for the available rows
+            TString report = TCQueryLog::GetLog()->GetReport(gNrow-11, kFALSE);
+            TObjArray* lines = report.Tokenize("\n");
+
+            // print the lines
+            for (Int_t i = 0; i < lines->GetEntriesFast() && 6+i < gNrow-3; i++)
+            {
+                TString line = ((TObjString*)lines->At(i))->GetString();
+                if (line.Length() > gNcol-4) line.Remove(gNcol-4);
+                if (i < 2) attron(A_BOLD);
+                mvprintw(6+i, 2, "%s", line.Data());
+                if (i < 2) attroff(A_BOLD);
+            }
+
+            // clean-up
+            delete lines;
+        }
+
+        // user information
+        PrintStatusMessage("Hit 'e' to enable, 'd' to disable, 'r' to reset, 'u' to update - ESC or 'q' to exit");
+
+        // wait for input
+        Int_t c = getch();
+
+        // decide what to do
+        if (c == KEY_ESC || c == 'q') break;
+        else if (c == 'e') TCQueryLog::Enable();
+        else if (c == 'd') TCQueryLog::Disable();
+        else if (c == 'r') TCQueryLog::GetLog()->Reset();
+    }
+
+    // go back (to the administration menu)
+    return;
+}
+
 //______________________________________________________________________________
 void Administration()
 {
@@ -2193,13 +2257,14 @@ void Administration()
     // menu configuration
     const Char_t mTitle[] = "ADMINISTRATION";
     const Char_t mMsg[] = "Select an administration operation";
-    const Int_t mN = 7;
+    const Int_t mN = 8;
     const Char_t* mEntries[] = { "Export runs",
                                  "Export calibration",
                                  "Import runs",
                                  "Import calibration",
                                  "Clone calibration",
                                  "Export complete database",
+                                 "SQL statement statistics",
                                  "Go back" };
 
     // menue index
@@ -2227,7 +2292,9 @@ void Administration()
                      break;
             case  5: ExportDatabase();
                      break;
-            case  6: return;
+            case  6: ShowQueryLog();
+                     break;
+            case  7: return;
         }
     }
 }
@@ -119,16 +119,41 @@ void TCARHistoLoader::SetHistoName(TH1* h, const Char_t* hnamepatt, Int_t index)
 
 
 //______________________________________________________________________________
-TH1* TCARHistoLoader::GetHisto(const TFile* f, const Char_t* hname, Bool_t detach /*= kTRUE*/)
+TH1* TCARHistoLoader::GetHisto(const TFile* f, const Char_t* hname, Bool_t detach /*= kTRUE*/,
+                               Char_t* keydata /*= 0*/)
 {
     // Basic *static* histogram getter method! Returns the histogram named
     // 'hname' from the file 'f'. If detach is kTRUE it is detached from the
-    // file.
+    // file. If 'keydata' is non-zero the histogram is created from the key
+    // data read by ReadKey() instead of reading it from the file.
     // Returns 0 if the histogram does not exist.
 
     // check for file
     if (!f) return 0;
 
+    // create the histogram from the key data
+    if (keydata)
+    {
+        // get the key (the one read by ReadKey())
+        TKey* key = f->GetKey(hname);
+        if (!key) return 0;
+
+        // check for histogram
+        TClass* cl = gROOT->GetClass(key->GetClassName());
+        if (!cl || !cl->InheritsFrom("TH1")) return 0;
+
+        // get histogram (detached)
+        Bool_t status = TH1::AddDirectoryStatus();
+        if (detach) TH1::AddDirectory(kFALSE);
+        else TH1::AddDirectory(kTRUE);
+
+        TH1* h = (TH1*) key->ReadObjWithBuffer(keydata);
+
+        TH1::AddDirectory(status);
+
+        return h;
+    }
+
     // get list of histos
     TList* list = f->GetListOfKeys();
 
@@ -164,6 +189,36 @@ TH1* TCARHistoLoader::GetHisto(const TFile* f, const Char_t* hname, Bool_t detac
 }
 
 
+//______________________________________________________________________________
+Char_t* TCARHistoLoader::ReadKey(TFile* f, const Char_t* hname)
+{
+    // Basic *static* key data reading method! Reads the key data of the
+    // object named 'hname' from the file 'f' without creating the object.
+    // The data can be passed to GetHisto() or GetHistoForIndex(). As no ROOT
+    // object is created this method can be used in a worker thread as long
+    // as no other thread reads from the file at the same time.
+    // Returns 0 if the object does not exist.
+    // NOTE: the data have to be destroyed by the caller.
+
+    // check for file
+    if (!f) return 0;
+
+    // get the key
+    TKey* key = f->GetKey(hname);
+    if (!key) return 0;
+
+    // read the key data
+    Char_t* keydata = new Char_t[key->GetNbytes()];
+    if (f->ReadBuffer(keydata, key->GetSeekKey(), key->GetNbytes()))
+    {
+        delete [] keydata;
+        return 0;
+    }
+
+    return keydata;
+}
+
+
 //______________________________________________________________________________
 TH1** TCARHistoLoader::GetHistos(const TFile* f, const Char_t* hpatt, Int_t& nhistos, Bool_t detach /*= kTRUE*/)
 {
@@ -257,12 +312,15 @@ TH1* TCARHistoLoader::GetHistoForRun(const Char_t* hname, Int_t runnumber, const
 
 
 //______________________________________________________________________________
-TH1* TCARHistoLoader::GetHistoForIndex(const Char_t* hname, Int_t index, const Char_t* houtnamepatt /*= 0*/)
+TH1* TCARHistoLoader::GetHistoForIndex(const Char_t* hname, Int_t index, const Char_t* houtnamepatt /*= 0*/,
+                                        Char_t* keydata /*= 0*/)
 {
     // Returns the pointer to the histogram with name 'hname' loaded from the
     // file 'fFiles[index]' (i.e., the AR file of the run with run number
     // 'fRuns[i]'). The histogram name is suffixed with an underscore followed
     // by the associated the run number or renamed according to the 'houtnamepatt'.
+    // If 'keydata' is non-zero the histogram is created from the key data
+    // read by ReadKey() (c.f., 'GetHisto()').
     // If the file does not exist or if the histogram cannot be found, the NULL
     // pointer returned
     // NOTE: the histogram has to be destroyed by the caller.
@@ -281,7 +339,7 @@ TH1* TCARHistoLoader::GetHistoForIndex(const Char_t* hname, Int_t index, const C
     if (!fFiles[index]) return 0;
 
     // get histogram detached
-    TH1* h = GetHisto(fFiles[index], hname);
+    TH1* h = GetHisto(fFiles[index], hname, kTRUE, keydata);
 
     // check for histogram
     if (!h)
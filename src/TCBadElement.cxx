@@ -8,11 +8,16 @@
 //                                                                      //
 // Class containing an array of bad elements.                           //
 //                                                                      //
+// The sorted list of bad elements is backed by a bitset, hence         //
+// look-ups are O(1) and merging is linear in the number of elements.   //
+//                                                                      //
 // Have fun!                                                            //
 //                                                                      //
 //////////////////////////////////////////////////////////////////////////
 
 
+#include <algorithm>
+
 #include "TCBadElement.h"
 
 ClassImp(TCBadElement)
@@ -25,9 +30,16 @@ TCBadElement::TCBadElement(const TCBadElement &elem)
     // copy members
     fNElem = elem.GetNElem();
     fNBad = elem.GetNBad();
+    fNAlloc = fNBad;
     fBad = new Int_t[fNBad];
     for (Int_t i = 0; i < fNBad; i++)
         fBad[i] = elem.GetBad()[i];
+
+    // copy bitset
+    fNWords = elem.fNWords;
+    fBits = fNWords ? new UInt_t[fNWords] : 0;
+    for (Int_t i = 0; i < fNWords; i++)
+        fBits[i] = elem.fBits[i];
 }
 
 //______________________________________________________________________________
@@ -39,6 +51,9 @@ TCBadElement::TCBadElement(Int_t nbad, const Int_t* bad, Int_t nelem)
     fNElem = nelem;
     fNBad = 0;
     fBad = 0;
+    fNAlloc = 0;
+    fNWords = 0;
+    fBits = 0;
 
     // add the bad elements
     AddBad(nbad, bad);
@@ -52,64 +67,19 @@ Int_t TCBadElement::MergeNSort(Int_t nbad, const Int_t* bad, Int_t* &bad_sort, I
     // Returns the number of elements in the sorted and merged array
     // 'bad_sort'.
 
-    // init temporary return variables
+    // copy valid entries
     Int_t nbad_new = 0;
-    Int_t* bad_new = new Int_t[nbad];
-
-    // init variables in order to sort and merge
-    Int_t lastentry = -1;
-    Int_t nextentry = -1;
-
-    // loop over sorted array (max nbad elements)
+    Int_t* bad_new = new Int_t[nbad > 0 ? nbad : 1];
     for (Int_t i = 0; i < nbad; i++)
     {
-        // loop over unsorted array to find next larger entry
-        for (Int_t j = 0; j < nbad; j++)
-        {
-            // check for larger entry
-            if (lastentry < bad[j])
-            {
-                // check for first larger entry
-                if(lastentry == nextentry) nextentry = bad[j];
-
-                // check for smaller next entry
-                else if (bad[j] < nextentry) nextentry = bad[j];
-            }
-        }
-
-        // check whether no larger entry was found
-        if (lastentry == nextentry) break;
-
-        // set lastentry for next loop
-        lastentry = nextentry;
-
-        // check whether next entry is out of range
-        if (nelem >= 0 && nextentry >= nelem)
-        {
-            // print warning
-            //Warning("MergeNSort", "Bad element '%d' ignored since it is out of the defined range of [0,%d]!", nextentry, nelem);
-        }
-        else
-        {
-            // save next larger entry
-            bad_new[nbad_new++] = nextentry;
-        }
+        // skip entries out of range
+        if (bad[i] < 0 || (nelem >= 0 && bad[i] >= nelem)) continue;
+        bad_new[nbad_new++] = bad[i];
     }
 
-    // check whether a merge was done
-    if (nbad_new != nbad)
-    {
-       // create new temp array
-       Int_t* bad_tmp = new Int_t[nbad_new];
-
-       // copy array
-       for (Int_t i = 0; i < nbad_new; i++)
-           bad_tmp[i] = bad_new[i];
-
-       // delete array and set pointer
-       if (bad_new) delete [] bad_new;
-       bad_new = bad_tmp;
-    }
+    // sort and remove duplicates
+    std::sort(bad_new, bad_new + nbad_new);
+    nbad_new = std::unique(bad_new, bad_new + nbad_new) - bad_new;
 
     // set pointer to result array & return
     bad_sort = bad_new;
@@ -117,22 +87,94 @@ Int_t TCBadElement::MergeNSort(Int_t nbad, const Int_t* bad, Int_t* &bad_sort, I
     return nbad_new;
 }
 
+//______________________________________________________________________________
+void TCBadElement::ExpandBits(Int_t nbits)
+{
+    // Expand the bitset to hold at least 'nbits' bits.
+
+    // check size
+    Int_t nwords = (nbits + 31) >> 5;
+    if (nwords <= fNWords) return;
+
+    // grow geometrically
+    nwords = std::max(nwords, 2*fNWords);
+
+    // copy old words and clear the new ones
+    UInt_t* bits = new UInt_t[nwords];
+    for (Int_t i = 0; i < fNWords; i++) bits[i] = fBits[i];
+    for (Int_t i = fNWords; i < nwords; i++) bits[i] = 0;
+
+    // delete old bitset and set pointer
+    if (fBits) delete [] fBits;
+    fBits = bits;
+    fNWords = nwords;
+}
+
+//______________________________________________________________________________
+void TCBadElement::ExpandList(Int_t n)
+{
+    // Expand the list of bad elements to hold at least 'n' entries keeping
+    // the current entries.
+
+    // check size
+    if (n <= fNAlloc) return;
+
+    // grow geometrically
+    n = std::max(n, 2*fNAlloc);
+
+    // copy old entries
+    Int_t* bad = new Int_t[n];
+    for (Int_t i = 0; i < fNBad; i++) bad[i] = fBad[i];
+
+    // delete old array and set pointer
+    if (fBad) delete [] fBad;
+    fBad = bad;
+    fNAlloc = n;
+}
+
+//______________________________________________________________________________
+void TCBadElement::BuildList()
+{
+    // Rebuild the sorted list of bad elements from the bitset.
+
+    // count bad elements
+    Int_t nbad = 0;
+    for (Int_t i = 0; i < fNWords; i++)
+        for (UInt_t w = fBits[i]; w; w &= w - 1) nbad++;
+
+    // make sure the list is large enough
+    fNBad = 0;
+    ExpandList(nbad);
+
+    // fill list
+    for (Int_t i = 0; i < fNWords; i++)
+    {
+        if (!fBits[i]) continue;
+        for (Int_t j = 0; j < 32; j++)
+            if ((fBits[i] >> j) & 1) fBad[fNBad++] = (i << 5) + j;
+    }
+}
+
 //______________________________________________________________________________
 Bool_t TCBadElement::IsBad(Int_t bad) const
 {
     // Returns kTRUE if 'bad' is in the list of bad elements, returns kFALSE
     // otherwise.
 
+    return TestBadBit(bad);
+}
+
+//______________________________________________________________________________
+Bool_t TCBadElement::IsEqual(const TCBadElement &elem) const
+{
+    // Returns kTRUE if 'elem' contains the same bad elements, returns kFALSE
+    // otherwise. The total number of elements is not compared.
+
+    if (fNBad != elem.GetNBad()) return kFALSE;
     for (Int_t i = 0; i < fNBad; i++)
-    {
-        if (fBad[i] < bad) continue;
-        if (fBad[i] == bad)
-            return kTRUE;
-        else
-            return kFALSE;
-    }
+        if (fBad[i] != elem.GetBad()[i]) return kFALSE;
 
-    return kFALSE;
+    return kTRUE;
 }
 
 //______________________________________________________________________________
@@ -142,12 +184,8 @@ Int_t TCBadElement::SetBad(Int_t nbad, const Int_t* bad)
     // of bad elements 'bad' to 'fBad'. Old values will be overwritten. Returns
     // the new number of bad scaler reads.
 
-    // reset number of bad elements
-    fNBad = 0;
-
-    // delete old bad element array
-    if (fBad) delete [] fBad;
-    fBad = 0;
+    // reset bad elements
+    RemBad();
 
     // add the bad scaler reads
     return AddBad(nbad, bad);
@@ -166,17 +204,13 @@ Int_t TCBadElement::SetNElem(Int_t nelem)
     // set total scaler reads
     fNElem = nelem;
 
-    // save and reset old bad elements
-    Int_t nbad_old = fNBad;
-    Int_t* bad_old = fBad;
-    fNBad = 0;
-    fBad = 0;
-
-    // re-merge with new fNElem value
-    AddBad(nbad_old, bad_old);
-
-    // delete old array
-    if (bad_old) delete [] bad_old;
+    // remove entries out of range (list is sorted)
+    if (fNElem >= 0)
+    {
+        Int_t nbad = std::lower_bound(fBad, fBad + fNBad, fNElem) - fBad;
+        for (Int_t i = nbad; i < fNBad; i++) ClearBadBit(fBad[i]);
+        fNBad = nbad;
+    }
 
     // return new number of bad elements
     return fNElem;
@@ -188,9 +222,19 @@ Int_t TCBadElement::AddBad(Int_t bad)
     // Adds the single bad element 'bad' to the list of bad elements. Returns
     // the new number of bad elements.
 
-    Int_t bad_tmp = bad;
+    // check range and if already set
+    if (!IsInRange(bad) || TestBadBit(bad)) return fNBad;
+
+    // set bit
+    SetBadBit(bad);
 
-    return AddBad(1, &bad_tmp);
+    // insert into sorted list
+    ExpandList(fNBad + 1);
+    Int_t ind = std::lower_bound(fBad, fBad + fNBad, bad) - fBad;
+    for (Int_t i = fNBad; i > ind; i--) fBad[i] = fBad[i-1];
+    fBad[ind] = bad;
+
+    return ++fNBad;
 }
 
 //______________________________________________________________________________
@@ -202,33 +246,31 @@ Int_t TCBadElement::AddBad(Int_t nbad, const Int_t* bad)
     // nothing to do if nbad <= 0
     if (nbad <= 0) return fNBad;
 
-    // set up new array for old & new bad elements
-    Int_t nbad_tmp = fNBad + nbad;
-    Int_t* bad_tmp = new Int_t[nbad_tmp];
-
-    // fill old bad elements
-    for (Int_t i = 0; i < fNBad; i++) bad_tmp[i] = fBad[i];
-
-    // fill new bad elements
-    for (Int_t i = 0; i < nbad; i++) bad_tmp[fNBad + i] = bad[i];
+    // single element
+    if (nbad == 1) return AddBad(bad[0]);
 
-    // delete old array
-    if (fBad) delete fBad;
-
-    // get sorted & merged array
-    Int_t* bad_new = 0;
-    Int_t nbad_new = MergeNSort(nbad_tmp, bad_tmp, bad_new, fNElem);
+    // set bits of new elements in range
+    Int_t nnew = 0;
+    for (Int_t i = 0; i < nbad; i++)
+    {
+        if (!IsInRange(bad[i]) || TestBadBit(bad[i])) continue;
+        SetBadBit(bad[i]);
+        nnew++;
+    }
 
-    // set new number of bad elements
-    fNBad = nbad_new;
+    // rebuild sorted list
+    if (nnew) BuildList();
 
-    // set new pointer to bad elements array
-    fBad = bad_new;
+    return fNBad;
+}
 
-    // clean up
-    if (bad_tmp) delete [] bad_tmp;
+//______________________________________________________________________________
+Int_t TCBadElement::AddBad(const TCBadElement &elem)
+{
+    // Adds all bad elements of 'elem' to the list of bad elements (union).
+    // Returns the new number of bad elements.
 
-    return fNBad;
+    return AddBad(elem.GetNBad(), elem.GetBad());
 }
 
 //______________________________________________________________________________
@@ -237,29 +279,56 @@ Int_t TCBadElement::RemBad(Int_t &bad)
     // Removes the bad element 'bad' from the list of bad elements. Returns the
     // new number of elements.
 
-    // find index of bad element
-    Int_t ind;
-    for (ind = 0; ind < fNBad; ind++)
-        if (fBad[ind] == bad) break;
-
     // no change if not in list
-    if (ind == fNBad) return fNBad;
-
-    // create new array
-    Int_t* bad_new = new Int_t[fNBad - 1];
+    if (!TestBadBit(bad)) return fNBad;
 
-    // copy old values
-    for (Int_t i = 0; i < ind; i++) bad_new[i] = fBad[i];
-    for (Int_t i = ind + 1; i < fNBad; i++) bad_new[i-1] = fBad[i];
+    // clear bit
+    ClearBadBit(bad);
 
-    // delete old array and set new pointer
-    if (fBad) delete fBad;
-    fBad = bad_new;
+    // remove from sorted list
+    Int_t ind = std::lower_bound(fBad, fBad + fNBad, bad) - fBad;
+    for (Int_t i = ind + 1; i < fNBad; i++) fBad[i-1] = fBad[i];
 
     // return
     return --fNBad;
 }
 
+//______________________________________________________________________________
+Int_t TCBadElement::RemBad(Int_t nbad, const Int_t* bad)
+{
+    // Removes the 'nbad' bad elements of the array 'bad' from the list of bad
+    // elements. Returns the new number of bad elements.
+
+    // clear bits of elements in the list
+    Int_t nrem = 0;
+    for (Int_t i = 0; i < nbad; i++)
+    {
+        if (!TestBadBit(bad[i])) continue;
+        ClearBadBit(bad[i]);
+        nrem++;
+    }
+
+    // compact sorted list
+    if (nrem)
+    {
+        Int_t n = 0;
+        for (Int_t i = 0; i < fNBad; i++)
+            if (TestBadBit(fBad[i])) fBad[n++] = fBad[i];
+        fNBad = n;
+    }
+
+    return fNBad;
+}
+
+//______________________________________________________________________________
+Int_t TCBadElement::RemBad(const TCBadElement &elem)
+{
+    // Removes all bad elements of 'elem' from the list of bad elements
+    // (difference). Returns the new number of bad elements.
+
+    return RemBad(elem.GetNBad(), elem.GetBad());
+}
+
 //______________________________________________________________________________
 void TCBadElement::RemBad()
 {
@@ -267,7 +336,5 @@ void TCBadElement::RemBad()
 
     // reset members
     fNBad = 0;
-    if (fBad) delete [] fBad;
-    fBad = 0;
+    for (Int_t i = 0; i < fNWords; i++) fBits[i] = 0;
 }
-
@@ -15,18 +15,26 @@
 
 #include "TH1.h"
 #include "TF1.h"
+#include "TBackCompFitter.h"
+#include "Math/Minimizer.h"
 #include "TCanvas.h"
 #include "TStyle.h"
 #include "TTimer.h"
 #include "TTimeStamp.h"
 #include "TSystem.h"
 #include "TGClient.h"
+#include "TThread.h"
+#include "TMutex.h"
 #include "KeySymbols.h"
 
 #include "TCCalib.h"
+#include "TCFileManager.h"
 #include "TCUtils.h"
+#include "TCFitFuncPool.h"
+#include "TCFitUtils.h"
 #include "TCMySQLManager.h"
 #include "TCReadConfig.h"
+#include "TCInstrument.h"
 
 
 ClassImp(TCCalib)
@@ -36,12 +44,14 @@ TCCalib::~TCCalib()
 {
     // Destructor.
 
+    StopPrefetch();
     if (fSet) delete [] fSet;
     if (fOldVal) delete [] fOldVal;
     if (fNewVal) delete [] fNewVal;
     if (fMainHisto) delete fMainHisto;
     if (fFitHisto) delete fFitHisto;
-    if (fFitFunc) delete fFitFunc;
+    if (fFitFunc && !(fFitFuncPool && fFitFuncPool->Owns(fFitFunc))) delete fFitFunc;
+    if (fFitFuncPool) delete fFitFuncPool;
     if (fOverviewHisto) delete fOverviewHisto;
     //if (fCanvasFit) delete fCanvasFit;            // comment this to prevent crash
     //if (fCanvasResult) delete fCanvasResult;      // comment this to prevent crash
@@ -66,6 +76,7 @@ void TCCalib::Start(const Char_t* calibration, Int_t nSet, Int_t* set)
     fMainHisto = 0;
     fFitHisto = 0;
     fFitFunc = 0;
+    if (!fFitFuncPool) fFitFuncPool = new TCFitFuncPool(GetName());
 
     fOverviewHisto = 0;
 
@@ -87,16 +98,32 @@ void TCCalib::Start(const Char_t* calibration, Int_t nSet, Int_t* set)
     if (fConvergenceFactor == 0) fConvergenceFactor = 1;
     Info("Start", "Using a convergence factor of %f", fConvergenceFactor);
 
-    // read the elements to ignore
-    sprintf(tmp, "%s.Elements.Ignore", GetName());
-    TString* elem_ig = TCReadConfig::GetReader()->GetConfig(tmp);
-    if (elem_ig)
+    // read the peak fitting method
+    fFastPeakFit = kFALSE;
+    sprintf(tmp, "%s.Fit.Method", GetName());
+    if (TString* method = TCReadConfig::GetReader()->GetConfig(tmp))
     {
-        // create array
-        fIgnore = new Int_t[fNelem];
+        TString m(*method);
+        m.ToLower();
+        if (m == "fast") fFastPeakFit = kTRUE;
+    }
+    if (fFastPeakFit) Info("Start", "Using the fast peak fitter");
+
+    // read the number of elements to prefetch
+    sprintf(tmp, "%s.Prefetch", GetName());
+    fPrefetch = TCReadConfig::GetReader()->GetConfigInt(tmp);
+    if (fPrefetch < 0) fPrefetch = 0;
 
-        // parse the string
-        fNIgnore = TCUtils::ReadCommaSepList(elem_ig, fIgnore);
+    // read the elements to ignore (list parsed once by the configuration reader)
+    sprintf(tmp, "%s.Elements.Ignore", GetName());
+    Int_t elem_ig = TCReadConfig::GetReader()->GetHandle(tmp, kConfigList);
+    if (TCReadConfig::GetReader()->IsSet(elem_ig))
+    {
+        // copy the list
+        fNIgnore = TCReadConfig::GetReader()->GetListSize(elem_ig);
+        fIgnore = new Int_t[fNIgnore > 0 ? fNIgnore : 1];
+        const Int_t* list = TCReadConfig::GetReader()->GetList(elem_ig);
+        for (Int_t i = 0; i < fNIgnore; i++) fIgnore[i] = list[i];
 
         // sort for faster look-up
         std::sort(fIgnore, fIgnore+fNIgnore);
@@ -111,6 +138,10 @@ void TCCalib::Start(const Char_t* calibration, Int_t nSet, Int_t* set)
         Info("Start", "Ignoring %d element(s): %s", fNIgnore, tmp2.Data());
     }
 
+    // resolve the formatting of the fit histograms
+    sprintf(tmp, "%s.Histo.Fit", GetName());
+    TCUtils::GetHistogramFormat(tmp, fFitFormat);
+
     // create timer
     fTimer = new TTimer(100);
     fTimer->Connect("Timeout()", "TCCalib", this, "Next()");
@@ -155,11 +186,17 @@ void TCCalib::Start(const Char_t* calibration, Int_t nSet, Int_t* set)
     fCanvasFit->Connect("ProcessedEvent(Int_t, Int_t, Int_t, TObject*)", "TCCalib", this,
                         "EventHandler(Int_t, Int_t, Int_t, TObject*)");
 
-    // draw the result canvas
-    fCanvasResult = new TCanvas("Result", "Result", gClient->GetDisplayWidth() - 900, 0, 900, 400);
+    // draw the result canvas (no GUI client in batch mode)
+    fCanvasResult = new TCanvas("Result", "Result", gClient ? gClient->GetDisplayWidth() - 900 : 0, 0, 900, 400);
 
     // init sub-class
-    Init();
+    {
+        TCINSTR_SCOPE("TCCalib::Init");
+        Init();
+    }
+
+    // load the next elements in the background
+    StartPrefetch();
 
     // start with the first element
     ProcessElement(0);
@@ -231,6 +268,21 @@ void TCCalib::ProcessElement(Int_t elem, Bool_t ignorePrev)
     // set current element
     fCurrentElem = elem;
 
+    // move the prefetch window and free the data left behind
+    if (fPrefetchThread)
+    {
+        fPrefetchMutex->Lock();
+        fPrefetchIndex = elem;
+        for (Int_t i = 0; i < elem; i++) DeleteElementKeys(i);
+        fPrefetchMutex->UnLock();
+        for (Int_t i = 0; i < elem; i++)
+        {
+            if (fPrefetchHisto[i]) { delete fPrefetchHisto[i]; fPrefetchHisto[i] = 0; }
+        }
+    }
+
+    TCINSTR_SCOPE("TCCalib::Fit");
+
     // process element
     Fit(elem);
 }
@@ -382,6 +434,274 @@ void TCCalib::SaveCanvas(TCanvas* c, const Char_t* name)
     }
 }
 
+//______________________________________________________________________________
+TH1* TCCalib::GetElementHisto(Int_t elem)
+{
+    // Return the histogram of the element 'elem' of the files returned by
+    // GetElementFiles(). The histogram prepared in advance by PrepareNext() or
+    // the key data read by the prefetch thread are used if available,
+    // otherwise the histogram is loaded directly. The caller takes the
+    // ownership.
+
+    // take the histogram prepared in advance
+    if (fPrefetchHisto && fPrefetchHisto[elem])
+    {
+        TH1* h = fPrefetchHisto[elem];
+        fPrefetchHisto[elem] = 0;
+        return h;
+    }
+
+    // take the key data (waits for the element currently being read)
+    Char_t** keys = 0;
+    if (fPrefetchThread)
+    {
+        fIOMutex->Lock();
+        fPrefetchMutex->Lock();
+        keys = fPrefetchKeys[elem];
+        fPrefetchKeys[elem] = 0;
+        fPrefetchDone[elem] = kTRUE;
+        fPrefetchMutex->UnLock();
+        fIOMutex->UnLock();
+    }
+
+    return LoadElement(elem, keys);
+}
+
+//______________________________________________________________________________
+TH1* TCCalib::LoadElement(Int_t elem, Char_t** keys)
+{
+    // Load the histogram of the element 'elem' using the key data 'keys' read
+    // by the prefetch thread (can be 0) and prepare it via PrepareElement().
+    // The key data are destroyed. The caller takes the ownership of the
+    // histogram.
+    // NOTE: This has to be called in the main thread as ROOT objects are
+    //       created.
+
+    // get the files
+    TString name;
+    TCFileManager* fm = GetElementFiles(elem, name);
+    if (!fm) return 0;
+
+    // create the histogram (blocks the file access of the prefetch thread)
+    if (fIOMutex) fIOMutex->Lock();
+    TH1* h = fm->GetHistogram(name.Data(), keys);
+    if (fIOMutex) fIOMutex->UnLock();
+    fm->DeleteKeys(keys);
+
+    // prepare the histogram
+    if (h) PrepareElement(elem, h);
+
+    return h;
+}
+
+//______________________________________________________________________________
+void TCCalib::DeleteElementKeys(Int_t elem)
+{
+    // Destroy the key data of the element 'elem' read by the prefetch thread.
+    // NOTE: The prefetch mutex has to be locked.
+
+    if (!fPrefetchKeys[elem]) return;
+
+    TString name;
+    if (TCFileManager* fm = GetElementFiles(elem, name)) fm->DeleteKeys(fPrefetchKeys[elem]);
+    fPrefetchKeys[elem] = 0;
+}
+
+//______________________________________________________________________________
+void* TCCalib::PrefetchThread(void* arg)
+{
+    // Prefetch thread: reads the key data of the histograms of the elements
+    // following the current element from the files. No ROOT object is
+    // created here, the histograms are created from the key data by
+    // PrepareNext() or GetElementHisto() in the main thread.
+
+    TCCalib* c = (TCCalib*) arg;
+
+    for (;;)
+    {
+        // find next element to read
+        Int_t elem = -1;
+        c->fPrefetchMutex->Lock();
+        if (c->fPrefetchStop)
+        {
+            c->fPrefetchMutex->UnLock();
+            break;
+        }
+        for (Int_t d = 1; d <= c->fPrefetch && elem < 0; d++)
+        {
+            Int_t next = c->fPrefetchIndex + d;
+            if (next < c->fNelem && !c->fPrefetchDone[next]) elem = next;
+        }
+        if (elem >= 0) c->fPrefetchDone[elem] = kTRUE;
+        c->fPrefetchMutex->UnLock();
+
+        // wait if there is nothing to do
+        if (elem < 0)
+        {
+            gSystem->Sleep(20);
+            continue;
+        }
+
+        // read the key data
+        TString name;
+        TCFileManager* fm = c->GetElementFiles(elem, name);
+        if (!fm) continue;
+        c->fIOMutex->Lock();
+        Char_t** keys = fm->ReadKeys(name.Data());
+
+        // hand over to main thread (unless the element was passed already)
+        c->fPrefetchMutex->Lock();
+        if (elem >= c->fPrefetchIndex) c->fPrefetchKeys[elem] = keys;
+        else fm->DeleteKeys(keys);
+        c->fPrefetchMutex->UnLock();
+        c->fIOMutex->UnLock();
+    }
+
+    return 0;
+}
+
+//______________________________________________________________________________
+void TCCalib::PrepareNext()
+{
+    // Prepare the histogram of the next element following the current one
+    // whose key data were read by the prefetch thread. This is called by the
+    // prefetch timer in the main thread while the GUI is idle.
+
+    // check for thread
+    if (!fPrefetchThread) return;
+
+    // loop over the next elements
+    for (Int_t d = 1; d <= fPrefetch; d++)
+    {
+        Int_t elem = fCurrentElem + d;
+        if (elem >= fNelem) break;
+        if (fPrefetchHisto[elem]) continue;
+
+        // take the key data
+        fPrefetchMutex->Lock();
+        Char_t** keys = fPrefetchKeys[elem];
+        fPrefetchKeys[elem] = 0;
+        fPrefetchMutex->UnLock();
+        if (!keys) continue;
+
+        // prepare only one element per call
+        fPrefetchHisto[elem] = LoadElement(elem, keys);
+        return;
+    }
+}
+
+//______________________________________________________________________________
+void TCCalib::StartPrefetch()
+{
+    // Starts the prefetch thread and the prefetch timer if prefetching was
+    // configured.
+
+    // check prefetch mode
+    if (fPrefetch <= 0 || fPrefetchThread) return;
+
+    // init members
+    fPrefetchKeys = new Char_t**[fNelem];
+    fPrefetchHisto = new TH1*[fNelem];
+    fPrefetchDone = new Bool_t[fNelem];
+    for (Int_t i = 0; i < fNelem; i++)
+    {
+        fPrefetchKeys[i] = 0;
+        fPrefetchHisto[i] = 0;
+        fPrefetchDone[i] = kFALSE;
+    }
+    fPrefetchIndex = fCurrentElem;
+    fPrefetchStop = kFALSE;
+
+    // user information
+    Info("StartPrefetch", "Loading the next %d elements in the background", fPrefetch);
+
+    // start thread
+    TThread::Initialize();
+    fPrefetchMutex = new TMutex(kTRUE);
+    fIOMutex = new TMutex(kTRUE);
+    fPrefetchThread = new TThread(TString::Format("%s_Prefetch", GetName()).Data(),
+                                  TCCalib::PrefetchThread, this);
+    fPrefetchThread->Run();
+
+    // start timer
+    fPrefetchTimer = new TTimer(50);
+    fPrefetchTimer->Connect("Timeout()", "TCCalib", this, "PrepareNext()");
+    fPrefetchTimer->Start(50, kFALSE);
+}
+
+//______________________________________________________________________________
+void TCCalib::StopPrefetch()
+{
+    // Stops the prefetch thread and the prefetch timer and deletes all
+    // prefetched data.
+
+    // check for thread
+    if (!fPrefetchThread) return;
+
+    // stop timer
+    fPrefetchTimer->Stop();
+    delete fPrefetchTimer;
+    fPrefetchTimer = 0;
+
+    // stop thread
+    fPrefetchMutex->Lock();
+    fPrefetchStop = kTRUE;
+    fPrefetchMutex->UnLock();
+    fPrefetchThread->Join();
+    delete fPrefetchThread;
+    fPrefetchThread = 0;
+
+    // clean up
+    for (Int_t i = 0; i < fNelem; i++)
+    {
+        DeleteElementKeys(i);
+        if (fPrefetchHisto[i]) delete fPrefetchHisto[i];
+    }
+    delete [] fPrefetchKeys;
+    delete [] fPrefetchHisto;
+    delete [] fPrefetchDone;
+    delete fPrefetchMutex;
+    delete fIOMutex;
+    fPrefetchKeys = 0;
+    fPrefetchHisto = 0;
+    fPrefetchDone = 0;
+    fPrefetchMutex = 0;
+    fIOMutex = 0;
+}
+
+//______________________________________________________________________________
+Int_t TCCalib::FitPeak(TH1* h, TF1* f, Option_t* option)
+{
+    // Fit the function 'f' to the histogram 'h'. If the fast peak fitter was
+    // selected via the configuration and 'f' is a pooled peak function, use
+    // TCFitUtils::FitPeak(), otherwise TH1::Fit() with the option 'option'.
+    // Return 0 on success.
+
+    TCINSTR_SCOPE("TCCalib::FitPeak");
+
+    // fast peak fitter
+    if (fFastPeakFit && fFitFuncPool)
+    {
+        Int_t gausPar, bgPar, bgDeg;
+        if (TCFitFuncPool::GetPeakLayout(fFitFuncPool->GetType(f), &gausPar, &bgPar, &bgDeg))
+            return TCFitUtils::FitPeak(h, f, gausPar, bgPar, bgDeg);
+    }
+
+    // MINUIT
+    Int_t res = h->Fit(f, option);
+
+    // count fit and minimizer function calls
+    if (TCInstrument::IsEnabled())
+    {
+        TCInstrument::Count(kINSTR_FITS);
+        TBackCompFitter* fitter = dynamic_cast<TBackCompFitter*>(TVirtualFitter::GetFitter());
+        if (fitter && fitter->GetMinimizer())
+            TCInstrument::Count(kINSTR_FIT_ITERATIONS, fitter->GetMinimizer()->NCalls());
+    }
+
+    return res;
+}
+
 //______________________________________________________________________________
 Bool_t TCCalib::IsIgnored(Int_t elem)
 {
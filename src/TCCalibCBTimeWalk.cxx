@@ -19,6 +19,7 @@
 #include "TCanvas.h"
 #include "TMath.h"
 #include "TSystem.h"
+#include "TStopwatch.h"
 
 #include "TCCalibCBTimeWalk.h"
 #include "TCConfig.h"
@@ -26,9 +27,183 @@
 #include "TCFileManager.h"
 #include "TCReadConfig.h"
 #include "TCUtils.h"
+#include "TCFitFuncPool.h"
+#include "TCFitUtils.h"
 
 ClassImp(TCCalibCBTimeWalk)
 
+// task of the batch slice fitting
+struct WalkSliceTask
+{
+    TH1** histo;                        // walk histograms
+    Double_t lowLimit;                  // lower energy limit
+    Double_t highLimit;                 // upper energy limit
+    Bool_t useEnergyWeight;             // flag for energy weight
+    Int_t* nPoint;                      // number of fit points
+    Double_t** energy;                  // energies of fit points
+    Double_t** mean;                    // time means of fit points
+    Double_t** error;                   // time mean errors of fit points
+};
+
+//______________________________________________________________________________
+static void FitWalkHisto(TH1* h, Int_t elem, WalkSliceTask* task)
+{
+    // Fit all time projections of the energy slices of the walk histogram 'h'
+    // of the element 'elem' like TCCalibCBTimeWalk::Fit() does and save the
+    // fit points to the task 'task'. The projections are summed up directly
+    // from the histogram bins and fitted using TCFitUtils::FitPeak() without
+    // any ROOT objects to allow the execution in a worker thread.
+
+    // init output
+    task->nPoint[elem] = 0;
+    task->energy[elem] = 0;
+    task->mean[elem] = 0;
+    task->error[elem] = 0;
+
+    // check histogram
+    if (!h) return;
+
+    // get bins for fitting range
+    TAxis* xaxis = h->GetXaxis();
+    TAxis* yaxis = h->GetYaxis();
+    Int_t startBin = xaxis->FindBin(task->lowLimit);
+    Int_t endBin = xaxis->FindBin(task->highLimit);
+    Int_t nY = h->GetNbinsY();
+    if (endBin < startBin) return;
+
+    // create arrays
+    Int_t nMax = endBin - startBin + 1;
+    task->energy[elem] = new Double_t[nMax];
+    task->mean[elem] = new Double_t[nMax];
+    task->error[elem] = new Double_t[nMax];
+    Double_t* proj = new Double_t[nY+2];
+    Double_t* projErr2 = new Double_t[nY+2];
+    Double_t* x = new Double_t[nY];
+    Double_t* y = new Double_t[nY];
+    Double_t* w = new Double_t[nY];
+
+    // prepare stuff for adding
+    Double_t low_e = 0;
+    Int_t added = 0;
+    Double_t added_e = 0;
+    Double_t added_w = 0;
+    Double_t added_entries = 0;
+
+    // loop over energy bins
+    for (Int_t i = startBin; i <= endBin; i++)
+    {
+        // get entries of time projection
+        Double_t entries = 0;
+        for (Int_t j = 0; j <= nY+1; j++) entries += h->GetBinContent(h->GetBin(i, j));
+
+        // skip empty projections
+        if (entries == 0) continue;
+
+        // first loop (after fit)
+        if (added == 0)
+        {
+            low_e = xaxis->GetBinLowEdge(i);
+            for (Int_t j = 0; j <= nY+1; j++)
+            {
+                proj[j] = 0;
+                projErr2[j] = 0;
+            }
+
+            // reset values
+            added_e = 0;
+            added_w = 0;
+            added_entries = 0;
+        }
+
+        // add time projection
+        for (Int_t j = 0; j <= nY+1; j++)
+        {
+            Int_t bin = h->GetBin(i, j);
+            Double_t err = h->GetBinError(bin);
+            proj[j] += h->GetBinContent(bin);
+            projErr2[j] += err*err;
+        }
+        added_entries += entries;
+
+        // add up bin contribution
+        Double_t weight = task->useEnergyWeight ? entries : 1.;
+        added_w += weight;
+        added_e += xaxis->GetBinCenter(i) * weight;
+        added++;
+
+        // calc energy interval
+        Double_t e_int = xaxis->GetBinUpEdge(i) - low_e;
+
+        // minimum energy interval
+        if (e_int < 0.5) continue;
+
+        // check if projection has enough entries
+        if (added_entries < 100 && i < endBin)
+            continue;
+
+        // calculate mean energy
+        Double_t energy = added_e/added_w;
+
+        // reset value
+        added = 0;
+
+        // find maximum
+        Int_t maxbin = 1;
+        for (Int_t j = 2; j <= nY; j++)
+            if (proj[j] > proj[maxbin]) maxbin = j;
+        Double_t peak = yaxis->GetBinCenter(maxbin);
+        Double_t max = proj[maxbin];
+
+        // read the bins in the fit range
+        Int_t n = 0;
+        for (Int_t j = 1; j <= nY; j++)
+        {
+            Double_t xc = yaxis->GetBinCenter(j);
+            if (xc < peak - 20 || xc > peak + 20 || projErr2[j] <= 0) continue;
+            x[n] = xc;
+            y[n] = proj[j];
+            w[n] = 1. / projErr2[j];
+            n++;
+        }
+
+        // prepare fit
+        Double_t par[3] = { max, peak, 1. };
+        Double_t parErr[3] = { 0, 0, 0 };
+        Double_t parMin[3] = { max*0.5, peak - 5, 0.5 };    // peak height, position, sigma
+        Double_t parMax[3] = { max*1.5, peak + 5, 20.0 };
+
+        // perform fit
+        Int_t status = TCFitUtils::FitPeak(n, x, y, w, 3, par, parErr, parMin, parMax, 0, 0, -1);
+
+        // check fit (failed fits return zero errors that would dominate the walk fit)
+        if (status == 0 && parErr[1] > 0 && parErr[1] < 1.)
+        {
+            Int_t p = task->nPoint[elem]++;
+            task->energy[elem][p] = energy;
+            task->mean[elem][p] = par[1];
+            task->error[elem][p] = parErr[1];
+        }
+
+    } // for: loop over energy bins
+
+    // clean-up
+    delete [] proj;
+    delete [] projErr2;
+    delete [] x;
+    delete [] y;
+    delete [] w;
+}
+
+//______________________________________________________________________________
+static void FitWalkSlices(Int_t elem, void* arg)
+{
+    // Fit the energy slices of the walk histogram of the element 'elem' of
+    // the task 'arg'.
+
+    WalkSliceTask* task = (WalkSliceTask*) arg;
+    FitWalkHisto(task->histo[elem], elem, task);
+}
+
 //______________________________________________________________________________
 TCCalibCBTimeWalk::TCCalibCBTimeWalk()
     : TCCalib("CB.TimeWalk", "CB time walk calibration", "Data.CB.Walk.Par0", TCConfig::kMaxCB)
@@ -48,6 +223,14 @@ TCCalibCBTimeWalk::TCCalibCBTimeWalk()
     fUseEnergyWeight = kTRUE;
     fUsePointDensityWeight = kTRUE;
     fWalkType = kDefault;
+    fBatchFit = kFALSE;
+    fBatchHisto = 0;
+    fBatchNPoint = 0;
+    fBatchEnergy = 0;
+    fBatchMean = 0;
+    fBatchError = 0;
+    fSliceLow = 0;
+    fSliceHigh = 0;
 }
 
 //______________________________________________________________________________
@@ -55,6 +238,7 @@ TCCalibCBTimeWalk::~TCCalibCBTimeWalk()
 {
     // Destructor.
 
+    StopPrefetch();
     if (fFileManager) delete fFileManager;
     if (fPar0) delete [] fPar0;
     if (fPar1) delete [] fPar1;
@@ -63,6 +247,138 @@ TCCalibCBTimeWalk::~TCCalibCBTimeWalk()
     if (fGFitPoints) delete fGFitPoints;
     if (fTimeProj) delete fTimeProj;
     if (fLine) delete fLine;
+    DeleteBatch();
+}
+
+//______________________________________________________________________________
+void TCCalibCBTimeWalk::DeleteBatch()
+{
+    // Delete the histograms and fit points of the batch mode.
+
+    for (Int_t i = 0; i < fNelem; i++)
+    {
+        if (fBatchHisto && fBatchHisto[i]) delete fBatchHisto[i];
+        if (fBatchEnergy && fBatchEnergy[i]) delete [] fBatchEnergy[i];
+        if (fBatchMean && fBatchMean[i]) delete [] fBatchMean[i];
+        if (fBatchError && fBatchError[i]) delete [] fBatchError[i];
+    }
+    if (fBatchHisto) delete [] fBatchHisto;
+    if (fBatchNPoint) delete [] fBatchNPoint;
+    if (fBatchEnergy) delete [] fBatchEnergy;
+    if (fBatchMean) delete [] fBatchMean;
+    if (fBatchError) delete [] fBatchError;
+    fBatchHisto = 0;
+    fBatchNPoint = 0;
+    fBatchEnergy = 0;
+    fBatchMean = 0;
+    fBatchError = 0;
+}
+
+//______________________________________________________________________________
+void TCCalibCBTimeWalk::FitSlicesBatch(Double_t lowLimit, Double_t highLimit)
+{
+    // Load the walk histograms of all elements in one pass over the files and
+    // fit the time projections of all energy slices in parallel. The fit
+    // points are used by Fit() instead of fitting the slices of each element
+    // on display.
+
+    Char_t tmp[256];
+    TStopwatch watch;
+
+    // user information
+    Info("FitSlicesBatch", "Loading the walk histograms of %d elements", fNelem);
+
+    // create histogram names
+    Char_t** names = new Char_t*[fNelem];
+    for (Int_t i = 0; i < fNelem; i++)
+    {
+        sprintf(tmp, "%s_%03d", fHistoName.Data(), i);
+        names[i] = new Char_t[strlen(tmp)+1];
+        strcpy(names[i], tmp);
+    }
+
+    // load all histograms
+    DeleteBatch();
+    fBatchHisto = new TH1*[fNelem];
+    fFileManager->GetHistograms(fNelem, names, fBatchHisto);
+
+    // clean-up
+    for (Int_t i = 0; i < fNelem; i++) delete [] names[i];
+    delete [] names;
+
+    // bins must not be read from the buffer in the worker threads
+    for (Int_t i = 0; i < fNelem; i++)
+        if (fBatchHisto[i]) fBatchHisto[i]->BufferEmpty();
+
+    // create arrays
+    fBatchNPoint = new Int_t[fNelem];
+    fBatchEnergy = new Double_t*[fNelem];
+    fBatchMean = new Double_t*[fNelem];
+    fBatchError = new Double_t*[fNelem];
+
+    // fit slices in parallel
+    Int_t nThreads = TCUtils::GetNumberOfThreads();
+    Info("FitSlicesBatch", "Fitting the energy slices using %d threads", nThreads);
+    WalkSliceTask task;
+    task.histo = fBatchHisto;
+    task.lowLimit = lowLimit;
+    task.highLimit = highLimit;
+    task.useEnergyWeight = fUseEnergyWeight;
+    task.nPoint = fBatchNPoint;
+    task.energy = fBatchEnergy;
+    task.mean = fBatchMean;
+    task.error = fBatchError;
+    TCUtils::ParallelFor(fNelem, FitWalkSlices, &task, nThreads);
+
+    // mark elements without histogram
+    for (Int_t i = 0; i < fNelem; i++)
+        if (!fBatchHisto[i]) fBatchNPoint[i] = -1;
+
+    // user information
+    Info("FitSlicesBatch", "Fitted the energy slices of %d elements in %.2f s",
+         fNelem, watch.RealTime());
+}
+
+//______________________________________________________________________________
+TCFileManager* TCCalibCBTimeWalk::GetElementFiles(Int_t elem, TString& outName)
+{
+    // Return the file manager and the name 'outName' of the walk histogram
+    // of the element 'elem'.
+
+    outName = TString::Format("%s_%03d", fHistoName.Data(), elem);
+
+    return fFileManager;
+}
+
+//______________________________________________________________________________
+void TCCalibCBTimeWalk::PrepareElement(Int_t elem, TH1* h)
+{
+    // Fit the energy slices of the walk histogram 'h' of the element 'elem'
+    // for Fit() like in batch mode. This is executed in the main thread while
+    // the GUI is idle (see TCCalib::PrepareNext()).
+
+    // check for fit point arrays
+    if (!fBatchNPoint) return;
+
+    // delete old fit points
+    if (fBatchEnergy[elem]) delete [] fBatchEnergy[elem];
+    if (fBatchMean[elem]) delete [] fBatchMean[elem];
+    if (fBatchError[elem]) delete [] fBatchError[elem];
+
+    // bins must not be read from the buffer
+    h->BufferEmpty();
+
+    // fit slices
+    WalkSliceTask task;
+    task.histo = 0;
+    task.lowLimit = fSliceLow;
+    task.highLimit = fSliceHigh;
+    task.useEnergyWeight = fUseEnergyWeight;
+    task.nPoint = fBatchNPoint;
+    task.energy = fBatchEnergy;
+    task.mean = fBatchMean;
+    task.error = fBatchError;
+    FitWalkHisto(h, elem, &task);
 }
 
 //______________________________________________________________________________
@@ -128,12 +444,42 @@ void TCCalibCBTimeWalk::Init()
         }
     }
 
+    // get batch mode
+    fBatchFit = TCReadConfig::GetReader()->GetConfigInt("CB.TimeWalk.Fit.Batch") ? kTRUE : kFALSE;
+
     // read old parameters (only from first set)
     TCMySQLManager::GetManager()->ReadParameters("Data.CB.Walk.Par0", fCalibration.Data(), fSet[0], fPar0, fNelem);
     TCMySQLManager::GetManager()->ReadParameters("Data.CB.Walk.Par1", fCalibration.Data(), fSet[0], fPar1, fNelem);
     TCMySQLManager::GetManager()->ReadParameters("Data.CB.Walk.Par2", fCalibration.Data(), fSet[0], fPar2, fNelem);
     TCMySQLManager::GetManager()->ReadParameters("Data.CB.Walk.Par3", fCalibration.Data(), fSet[0], fPar3, fNelem);
 
+    // get energy range of the slice fits
+    TCReadConfig::GetReader()->GetConfigDoubleDouble("CB.TimeWalk.Histo.Fit.Xaxis.Range", &fSliceLow, &fSliceHigh);
+
+    // fit the energy slices of all elements
+    if (fBatchFit)
+    {
+        FitSlicesBatch(fSliceLow, fSliceHigh);
+
+        // all histograms are loaded already
+        fPrefetch = 0;
+    }
+    else if (fPrefetch > 0)
+    {
+        // create the fit point arrays filled by the prefetch thread
+        fBatchNPoint = new Int_t[fNelem];
+        fBatchEnergy = new Double_t*[fNelem];
+        fBatchMean = new Double_t*[fNelem];
+        fBatchError = new Double_t*[fNelem];
+        for (Int_t i = 0; i < fNelem; i++)
+        {
+            fBatchNPoint[i] = -1;
+            fBatchEnergy[i] = 0;
+            fBatchMean[i] = 0;
+            fBatchError[i] = 0;
+        }
+    }
+
     // draw main histogram
     fCanvasFit->Divide(1, 2, 0.001, 0.001);
     fCanvasFit->cd(1)->SetLogz();
@@ -153,17 +499,19 @@ void TCCalibCBTimeWalk::Fit(Int_t elem)
     Double_t lowLimit, highLimit;
     TCReadConfig::GetReader()->GetConfigDoubleDouble("CB.TimeWalk.Histo.Fit.Xaxis.Range", &lowLimit, &highLimit);
 
-    // create histogram name
-    sprintf(tmp, "%s_%03d", fHistoName.Data(), elem);
-
     // get histogram
     if (!fIsReFit)
     {
         // delete old histogram
         if (fMainHisto) delete fMainHisto;
 
-         // get new
-        fMainHisto = fFileManager->GetHistogram(tmp);
+         // get new (take over the histogram loaded in batch mode)
+        if (fBatchHisto && fBatchHisto[elem])
+        {
+            fMainHisto = fBatchHisto[elem];
+            fBatchHisto[elem] = 0;
+        }
+        else fMainHisto = GetElementHisto(elem);
     }
 
     if (!fMainHisto)
@@ -209,6 +557,19 @@ void TCCalibCBTimeWalk::Fit(Int_t elem)
     Int_t startBin = fMainHisto->GetXaxis()->FindBin(lowLimit);
     Int_t endBin = fMainHisto->GetXaxis()->FindBin(highLimit);
 
+    // use the fit points of the batch mode
+    if (!fIsReFit && fBatchNPoint && fBatchNPoint[elem] >= 0)
+    {
+        for (Int_t i = 0; i < fBatchNPoint[elem]; i++)
+        {
+            fGFitPoints->SetPoint(i, fBatchEnergy[elem][i], fBatchMean[elem][i]);
+            fGFitPoints->SetPointError(i, 0., fBatchError[elem][i]);
+        }
+
+        // skip the slice fits
+        endBin = startBin - 1;
+    }
+
     // loop over energy bins
     for (Int_t i = startBin; i <= endBin; i++)
     {
@@ -265,10 +626,8 @@ void TCCalibCBTimeWalk::Fit(Int_t elem)
         // fit time projection
         //
 
-        // create fitting function
-        if (fFitFunc) delete fFitFunc;
-        sprintf(tmp, "fWalkProfile_%i", elem);
-        fFitFunc = new TF1(tmp, "gaus(0)");
+        // get fitting function
+        fFitFunc = fFitFuncPool->Get(TCFitFuncPool::kGaus);
         fFitFunc->SetLineColor(kBlue);
 
         // prepare fitting function
@@ -356,13 +715,11 @@ void TCCalibCBTimeWalk::Fit(Int_t elem)
         return;
     }
 
-    // create fitting function
-    sprintf(tmp, "fTWalk_%d", elem);
-    if (fFitFunc) delete fFitFunc;
+    // get fitting function
     if (fWalkType == kDefault)
-        fFitFunc = new TF1(tmp, "[0] + [1] / TMath::Power(x + [2], [3])", lowLimit, highLimit);
+        fFitFunc = fFitFuncPool->Get(TCFitFuncPool::kWalkDefault, lowLimit, highLimit);
     else if (fWalkType == kStrub)
-        fFitFunc = new TF1(tmp, "[0] + [1] / TMath::Power(x - 1, [3]) + x*[2]", lowLimit, highLimit);
+        fFitFunc = fFitFuncPool->Get(TCFitFuncPool::kWalkStrub, lowLimit, highLimit);
     fFitFunc->SetLineColor(kBlue);
     fFitFunc->SetNpx(2000);
 
@@ -255,8 +255,7 @@ void TCCalibDiscrThr::Fit(Int_t elem)
                 {
                     Int_t lastBin = fDeriv->GetXaxis()->GetLast();
                     fDeriv->GetXaxis()->SetRangeUser(fPed[elem]+7, fDeriv->GetXaxis()->GetBinCenter(lastBin));
-                    sprintf(tmp, "%s.Histo.Fit", GetName());
-                    TCUtils::FormatHistogram(fFitHisto, tmp);
+                    TCUtils::FormatHistogram(fFitHisto, fFitFormat);
                 }
 
                 // get maximum
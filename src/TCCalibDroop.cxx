@@ -244,7 +244,7 @@ void TCCalibDroop::FitSlices(TH3* h, Int_t elem)
     // plot projection fit
     if (fDelay > 0)
     {
-        TCUtils::FormatHistogram(fProj2D, TString::Format("%s.Histo.Fit", GetName()).Data());
+        TCUtils::FormatHistogram(fProj2D, fFitFormat);
         fCanvasFit->cd(1);
         fProj2D->Draw("colz");
         fFitHisto->GetXaxis()->SetRangeUser(0, peakTotal+3);
@@ -317,7 +317,7 @@ void TCCalibDroop::FitSlices(TH3* h, Int_t elem)
         // plot projection fit
         if (fDelay > 0)
         {
-            TCUtils::FormatHistogram(fProj2D, TString::Format("%s.Histo.Fit", GetName()).Data());
+            TCUtils::FormatHistogram(fProj2D, fFitFormat);
             fCanvasFit->cd(1);
             fProj2D->Draw("colz");
             fFitHisto->GetXaxis()->SetRangeUser(0, peak+4);
@@ -21,6 +21,7 @@
 #include "TCFileManager.h"
 #include "TCUtils.h"
 #include "TCFitUtils.h"
+#include "TCFitFuncPool.h"
 #include "TCLine.h"
 
 ClassImp(TCCalibEnergy)
@@ -128,10 +129,8 @@ void TCCalibEnergy::Fit(Int_t elem)
     // check for sufficient statistics
     if (fFitHisto->Integral() > 100 && !IsIgnored(elem))
     {
-        // delete old function
-        if (fFitFunc) delete fFitFunc;
-        sprintf(tmp, "fEnergy_%i", elem);
-        fFitFunc = new TF1(tmp, "gaus(0)+pol3(3)");
+        // get the fit function
+        fFitFunc = fFitFuncPool->Get(TCFitFuncPool::kGausPol3);
         fFitFunc->SetLineColor(2);
 
         // set peak position
@@ -168,7 +167,8 @@ void TCCalibEnergy::Fit(Int_t elem)
         if (fIsReFit) fFitFunc->SetParLimits(1, (1. - 0.03)*fPi0Pos, (1. + 0.03)*fPi0Pos);
 
         // fit
-        TCFitUtils::ReFit(fFitHisto, fFitFunc, "RBQ0", 10);
+        if (fFastPeakFit) FitPeak(fFitHisto, fFitFunc, "RBQ0");
+        else TCFitUtils::ReFit(fFitHisto, fFitFunc, "RBQ0", 10);
 
         // final results
         fPi0Pos = fFitFunc->GetParameter(1);
@@ -212,7 +212,7 @@ void TCCalibPIDEnergy::FitSlices(TH2* h)
         Int_t lastBin = h->GetXaxis()->FindBin(start + interval);
         if (fFitHisto) delete fFitHisto;
         fFitHisto = (TH1D*) h->ProjectionY(tmp, firstBin, lastBin, "e");
-        if (h != fMCHisto) TCUtils::FormatHistogram(fFitHisto, "PID.Energy.Histo.Fit");
+        if (h != fMCHisto) TCUtils::FormatHistogram(fFitHisto, fFitFormat);
 
         // create fitting function
         if (fFitFunc) delete fFitFunc;
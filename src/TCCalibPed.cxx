@@ -22,6 +22,7 @@
 #include "TCReadARCalib.h"
 #include "TCMySQLManager.h"
 #include "TCUtils.h"
+#include "TCFitFuncPool.h"
 
 ClassImp(TCCalibPed)
 
@@ -44,6 +45,7 @@ TCCalibPed::~TCCalibPed()
 {
     // Destructor.
 
+    StopPrefetch();
     if (fADC) delete [] fADC;
     if (fFileManager) delete fFileManager;
     if (fLine) delete fLine;
@@ -93,6 +95,9 @@ void TCCalibPed::Init()
         Error("Init", "Main histogram does not exist!\n");
     }
 
+    // only the raw ADC spectra are loaded per element
+    if (fMainHisto) fPrefetch = 0;
+
     // create the overview histogram
     fOverviewHisto = new TH1F("Overview", ";Element;Pedestal position [Channel]", fNelem, 0, fNelem);
     fOverviewHisto->SetMarkerStyle(2);
@@ -115,6 +120,17 @@ void TCCalibPed::Init()
     fOverviewHisto->Draw("P");
 }
 
+//______________________________________________________________________________
+TCFileManager* TCCalibPed::GetElementFiles(Int_t elem, TString& outName)
+{
+    // Return the file manager and the name 'outName' of the raw ADC spectrum
+    // of the element 'elem'.
+
+    outName = TString::Format("ADC%d", fADC[elem]);
+
+    return fFileManager;
+}
+
 //______________________________________________________________________________
 void TCCalibPed::Fit(Int_t elem)
 {
@@ -135,9 +151,8 @@ void TCCalibPed::Fit(Int_t elem)
     }
     else
     {
-        // load the pedestal histogram
-        sprintf(tmp, "ADC%d", fADC[elem]);
-        fFitHisto = fFileManager->GetHistogram(tmp);
+        // load the pedestal histogram (prefetched in the background)
+        fFitHisto = GetElementHisto(elem);
     }
 
     // skip empty channels
@@ -146,8 +161,7 @@ void TCCalibPed::Fit(Int_t elem)
     // dummy position
     fMean = 100;
 
-    // delete old function
-    if (fFitFunc) delete fFitFunc;
+    // release old function
     fFitFunc = 0;
 
     // check for sufficient statistics
@@ -157,8 +171,7 @@ void TCCalibPed::Fit(Int_t elem)
     }
     else
     {
-        sprintf(tmp, "fPed_%i", elem);
-        fFitFunc = new TF1(tmp, "gaus");
+        fFitFunc = fFitFuncPool->Get(TCFitFuncPool::kGaus);
         fFitFunc->SetLineColor(2);
 
         // check for main histogram
@@ -205,7 +218,7 @@ void TCCalibPed::Fit(Int_t elem)
         if (fIsReFit) fFitFunc->SetParLimits(1, fMean - 1, fMean + 1);
 
         // do fit
-        fFitHisto->Fit(fFitFunc, "RBQ0");
+        FitPeak(fFitHisto, fFitFunc, "RBQ0");
 
         // final results
         fMean = fFitFunc->GetParameter(1);
@@ -186,8 +186,7 @@ void TCCalibPhi::Fit(Int_t elem)
     // draw histogram
     fFitHisto->SetFillColor(35);
     fCanvasFit->cd(2);
-    sprintf(tmp, "%s.Histo.Fit", GetName());
-    TCUtils::FormatHistogram(fFitHisto, tmp);
+    TCUtils::FormatHistogram(fFitHisto, fFitFormat);
     fFitHisto->Draw("hist");
 
     // draw fitting function
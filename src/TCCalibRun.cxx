@@ -33,6 +33,7 @@ TCCalibRun::~TCCalibRun()
     if (fCalibration) delete fCalibration;
     if (fCalibData) delete fCalibData;
     if (fRuns) delete [] fRuns;
+    if (fPrefetchTimer) delete fPrefetchTimer;
 }
 
 //______________________________________________________________________________
@@ -62,7 +63,7 @@ Bool_t TCCalibRun::Start(Int_t nruns, const Int_t* runs)
 {
     // Sets the configuration for base and child class ('SetConfig()'), prepares
     // run number array (from calib database), loads the histos, inits child and
-    // processes first run.
+    // processes first run (not in headless mode).
 
     // check whether already started
     if (fIsStarted)
@@ -92,8 +93,11 @@ Bool_t TCCalibRun::Start(Int_t nruns, const Int_t* runs)
     // user info
     Info("Start", "Starting calibration...");
 
-    // start with the first run
-    Process(0);
+    // prepare the next runs while idle
+    StartPrefetchTimer();
+
+    // start with the first run (not in headless mode)
+    if (!fIsHeadless) Process(0);
 
     return kTRUE;
 }
@@ -103,7 +107,7 @@ Bool_t TCCalibRun::Start(const Char_t* calibration)
 {
     // Sets the configuration for base and child class ('SetConfig()'), prepares
     // run number array (from calib database), loads the histos, inits child and
-    // processes first run.
+    // processes first run (not in headless mode).
 
     // check whether already started
     if (fIsStarted)
@@ -134,12 +138,71 @@ Bool_t TCCalibRun::Start(const Char_t* calibration)
     // user info
     Info("Start", "Starting calibration...");
 
-    // start with the first run
-    Process(0);
+    // prepare the next runs while idle
+    StartPrefetchTimer();
+
+    // start with the first run (not in headless mode)
+    if (!fIsHeadless) Process(0);
 
     return kTRUE;
 }
 
+//______________________________________________________________________________
+void TCCalibRun::Stop()
+{
+    // Stops the calibration, e.g. to start another calibration module
+    // afterwards in the same session.
+
+    // check whether already started
+    if (!fIsStarted)
+    {
+        Error("Stop", "Not yet started!");
+        return;
+    }
+
+    // stop preparing runs
+    if (fPrefetchTimer) fPrefetchTimer->Stop();
+
+    // reset started flag
+    fIsStarted = kFALSE;
+}
+
+//______________________________________________________________________________
+void TCCalibRun::StartPrefetchTimer()
+{
+    // Starts the timer preparing the 'fPrefetch' runs following the current
+    // run while the GUI is idle (not in headless mode).
+
+    // check prefetch mode
+    if (fIsHeadless || fPrefetch <= 0) return;
+
+    // create timer
+    if (!fPrefetchTimer)
+    {
+        fPrefetchTimer = new TTimer(50);
+        fPrefetchTimer->Connect("Timeout()", "TCCalibRun", this, "PrepareNext()");
+    }
+
+    // start timer
+    fPrefetchTimer->Start(50, kFALSE);
+}
+
+//______________________________________________________________________________
+void TCCalibRun::PrepareNext()
+{
+    // Prepares the first unprepared run of the 'fPrefetch' runs following
+    // the current run via 'PrepareRun()'. Called by the prefetch timer, i.e.,
+    // in the main thread while the GUI is idle, one run per call to keep the
+    // GUI responsive.
+
+    // check whether already started
+    if (!fIsStarted) return;
+
+    // prepare the next run
+    for (Int_t d = 1; d <= fPrefetch && fIndex + d < fNRuns; d++)
+        if (PrepareRun(fIndex + d)) return;
+}
+
 //______________________________________________________________________________
 void TCCalibRun::ProcessAuto(Bool_t start /*= kTRUE*/, Int_t msecDelay /*= -1*/)
 {
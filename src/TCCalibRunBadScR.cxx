@@ -22,6 +22,10 @@
 #include "TROOT.h"
 #include "TH2.h"
 #include "TFile.h"
+#include "TMath.h"
+#include "TSystem.h"
+#include "TThread.h"
+#include "TMutex.h"
 #include "KeySymbols.h"
 
 #include "TCCalibRunBadScR.h"
@@ -29,6 +33,7 @@
 #include "TCReadConfig.h"
 #include "TCARHistoLoader.h"
 #include "TCMySQLManager.h"
+#include "TCUtils.h"
 
 ClassImp(TCCalibRunBadScR)
 
@@ -62,6 +67,9 @@ void TCCalibRunBadScR::CleanUp()
 {
     // Clean up
 
+    // stop prefetching
+    StopPrefetch();
+
     if (fHistoLoader)
     {
         delete fHistoLoader;
@@ -206,6 +214,17 @@ Bool_t TCCalibRunBadScR::SetConfig()
         Info("Start", "Using calibration method '%s'.", fCalibMethod);
     }
 
+    // parameters of the automatic calibration methods
+    sprintf(tmp, "BadScR.Detect.Tolerance");
+    if (TCReadConfig::GetReader()->GetConfig(tmp))
+        fDetectTolerance = TCReadConfig::GetReader()->GetConfigDouble(tmp);
+    sprintf(tmp, "BadScR.Detect.NSigma");
+    if (TCReadConfig::GetReader()->GetConfig(tmp))
+        fDetectNSigma = TCReadConfig::GetReader()->GetConfigDouble(tmp);
+    sprintf(tmp, "BadScR.Detect.Window");
+    if (TCReadConfig::GetReader()->GetConfig(tmp))
+        fDetectWindow = TCReadConfig::GetReader()->GetConfigInt(tmp);
+
     // load histos in advance
     sprintf(tmp, "BadScR.LoadHistosInAdvance");
     if (TCReadConfig::GetReader()->GetConfig(tmp))
@@ -213,6 +232,34 @@ Bool_t TCCalibRunBadScR::SetConfig()
         fLoadHistosInAdvance = (Bool_t) TCReadConfig::GetReader()->GetConfigInt(tmp);
     }
 
+    // paging mode: keep only the histos of the runs around the current run
+    sprintf(tmp, "BadScR.Histo.PageSize");
+    if (TCReadConfig::GetReader()->GetConfig(tmp))
+    {
+        fPrefetch = TCReadConfig::GetReader()->GetConfigInt(tmp);
+        fCacheSize = fPrefetch;
+    }
+
+    // number of runs loaded ahead of the current run
+    sprintf(tmp, "BadScR.Histo.Prefetch");
+    if (TCReadConfig::GetReader()->GetConfig(tmp))
+        fPrefetch = TCReadConfig::GetReader()->GetConfigInt(tmp);
+
+    // number of recent runs kept behind the current run
+    sprintf(tmp, "BadScR.Histo.Cache");
+    if (TCReadConfig::GetReader()->GetConfig(tmp))
+        fCacheSize = TCReadConfig::GetReader()->GetConfigInt(tmp);
+
+    // check paging mode
+    if (fPrefetch < 0) fPrefetch = 0;
+    if (fCacheSize < 0) fCacheSize = 0;
+    if (IsPaging())
+    {
+        fLoadHistosInAdvance = kFALSE;
+        Info("Start", "Keeping the histograms of %d runs before and %d runs after the current run in memory.",
+             fCacheSize, fPrefetch);
+    }
+
     return kTRUE;
 }
 
@@ -222,6 +269,8 @@ Bool_t TCCalibRunBadScR::Init()
     // Loads main and scaler histogras, creates (normalized) projections of main
     // histograms, reads old bad scaler reads from the calib database, sets up
     // the overview histogram and creates the canvas.
+    // In paging mode only the histos of the runs in the window are loaded
+    // (see LoadHistos()).
 
     // call parent Init()
     TCCalibRun::Init();
@@ -328,15 +377,26 @@ Bool_t TCCalibRunBadScR::Init()
         }
     }
 
-    // user info
-    Info("Init", "Projecting main histograms...");
-
     // load projection histograms
-    if (!(fProjHistos = (TH1**) fHistoLoader->CreateHistoArrayOfProj(fMainHistoName, 'X')))
+    if (IsPaging())
     {
-        Error("Init", "Could not load any projection of histograms named '%s'!", fMainHistoName);
-        CleanUp();
-        return kFALSE;
+        // only create and init projection array (filled by LoadHistos() for
+        // the runs in the window)
+        fProjHistos = new TH1*[fNRuns];
+        for (Int_t i = 0; i < fNRuns; i++)
+            fProjHistos[i] = 0;
+    }
+    else
+    {
+        // user info
+        Info("Init", "Projecting main histograms...");
+
+        if (!(fProjHistos = (TH1**) fHistoLoader->CreateHistoArrayOfProj(fMainHistoName, 'X')))
+        {
+            Error("Init", "Could not load any projection of histograms named '%s'!", fMainHistoName);
+            CleanUp();
+            return kFALSE;
+        }
     }
 
     // create and init normalized projection array
@@ -356,9 +416,8 @@ Bool_t TCCalibRunBadScR::Init()
         if (!(fScalerFreeHistos && fScalerLiveHistos))
                 Warning("Init", "Histograms will not be livetime corrected.");
 
-        // loop over runs
-        for (Int_t i = 0; i < fNRuns; i++)
-            if (fLoadHistosInAdvance) NormalizeHisto(i);
+        // normalize all runs
+        if (fLoadHistosInAdvance) NormalizeHistos(0, fNRuns-1);
     }
 
     // load & prepare bad scaler reads -----------------------------------------
@@ -370,15 +429,17 @@ Bool_t TCCalibRunBadScR::Init()
     // user info
     Info("Init", "Reading old bad scaler reads from database...");
 
-    // read bad scaler reads from database
+    // read numbers of scaler reads and bad scaler reads of all runs
+    Int_t* nscr_db = new Int_t[fNRuns];
+    if (!TCMySQLManager::GetManager()->ReadRunsBadScR(fNRuns, fRuns, (*fCalibData).Data(),
+                                                      nscr_db, fBadScROld))
+        Error("Init", "Could not read bad scaler reads from database!");
+
+    // loop over runs
     for (Int_t i = 0; i < fNRuns; i++)
     {
-        // init bad scaler read array
-        fBadScROld[i] = 0;
-        fBadScRNew[i] = 0;
-
         // get number of scaler reads from database
-        Int_t nscr = TCMySQLManager::GetManager()->GetRunNScR(fRuns[i]);
+        Int_t nscr = nscr_db[i];
 
         // get number of scaler reads from event info histo
         if (fHistoLoader->GetFiles()[i])
@@ -391,6 +452,8 @@ Bool_t TCCalibRunBadScR::Init()
             {
                  if (nscr == -1)
                      Warning("Init", "Number of scaler reads for run '%i' is not set in the database yet!", fRuns[i]);
+                 else if (nscr == -2)
+                     Error("Init", "Run '%i' was not found in the database!", fRuns[i]);
                  else
                      Error("Init", "Number of scaler reads mismatch for run '%i' (database: '%i' vs. EventInfo histogram: '%i'!",
                            fRuns[i], nscr, (Int_t) h->GetBinContent(TCConfig::kNScREventHBin));
@@ -400,34 +463,23 @@ Bool_t TCCalibRunBadScR::Init()
             }
         }
 
-        // init helpers
-        Int_t nbadscr = 0;
-        Int_t* badscr = 0;
-
-        // get bad scaler reads from database
-        if (!TCMySQLManager::GetManager()->GetRunBadScR(fRuns[i], nbadscr, badscr, (*fCalibData).Data()))
-        {
-            Error("Init", "Could not read bad scaler read from database for run '%i'!", fRuns[i]);
-            fBadScROld[i] = new TCBadScRElement(fRuns[i], 0, 0, nscr);
-        }
-        else
-        {
-            // set up old bad scaler read element for this run
-            fBadScROld[i] = new TCBadScRElement(fRuns[i], nbadscr, badscr, nscr);
-        }
+        // set number of scaler reads of old bad scaler read element for this run
+        if (fBadScROld[i]->SetNScR(nscr) != nscr)
+            Error("Init", "Invalid number of scaler reads '%i' for run '%i' (run not found in the database?)!",
+                  nscr, fRuns[i]);
 
         // copy to new bad scaler read element for this run
-        if (fBadScROld[i]) fBadScRNew[i] = new TCBadScRElement(*fBadScROld[i]);
+        fBadScRNew[i] = new TCBadScRElement(*fBadScROld[i]);
 
         // set max scaler reads
-        if (fBadScRNew[i] && fBadScRNew[i]->GetNElem() > fRangeMax)
+        if (fBadScRNew[i]->GetNElem() > fRangeMax)
             fRangeMax = fBadScRNew[i]->GetNElem();
 
-        // clean up
-        if (badscr) delete [] badscr;
-
     }//end loop over runs
 
+    // clean up
+    delete [] nscr_db;
+
     // set max. range to number of scaler reads + 2
     fRangeMax += 2;
 
@@ -443,7 +495,7 @@ Bool_t TCCalibRunBadScR::Init()
             fEmptyProjHisto = (TH1D*) h->ProjectionX("EmptyProjHisto");
             fEmptyProjHisto->GetXaxis()->SetRange(1, fRangeMax);
             fEmptyProjHisto->Reset();
-            fEmptyProjNormHisto = (TH1D*) fProjHistos[i]->Clone("EmptyProjNormHisto");
+            fEmptyProjNormHisto = (TH1D*) fEmptyProjHisto->Clone("EmptyProjNormHisto");
             fEmptyProjNormHisto->GetXaxis()->SetRange(1, fRangeMax);
             fEmptyProjNormHisto->Reset();
             break;
@@ -495,6 +547,12 @@ Bool_t TCCalibRunBadScR::Init()
     fRunMarker->SetLineWidth(2);
     fRunMarker->SetLineColor(kRed);
 
+    // unload the histos of the runs outside the window (paging mode)
+    PageWindow();
+
+    // no canvases in headless mode
+    if (fIsHeadless) return kTRUE;
+
     // setup main canvas
     fCanvasMain = new TCanvas("Main", "Main", 0, 0, gClient->GetDisplayWidth(), gClient->GetDisplayHeight()/2.+50);
     fCanvasMain->Divide(1, 3, 0.001, 0.001);
@@ -516,6 +574,9 @@ Bool_t TCCalibRunBadScR::Init()
     fCanvasMain->Connect("ProcessedEvent(Int_t, Int_t, Int_t, TObject*)", "TCCalibRunBadScR", this,
                          "EventHandler(Int_t, Int_t, Int_t, TObject*)");
 
+    // start prefetching (paging mode)
+    StartPrefetch();
+
     return kTRUE;
 }
 
@@ -524,56 +585,127 @@ void TCCalibRunBadScR::NormalizeHisto(Int_t i)
 {
     // Normalizes the projection histo i
 
-    // check
-    if (!fProjHistos[i] || fProjNormHistos[i]) return;
+    NormalizeHistos(i, i);
+}
 
-    // clone histo
-    Char_t tmp[256];
-    sprintf(tmp, "%s_%s", fProjHistos[i]->GetName(), "_norm");
-    fProjNormHistos[i] = (TH1D*) fProjHistos[i]->Clone(tmp);
-    fProjNormHistos[i]->UseCurrentStyle();
+//______________________________________________________________________________
+void TCCalibRunBadScR::NormalizeHistos(Int_t first, Int_t last)
+{
+    // Normalizes the projection histos of the runs with the indices 'first' to
+    // 'last'. The hit and scaler counts of all runs are copied to contiguous
+    // arrays and normalized in one pass (see NormalizeScR()).
 
     // check whether scaler histos were loaded
-    if (!fScalerP2Histos && !(fScalerLiveHistos && fScalerFreeHistos)) return;
+    Bool_t isScaler = fScalerP2Histos || (fScalerLiveHistos && fScalerFreeHistos);
+
+    // get the array offsets of the runs to normalize
+    Int_t nrun = last - first + 1;
+    Int_t* off = new Int_t[nrun+1];
+    off[0] = 0;
+    for (Int_t i = first; i <= last; i++)
+    {
+        Int_t n = 0;
+
+        // check
+        if (fProjHistos[i] && !fProjNormHistos[i])
+        {
+            // clone histo
+            Char_t tmp[256];
+            sprintf(tmp, "%s_%s", fProjHistos[i]->GetName(), "_norm");
+            fProjNormHistos[i] = (TH1D*) fProjHistos[i]->Clone(tmp);
+            fProjNormHistos[i]->UseCurrentStyle();
+
+            // check for scaler histos
+            if (isScaler)
+            {
+                if ((fScalerP2Histos && !fScalerP2Histos[i])   ||
+                    (fScalerLiveHistos && !fScalerLiveHistos[i]) ||
+                    (fScalerFreeHistos && !fScalerFreeHistos[i]))
+                    Warning("NormalizeHisto", "No scaler histogram for run '%i'. Will not be normalized.", fRuns[i]);
+                else
+                    n = fProjHistos[i]->GetNbinsX();
+            }
+        }
 
-    // check for scaler histos
-    if ((fScalerP2Histos && !fScalerP2Histos[i] )   ||
-        (fScalerLiveHistos && !fScalerLiveHistos[i]) ||
-        (fScalerFreeHistos && !fScalerFreeHistos[i]))
+        off[i-first+1] = off[i-first] + n;
+    }
+
+    // check for something to normalize
+    Int_t ntot = off[nrun];
+    if (!ntot)
     {
-        Warning("NormalizeHisto", "No scaler histogram for run '%i'. Will not be normalized.", fRuns[i]);
+        delete [] off;
         return;
     }
 
-    // loop over scaler reads
-    for (Int_t j = 0; j < fProjNormHistos[i]->GetNbinsX(); j++)
+    // columnar arrays of all runs
+    Double_t* hits = new Double_t[ntot];
+    Double_t* sc_p2 = new Double_t[ntot];
+    Double_t* sc_live = new Double_t[ntot];
+    Double_t* sc_free = new Double_t[ntot];
+    Double_t* out = new Double_t[ntot];
+
+    // copy counts
+    for (Int_t i = first; i <= last; i++)
     {
-        // init scalers
-        Double_t p2 = 1.;
-        Double_t lt = 1.;
+        Int_t o = off[i-first];
+        Int_t n = off[i-first+1] - o;
+        if (!n) continue;
+
+        // hits
+        TCUtils::GetBinContents(fProjHistos[i], n, hits + o);
 
-        // get p2 scaler
-        if (fScalerP2Histos && fScalerP2Histos[i])
-            p2 = fScalerP2Histos[i]->GetBinContent(j+1);
+        // P2 scaler
+        if (fScalerP2Histos)
+            TCUtils::GetBinContents(fScalerP2Histos[i], n, sc_p2 + o);
+        else
+            for (Int_t j = 0; j < n; j++) sc_p2[o+j] = 1.;
 
-        // get livetime
-        if (fScalerLiveHistos && fScalerLiveHistos[i] &&
-            fScalerFreeHistos && fScalerFreeHistos[i])
+        // livetime scalers
+        if (fScalerLiveHistos && fScalerFreeHistos)
         {
-            if (fScalerFreeHistos[i]->GetBinContent(j+1) > 0.)
-                lt = fScalerLiveHistos[i]->GetBinContent(j+1) / fScalerFreeHistos[i]->GetBinContent(j+1);
-            else
-                lt = 0.;
+            TCUtils::GetBinContents(fScalerLiveHistos[i], n, sc_live + o);
+            TCUtils::GetBinContents(fScalerFreeHistos[i], n, sc_free + o);
+        }
+        else
+        {
+            for (Int_t j = 0; j < n; j++) sc_live[o+j] = sc_free[o+j] = 1.;
         }
+    }
 
-        // normalization factor
-        Double_t norm = p2 * lt;
+    // normalize all runs
+    NormalizeScR(ntot, hits, sc_p2, sc_live, sc_free, out);
 
-        // normalize histo
-        if (norm > 0.)
-            fProjNormHistos[i]->SetBinContent(j+1, fProjHistos[i]->GetBinContent(j+1) / norm);
-        else
-            fProjNormHistos[i]->SetBinContent(j+1, 0.);
+    // set normalized counts
+    for (Int_t i = first; i <= last; i++)
+    {
+        Int_t o = off[i-first];
+        Int_t n = off[i-first+1] - o;
+        if (n) TCUtils::SetBinContents(fProjNormHistos[i], n, out + o);
+    }
+
+    // clean up
+    delete [] off;
+    delete [] hits;
+    delete [] sc_p2;
+    delete [] sc_live;
+    delete [] sc_free;
+    delete [] out;
+}
+
+//______________________________________________________________________________
+void TCCalibRunBadScR::NormalizeScR(Int_t n, const Double_t* hits, const Double_t* sc_p2,
+                                    const Double_t* sc_live, const Double_t* sc_free, Double_t* out)
+{
+    // Normalization kernel: divides the 'n' hit counts 'hits' by the P2
+    // scaler counts 'sc_p2' times the livetime 'sc_live' / 'sc_free'. Values
+    // with a vanishing normalization are set to 0.
+
+    for (Int_t j = 0; j < n; j++)
+    {
+        Double_t lt = sc_free[j] > 0. ? sc_live[j] / sc_free[j] : 0.;
+        Double_t norm = sc_p2[j] * lt;
+        out[j] = norm > 0. ? hits[j] / norm : 0.;
     }
 }
 
@@ -589,8 +721,19 @@ void TCCalibRunBadScR::LoadScalerHistos(Int_t i)
 
     if (!fHistoLoader->GetFiles()[i]) return;
 
-    // get the histo
-    TH2* hsc = (TH2*) fHistoLoader->GetHistoForIndex(fScalerHistoName, i);
+    // take the prefetched key data
+    Char_t* keydata = 0;
+    if (fPageMutex)
+    {
+        fPageMutex->Lock();
+        keydata = fPageScaler[i];
+        fPageScaler[i] = 0;
+        fPageMutex->UnLock();
+    }
+
+    // get the histo (from the key data if available)
+    TH2* hsc = (TH2*) fHistoLoader->GetHistoForIndex(fScalerHistoName, i, 0, keydata);
+    if (keydata) delete [] keydata;
 
     if (!hsc)
     {
@@ -630,26 +773,268 @@ void TCCalibRunBadScR::LoadHistos(Int_t i)
 {
     // Loads and creates all histos for the index i
 
-    // get the histogram
+    // block file access of the prefetch thread
+    if (fIOMutex) fIOMutex->Lock();
+
+    // take the prefetched key data
+    Char_t* keydata = 0;
+    if (fPageMutex)
+    {
+        fPageMutex->Lock();
+        keydata = fPageMain[i];
+        fPageMain[i] = 0;
+        fPageDone[i] = kTRUE;
+        fPageMutex->UnLock();
+    }
+
+    // get the histogram (from the key data if available)
     if (!fMainHistos[i])
-        fMainHistos[i] = (TH2*) fHistoLoader->GetHistoForIndex(fMainHistoName, i);
+        fMainHistos[i] = (TH2*) fHistoLoader->GetHistoForIndex(fMainHistoName, i, 0, keydata);
+    if (keydata) delete [] keydata;
 
     // check
     if (!fMainHistos[i])
     {
         Error("LoadHistos", "Could not load main histogram named '%s' for index %d!", fMainHistoName, i);
-        return;
     }
+    else
+    {
+        // load scaler histo
+        LoadScalerHistos(i);
+
+        // load projection histograms
+        if (!fProjHistos[i])
+        {
+            fProjHistos[i] = (TH1*) fMainHistos[i]->ProjectionX(TString::Format("%s_px", fMainHistos[i]->GetName()));
+            fProjHistos[i]->SetDirectory(0);
+        }
 
-    // load scaler histo
-    LoadScalerHistos(i);
+        // create normalized histos
+        NormalizeHisto(i);
 
-    // load projection histograms
-    if (!fProjHistos[i])
-        fProjHistos[i] = (TH1*) fMainHistos[i]->ProjectionX("_px");
+        // fill the overview histo bin of this run (paging mode)
+        if (IsPaging() && fOverviewHisto && fBadScRNew && fBadScRNew[i])
+        {
+            Int_t index = fIndex;
+            TCBadScRElement* curr = fBadScRCurr;
+            fIndex = i;
+            fBadScRCurr = fBadScRNew[i];
+            UpdateOverviewHisto();
+            fIndex = index;
+            fBadScRCurr = curr;
+        }
+    }
 
-    // create normalized histos
-    NormalizeHisto(i);
+    // release file access
+    if (fIOMutex) fIOMutex->UnLock();
+}
+
+//______________________________________________________________________________
+void TCCalibRunBadScR::UnloadHistos(Int_t i)
+{
+    // Deletes all histos of the index i to free memory (paging mode). They
+    // can be reloaded via LoadHistos().
+
+    if (fMainHistos[i]) { delete fMainHistos[i]; fMainHistos[i] = 0; }
+    if (fProjHistos[i]) { delete fProjHistos[i]; fProjHistos[i] = 0; }
+    if (fProjNormHistos[i]) { delete fProjNormHistos[i]; fProjNormHistos[i] = 0; }
+    if (fScalerP2Histos && fScalerP2Histos[i]) { delete fScalerP2Histos[i]; fScalerP2Histos[i] = 0; }
+    if (fScalerLiveHistos && fScalerLiveHistos[i]) { delete fScalerLiveHistos[i]; fScalerLiveHistos[i] = 0; }
+    if (fScalerFreeHistos && fScalerFreeHistos[i]) { delete fScalerFreeHistos[i]; fScalerFreeHistos[i] = 0; }
+
+    // prefetched key data
+    if (fPageMutex)
+    {
+        fPageMutex->Lock();
+        if (fPageMain[i]) { delete [] fPageMain[i]; fPageMain[i] = 0; }
+        if (fPageScaler[i]) { delete [] fPageScaler[i]; fPageScaler[i] = 0; }
+        if (i != fPageLoading) fPageDone[i] = kFALSE;
+        fPageMutex->UnLock();
+    }
+}
+
+//______________________________________________________________________________
+void TCCalibRunBadScR::PageWindow()
+{
+    // Unloads the histos of all runs outside the window of 'fCacheSize' runs
+    // before and 'fPrefetch' runs after the current run and moves the
+    // prefetch window to the current run (paging mode).
+
+    // check paging mode
+    if (!IsPaging()) return;
+
+    // move prefetch window
+    if (fPageMutex)
+    {
+        fPageMutex->Lock();
+        fPageIndex = fIndex;
+        fPageMutex->UnLock();
+    }
+
+    // unload runs outside the window
+    for (Int_t i = 0; i < fNRuns; i++)
+        if (!IsInPage(i)) UnloadHistos(i);
+}
+
+//______________________________________________________________________________
+void* TCCalibRunBadScR::PrefetchThread(void* arg)
+{
+    // Prefetch thread: reads the key data of the main and scaler histos of
+    // the runs around the current run (next runs first) from the files. No
+    // ROOT object is created here, the histos are created from the key data
+    // by LoadHistos() and LoadScalerHistos() in the main thread.
+
+    TCCalibRunBadScR* c = (TCCalibRunBadScR*) arg;
+
+    for (;;)
+    {
+        // find next run to load
+        Int_t run = -1;
+        c->fPageMutex->Lock();
+        if (c->fPrefetchStop)
+        {
+            c->fPageMutex->UnLock();
+            break;
+        }
+        for (Int_t d = 1; d <= c->fPrefetch && run < 0; d++)
+        {
+            Int_t next = c->fPageIndex + d;
+            if (next < c->fNRuns && !c->fPageDone[next]) run = next;
+        }
+        for (Int_t d = 1; d <= c->fCacheSize && run < 0; d++)
+        {
+            Int_t prev = c->fPageIndex - d;
+            if (prev >= 0 && !c->fPageDone[prev]) run = prev;
+        }
+        if (run >= 0)
+        {
+            c->fPageDone[run] = kTRUE;
+            c->fPageLoading = run;
+        }
+        c->fPageMutex->UnLock();
+
+        // wait if there is nothing to do
+        if (run < 0)
+        {
+            gSystem->Sleep(20);
+            continue;
+        }
+
+        // read the key data of the histos
+        Char_t* h = 0;
+        Char_t* hsc = 0;
+        if (TFile* f = c->fHistoLoader->GetFiles()[run])
+        {
+            c->fIOMutex->Lock();
+            h = TCARHistoLoader::ReadKey(f, c->fMainHistoName);
+            if (c->fScalerHistoName && (c->fScalerP2Histos || c->fScalerLiveHistos))
+                hsc = TCARHistoLoader::ReadKey(f, c->fScalerHistoName);
+            c->fIOMutex->UnLock();
+        }
+
+        // hand over to main thread
+        c->fPageMutex->Lock();
+        c->fPageMain[run] = h;
+        c->fPageScaler[run] = hsc;
+        c->fPageLoading = -1;
+        c->fPageMutex->UnLock();
+    }
+
+    return 0;
+}
+
+//______________________________________________________________________________
+void TCCalibRunBadScR::StartPrefetch()
+{
+    // Starts the prefetch thread (paging mode).
+
+    // check paging mode
+    if (!IsPaging() || fPrefetchThread) return;
+
+    // init members
+    fPageMain = new Char_t*[fNRuns];
+    fPageScaler = new Char_t*[fNRuns];
+    fPageDone = new Bool_t[fNRuns];
+    for (Int_t i = 0; i < fNRuns; i++)
+    {
+        fPageMain[i] = 0;
+        fPageScaler[i] = 0;
+        fPageDone[i] = fMainHistos[i] ? kTRUE : kFALSE;
+    }
+    fPageIndex = fIndex;
+    fPageLoading = -1;
+    fPrefetchStop = kFALSE;
+
+    // start thread
+    TThread::Initialize();
+    fPageMutex = new TMutex(kTRUE);
+    fIOMutex = new TMutex(kTRUE);
+    fPrefetchThread = new TThread(TString::Format("%s_Prefetch", GetName()).Data(),
+                                  TCCalibRunBadScR::PrefetchThread, this);
+    fPrefetchThread->Run();
+}
+
+//______________________________________________________________________________
+void TCCalibRunBadScR::StopPrefetch()
+{
+    // Stops the prefetch thread and deletes all prefetched key data.
+
+    // check for thread
+    if (!fPrefetchThread) return;
+
+    // stop thread
+    fPageMutex->Lock();
+    fPrefetchStop = kTRUE;
+    fPageMutex->UnLock();
+    fPrefetchThread->Join();
+    delete fPrefetchThread;
+    fPrefetchThread = 0;
+
+    // clean up
+    for (Int_t i = 0; i < fNRuns; i++)
+    {
+        if (fPageMain[i]) delete [] fPageMain[i];
+        if (fPageScaler[i]) delete [] fPageScaler[i];
+    }
+    delete [] fPageMain;
+    delete [] fPageScaler;
+    delete [] fPageDone;
+    delete fPageMutex;
+    delete fIOMutex;
+    fPageMain = 0;
+    fPageScaler = 0;
+    fPageDone = 0;
+    fPageMutex = 0;
+    fIOMutex = 0;
+}
+
+//______________________________________________________________________________
+Bool_t TCCalibRunBadScR::PrepareRun(Int_t index)
+{
+    // Creates the histos of the run with index 'index' from the key data
+    // read by the prefetch thread, so that the run is displayed without
+    // delay (paging mode). This is called in the main thread while the GUI
+    // is idle. Returns kTRUE if the run was prepared.
+
+    // check paging mode
+    if (!fPageMutex || fMainHistos[index]) return kFALSE;
+
+    // check for the prefetched key data
+    fPageMutex->Lock();
+    Bool_t ready = fPageMain[index] ? kTRUE : kFALSE;
+    fPageMutex->UnLock();
+    if (!ready) return kFALSE;
+
+    // do not wait for the file access of the prefetch thread
+    if (fIOMutex->TryLock()) return kFALSE;
+
+    // create the histos
+    LoadHistos(index);
+
+    // release file access
+    fIOMutex->UnLock();
+
+    return kTRUE;
 }
 
 //______________________________________________________________________________
@@ -657,6 +1042,9 @@ void TCCalibRunBadScR::PrepareCurr()
 {
     // Prepares everything to process the current run
 
+    // unload runs outside the window and move the prefetch window
+    PageWindow();
+
     // update run marker
     fRunMarker->SetX1(fIndex+0.5);
     fRunMarker->SetX2(fIndex+0.5);
@@ -715,6 +1103,8 @@ void TCCalibRunBadScR::ProcessCurr()
     // default calibration
     if (strcmp(fCalibMethod, "default") == 0)
         CalibMethodDefault();
+    else if (GetDetectMethod(fCalibMethod) != kDetectUnknown)
+        CalibMethodData(GetDetectMethod(fCalibMethod));
 
     // update overview histo
     UpdateOverviewHisto();
@@ -725,6 +1115,9 @@ void TCCalibRunBadScR::UpdateCanvas()
 {
     // Updates all canvases.
 
+    // check for canvases
+    if (!fCanvasMain) return;
+
     // main canvas top
     if (IsGood())
     {
@@ -922,8 +1315,8 @@ void TCCalibRunBadScR::CleanUpCurr()
     // update overview histo
     UpdateOverviewHisto();
 
-    // clear main histo
-    if (!fLoadHistosInAdvance)
+    // clear main histo (kept in paging mode)
+    if (!fLoadHistosInAdvance && !IsPaging())
     {
        if (fMainHistos[fIndex]) delete fMainHistos[fIndex];
        fMainHistos[fIndex] = 0;
@@ -990,43 +1383,38 @@ Bool_t TCCalibRunBadScR::Write()
     // security check
     if (!fBadScRNew) return kFALSE;
 
-    // init error counter
-    Int_t errors = 0;
-
-    // init run counter
+    // collect modified runs
+    TCBadScRElement** modified = new TCBadScRElement*[fNRuns];
     Int_t nruns = 0;
-
-    // loop over runs
     for (Int_t i = 0; i < fNRuns; i++)
     {
-        // check for existing bad scaler reads
-        if (fBadScRNew[i])
-        {
-            // increment counter
-            nruns++;
-
-            // write bad scaler reads for run with index 'i'
-            if (!TCMySQLManager::GetManager()->ChangeRunBadScR(fBadScRNew[i]->GetRunNumber(), fBadScRNew[i]->GetNBad(), fBadScRNew[i]->GetBad(), (*fCalibData).Data()))
-            {
-                // an error occurred
-                Error("Write", "Could not write bad scaler reads for run '%i' to the database!", fRuns[i]);
-                errors++;
-            }
-        }
-        else
-        {
-        }
+        if (fBadScRNew[i] && (!fBadScROld[i] || !fBadScRNew[i]->IsEqual(*fBadScROld[i])))
+            modified[nruns++] = fBadScRNew[i];
     }
 
+    // write bad scaler reads of all modified runs in one transaction
+    Bool_t ok = TCMySQLManager::GetManager()->WriteRunsBadScR(nruns, modified, (*fCalibData).Data());
+
+    // clean up
+    delete [] modified;
+
     // print user info
-    if (errors)
+    if (!ok)
     {
-        Error("Write", "%i error(s) while writing to the database occurred", errors);
+        Error("Write", "Could not write bad scaler reads of %i modified runs to the database!", nruns);
         return kFALSE;
     }
     else
     {
-        Info("Write", "Successfully written bad scaler reads of %i runs.", nruns);
+        Info("Write", "Successfully written bad scaler reads of %i modified runs.", nruns);
+
+        // written values are the new reference
+        for (Int_t i = 0; i < fNRuns; i++)
+        {
+            if (!fBadScRNew[i]) continue;
+            if (fBadScROld[i]) delete fBadScROld[i];
+            fBadScROld[i] = new TCBadScRElement(*fBadScRNew[i]);
+        }
     }
 
     return kTRUE;
@@ -1204,46 +1592,156 @@ void TCCalibRunBadScR::CalibMethodDefault()
 {
     // Rejects iteratively all scaler read intervals for which the
     // projection of the main histogram differs more than 10% form the mean
-    // value of good scaler reads.
+    // value of good scaler reads (see DetectDefault()).
+
+    CalibMethodData(kDetectDefault);
+}
+
+//______________________________________________________________________________
+void TCCalibRunBadScR::CalibMethodData(Int_t method)
+{
+    // Applies the automatic calibration method 'method' to the data of the
+    // current run and marks the rejected scaler reads.
+
+    // get data histogram
+    TH1* h = GetDetectHisto(fIndex, method);
+    if (!h) return;
+
+    // get number of scaler reads
+    Int_t n = fBadScRCurr->GetNElem();
+    if (n > h->GetNbinsX()) n = h->GetNbinsX();
+    if (n <= 0) return;
+
+    // copy data and current bad scaler reads
+    Double_t* y = new Double_t[n];
+    Bool_t* bad = new Bool_t[n];
+    for (Int_t i = 0; i < n; i++)
+    {
+        y[i] = h->GetBinContent(i+1);
+        bad[i] = fBadScRCurr->IsBad(i);
+    }
+
+    // detect and mark new bad scaler reads
+    if (Detect(method, n, y, bad))
+    {
+        for (Int_t i = 0; i < n; i++)
+            if (bad[i] && !fBadScRCurr->IsBad(i)) SetBadScalerRead(i);
+    }
+
+    // clean up
+    delete [] y;
+    delete [] bad;
+}
+
+//______________________________________________________________________________
+TH1* TCCalibRunBadScR::GetDetectHisto(Int_t i, Int_t method)
+{
+    // Returns the histogram used by the automatic calibration method 'method'
+    // for the run with index 'i': the projection of the main histogram for
+    // the default method and the normalized projection (if available) for the
+    // other methods.
+
+    // load histos (paging mode)
+    if (IsPaging() && !fProjHistos[i] && fHistoLoader->GetFiles()[i]) LoadHistos(i);
+
+    // default method
+    if (method == kDetectDefault) return fProjHistos[i];
+
+    // load scaler histos and normalize if not done yet
+    if (!fLoadHistosInAdvance && fProjHistos[i] && !fProjNormHistos[i])
+    {
+        if (fScalerP2Histos || fScalerLiveHistos) LoadScalerHistos(i);
+        NormalizeHisto(i);
+    }
+
+    return fProjNormHistos[i] ? fProjNormHistos[i] : fProjHistos[i];
+}
+
+//______________________________________________________________________________
+Int_t TCCalibRunBadScR::Detect(Int_t method, Int_t n, const Double_t* y, Bool_t* bad) const
+{
+    // Applies the automatic calibration method 'method' with the configured
+    // parameters to the 'n' values 'y'. Rejected scaler reads are set in
+    // 'bad'. Returns the number of newly rejected scaler reads.
+    // NOTE: Thread-safe, does not access any histograms.
+
+    switch (method)
+    {
+        case kDetectDefault:
+            return DetectDefault(n, y, bad, fDetectTolerance);
+        case kDetectMedianMAD:
+            return DetectMedianMAD(n, y, bad, fDetectNSigma);
+        case kDetectChangepoint:
+            return DetectChangepoint(n, y, bad, fDetectWindow, fDetectNSigma, fDetectTolerance);
+        default:
+            return 0;
+    }
+}
+
+//______________________________________________________________________________
+Int_t TCCalibRunBadScR::GetDetectMethod(const Char_t* name)
+{
+    // Returns the automatic calibration method for the name 'name' ('default',
+    // 'median' or 'changepoint') or kDetectUnknown.
+
+    if (!name) return kDetectUnknown;
+    if (!strcmp(name, "default")) return kDetectDefault;
+    if (!strcmp(name, "median")) return kDetectMedianMAD;
+    if (!strcmp(name, "changepoint")) return kDetectChangepoint;
+
+    return kDetectUnknown;
+}
+
+//______________________________________________________________________________
+Int_t TCCalibRunBadScR::DetectDefault(Int_t n, const Double_t* y, Bool_t* bad, Double_t tol)
+{
+    // Rejects empty scaler reads and, iteratively, the scaler read with the
+    // largest deviation from the mean value of the good scaler reads as long
+    // as it deviates more than 'tol' (relative) from the mean. Scaler reads
+    // with less than 1% of the mean are rejected beforehand.
+    // The 'n' values are taken from 'y', rejected scaler reads are set in
+    // 'bad'. Returns the number of newly rejected scaler reads.
+
+    Int_t nnew = 0;
 
     // calculate mean value of good scaler reads
     Double_t mean = 0.;
-    for (Int_t i = 0; i < fBadScRCurr->GetNElem(); i++)
+    Int_t ngood = 0;
+    for (Int_t i = 0; i < n; i++)
     {
-        if (fBadScRCurr->IsBad(i)) continue;
+        if (bad[i]) continue;
 
-        // check for empty bin
-        if (fProjHistos[fIndex]->GetBinContent(i+1) == 0.)
+        // reject empty bins
+        if (y[i] == 0.)
         {
-            // reject empty bins
-            SetBadScalerRead(i);
+            bad[i] = kTRUE;
+            nnew++;
             continue;
         }
 
         // add up values for good scr
-        mean += fProjHistos[fIndex]->GetBinContent(i+1);
+        mean += y[i];
+        ngood++;
     }
 
-    // number of scaler reads
-    Int_t ngood = fBadScRCurr->GetNElem() - fBadScRCurr->GetNBad();
+    // check number of good scaler reads
+    if (ngood <= 0) return nnew;
 
     // calc mean
     mean /= ngood;
 
-    for (Int_t i = 0; i < fBadScRCurr->GetNElem(); i++)
+    // reject small entries
+    for (Int_t i = 0; i < n; i++)
     {
-        if (fBadScRCurr->IsBad(i)) continue;
+        if (bad[i]) continue;
 
-        // check for small entry
-        if (fProjHistos[fIndex]->GetBinContent(i+1) < mean/100.)
+        if (y[i] < mean/100.)
         {
-            // reject small bin
-            SetBadScalerRead(i);
+            bad[i] = kTRUE;
+            nnew++;
 
             // update mean
-            mean = (mean*ngood - fProjHistos[fIndex]->GetBinContent(i+1))/(ngood-1);
-
-            // decrement no. of good scaler reads
+            mean = ngood > 1 ? (mean*ngood - y[i])/(ngood-1) : 0.;
             ngood--;
         }
     }
@@ -1251,46 +1749,449 @@ void TCCalibRunBadScR::CalibMethodDefault()
     // iterate
     while (ngood > 0)
     {
-        // init scaler read
+        // look for highest deviation from mean value
         Int_t scr = -1;
-
-        // init maximal difference to mean value
         Double_t maxdiff = 0;
-
-        // loop over scaler reads
-        for (Int_t i = 0; i < fBadScRCurr->GetNElem(); i++)
+        for (Int_t i = 0; i < n; i++)
         {
-            // continue if already bad
-            if (fBadScRCurr->IsBad(i)) continue;
-
-            // calc deviation
-            Double_t diff = TMath::Abs(mean - fProjHistos[fIndex]->GetBinContent(i+1));
+            if (bad[i]) continue;
 
-            // look for higher deviation from mean value
+            Double_t diff = TMath::Abs(mean - y[i]);
             if (diff > maxdiff)
             {
-                // update
                 scr = i;
                 maxdiff = diff;
             }
         }
 
-        // check for success
+        // check for success and tolerance
         if (scr == -1) break;
-
-        // check tolerance
-        if (maxdiff < mean * 0.1) break;
+        if (maxdiff < mean * tol) break;
 
         // set bad scaler read
-        SetBadScalerRead(scr);
+        bad[scr] = kTRUE;
+        nnew++;
 
         // update mean
-        mean = (mean*ngood - fProjHistos[fIndex]->GetBinContent(scr+1))/(ngood-1);
-
-        // decrement no. of good scaler reads
+        mean = ngood > 1 ? (mean*ngood - y[scr])/(ngood-1) : 0.;
         ngood--;
+    }
+
+    return nnew;
+}
+
+//______________________________________________________________________________
+Int_t TCCalibRunBadScR::DetectMedianMAD(Int_t n, const Double_t* y, Bool_t* bad, Double_t nsigma)
+{
+    // Rejects empty scaler reads and all scaler reads deviating more than
+    // 'nsigma' robust standard deviations (1.4826 times the median absolute
+    // deviation) from the median of the good scaler reads.
+    // The 'n' values are taken from 'y', rejected scaler reads are set in
+    // 'bad'. Returns the number of newly rejected scaler reads.
+
+    Int_t nnew = 0;
+
+    // collect good values and reject empty bins
+    Double_t* v = new Double_t[n > 0 ? n : 1];
+    Int_t ngood = 0;
+    for (Int_t i = 0; i < n; i++)
+    {
+        if (bad[i]) continue;
+        if (y[i] == 0.)
+        {
+            bad[i] = kTRUE;
+            nnew++;
+            continue;
+        }
+        v[ngood++] = y[i];
+    }
+
+    // calculate median and robust standard deviation
+    Double_t sigma = 0;
+    Double_t median = 0;
+    if (ngood > 2)
+    {
+        median = TMath::Median(ngood, v);
+        for (Int_t i = 0; i < ngood; i++) v[i] = TMath::Abs(v[i] - median);
+        sigma = 1.4826 * TMath::Median(ngood, v);
+    }
+
+    // reject outliers
+    if (sigma > 0)
+    {
+        for (Int_t i = 0; i < n; i++)
+        {
+            if (bad[i]) continue;
+            if (TMath::Abs(y[i] - median) > nsigma*sigma)
+            {
+                bad[i] = kTRUE;
+                nnew++;
+            }
+        }
+    }
+
+    // clean up
+    delete [] v;
+
+    return nnew;
+}
+
+//______________________________________________________________________________
+Int_t TCCalibRunBadScR::DetectChangepoint(Int_t n, const Double_t* y, Bool_t* bad,
+                                          Int_t win, Double_t nsigma, Double_t tol)
+{
+    // Rejects empty scaler reads and splits the good scaler reads into
+    // segments at changepoints, i.e., at the positions where the means of the
+    // 'win' preceding and the 'win' following good scaler reads differ by more
+    // than 'nsigma' standard errors. All segments whose mean deviates more than
+    // 'tol' (relative) from the mean of the longest segment are rejected.
+    // The 'n' values are taken from 'y', rejected scaler reads are set in
+    // 'bad'. Returns the number of newly rejected scaler reads.
+
+    Int_t nnew = 0;
+
+    // collect indices of good scaler reads and reject empty bins
+    Int_t* idx = new Int_t[n > 0 ? n : 1];
+    Int_t ngood = 0;
+    for (Int_t i = 0; i < n; i++)
+    {
+        if (bad[i]) continue;
+        if (y[i] == 0.)
+        {
+            bad[i] = kTRUE;
+            nnew++;
+            continue;
+        }
+        idx[ngood++] = i;
+    }
+
+    // check number of good scaler reads
+    if (win < 2 || ngood < 2*win)
+    {
+        delete [] idx;
+        return nnew;
+    }
+
+    // prefix sums of the good values and their squares
+    Double_t* sum = new Double_t[ngood+1];
+    Double_t* sum2 = new Double_t[ngood+1];
+    sum[0] = sum2[0] = 0;
+    for (Int_t i = 0; i < ngood; i++)
+    {
+        Double_t v = y[idx[i]];
+        sum[i+1] = sum[i] + v;
+        sum2[i+1] = sum2[i] + v*v;
+    }
+
+    // find changepoints (segment start positions in units of good reads)
+    Int_t* seg = new Int_t[ngood/win + 2];
+    Int_t nseg = 0;
+    seg[nseg++] = 0;
+    Int_t best = -1;
+    Double_t bestT = 0;
+    for (Int_t k = win; k <= ngood - win; k++)
+    {
+        // means and variances of the left and right windows
+        Double_t mL = (sum[k] - sum[k-win]) / win;
+        Double_t mR = (sum[k+win] - sum[k]) / win;
+        Double_t vL = (sum2[k] - sum2[k-win] - win*mL*mL) / (win-1);
+        Double_t vR = (sum2[k+win] - sum2[k] - win*mR*mR) / (win-1);
+        Double_t se = TMath::Sqrt(TMath::Max(vL + vR, 0.) / win);
+
+        // test statistic
+        Double_t t;
+        if (se > 0) t = TMath::Abs(mL - mR) / se;
+        else t = mL != mR ? 1e30 : 0;
+
+        // keep the maximum of a significant region
+        if (t > nsigma)
+        {
+            if (t > bestT)
+            {
+                best = k;
+                bestT = t;
+            }
+        }
+        else if (best >= 0)
+        {
+            // end of significant region: accept changepoint
+            if (best - seg[nseg-1] >= win) seg[nseg++] = best;
+            best = -1;
+            bestT = 0;
+        }
+    }
+    if (best >= 0 && best - seg[nseg-1] >= win) seg[nseg++] = best;
+    seg[nseg] = ngood;
+
+    // find longest segment as reference
+    Int_t ref = 0;
+    for (Int_t i = 1; i < nseg; i++)
+        if (seg[i+1] - seg[i] > seg[ref+1] - seg[ref]) ref = i;
+    Double_t mRef = (sum[seg[ref+1]] - sum[seg[ref]]) / (seg[ref+1] - seg[ref]);
+
+    // reject deviating segments
+    for (Int_t i = 0; i < nseg; i++)
+    {
+        Double_t m = (sum[seg[i+1]] - sum[seg[i]]) / (seg[i+1] - seg[i]);
+        if (TMath::Abs(m - mRef) > tol*TMath::Abs(mRef))
+        {
+            for (Int_t j = seg[i]; j < seg[i+1]; j++)
+            {
+                bad[idx[j]] = kTRUE;
+                nnew++;
+            }
+        }
+    }
+
+    // clean up
+    delete [] idx;
+    delete [] sum;
+    delete [] sum2;
+    delete [] seg;
+
+    return nnew;
+}
+
+// task of TCCalibRunBadScR::DetectParallel()
+struct BadScRDetectTask
+{
+    const TCCalibRunBadScR* module;     // calibration module
+    Int_t method;                       // automatic calibration method
+    Int_t* n;                           // number of scaler reads per run
+    Double_t** y;                       // data per run
+    Bool_t** bad;                       // bad scaler read flags per run
+};
+
+//______________________________________________________________________________
+static void DetectBadScR(Int_t i, void* arg)
+{
+    // Applies the automatic calibration method to the run with index 'i' of
+    // the task 'arg' (worker function of TCCalibRunBadScR::DetectParallel()).
+
+    BadScRDetectTask* task = (BadScRDetectTask*) arg;
+    if (task->n[i] > 0)
+        task->module->Detect(task->method, task->n[i], task->y[i], task->bad[i]);
+}
+
+//______________________________________________________________________________
+Bool_t TCCalibRunBadScR::DetectSequential()
+{
+    // Applies the default calibration method of this class to all runs one
+    // after the other. Used for classes with a histogram-based default method.
+
+    for (Int_t i = 0; i < fNRuns; i++)
+    {
+        fIndex = i;
+        PrepareCurr();
+        if (IsGood())
+        {
+            CalibMethodDefault();
+            SaveValCurr();
+        }
+        CleanUpCurr();
+    }
+    fIndex = 0;
 
-    } // iterate
+    return kTRUE;
+}
+
+//______________________________________________________________________________
+Bool_t TCCalibRunBadScR::DetectParallel(Int_t method)
+{
+    // Applies the automatic calibration method 'method' to all runs using
+    // multiple threads (see TCUtils::ParallelFor()).
+
+    // init task
+    BadScRDetectTask task;
+    task.module = this;
+    task.method = method;
+    task.n = new Int_t[fNRuns];
+    task.y = new Double_t*[fNRuns];
+    task.bad = new Bool_t*[fNRuns];
+
+    // copy data of all runs (histogram access is not thread-safe)
+    for (Int_t i = 0; i < fNRuns; i++)
+    {
+        task.n[i] = 0;
+        task.y[i] = 0;
+        task.bad[i] = 0;
+
+        // get data histogram and number of scaler reads
+        TH1* h = fBadScRNew[i] ? GetDetectHisto(i, method) : 0;
+        if (!h) continue;
+        Int_t n = fBadScRNew[i]->GetNElem();
+        if (n > h->GetNbinsX()) n = h->GetNbinsX();
+        if (n <= 0) continue;
+
+        // copy
+        task.n[i] = n;
+        task.y[i] = new Double_t[n];
+        task.bad[i] = new Bool_t[n];
+        for (Int_t j = 0; j < n; j++)
+        {
+            task.y[i][j] = h->GetBinContent(j+1);
+            task.bad[i][j] = fBadScRNew[i]->IsBad(j);
+        }
+
+        // unload histos outside the window (paging mode)
+        if (IsPaging() && !IsInPage(i)) UnloadHistos(i);
+    }
+
+    // detect
+    TCUtils::ParallelFor(fNRuns, DetectBadScR, &task);
+
+    // set new bad scaler reads
+    for (Int_t i = 0; i < fNRuns; i++)
+    {
+        if (task.n[i] > 0)
+        {
+            Int_t nbad = 0;
+            Int_t* bad = new Int_t[task.n[i]];
+            for (Int_t j = 0; j < task.n[i]; j++)
+                if (task.bad[i][j]) bad[nbad++] = j;
+            fBadScRNew[i]->AddBad(nbad, bad);
+            delete [] bad;
+
+            // update overview histo
+            fIndex = i;
+            fBadScRCurr = fBadScRNew[i];
+            UpdateOverviewHisto();
+            fIndex = 0;
+            fBadScRCurr = 0;
+        }
+
+        // clean up
+        if (task.y[i]) delete [] task.y[i];
+        if (task.bad[i]) delete [] task.bad[i];
+    }
+
+    // clean up
+    delete [] task.n;
+    delete [] task.y;
+    delete [] task.bad;
+
+    return kTRUE;
+}
+
+//______________________________________________________________________________
+Bool_t TCCalibRunBadScR::DetectAll(const Char_t* method, const Char_t* report)
+{
+    // Applies the automatic calibration method 'method' ('default', 'median' or
+    // 'changepoint', the configured method if 0) to all runs without user
+    // interaction and, if 'report' is not 0, writes a report of the changes
+    // to the file 'report'. The results are not written to the database, use
+    // Write() afterwards.
+    // The methods are applied in parallel except for the histogram-based
+    // default methods of derived classes.
+
+    // check if calibration was started
+    if (!fIsStarted)
+    {
+        Error("DetectAll", "Not yet started!");
+        return kFALSE;
+    }
+
+    // get method
+    if (!method) method = fCalibMethod;
+    Int_t m = GetDetectMethod(method);
+    if (m == kDetectUnknown)
+    {
+        Error("DetectAll", "Unknown calibration method '%s'!", method ? method : "");
+        return kFALSE;
+    }
+
+    // user info
+    Info("DetectAll", "Detecting bad scaler reads of %d runs using method '%s'...", fNRuns, method);
+
+    // save and clean up current run
+    Int_t index = fIndex;
+    if (fBadScRCurr)
+    {
+        SaveValCurr();
+        CleanUpCurr();
+    }
+
+    // detect
+    Bool_t ok;
+    if (m == kDetectDefault && !IsDefaultGeneric()) ok = DetectSequential();
+    else ok = DetectParallel(m);
+
+    // show current run again
+    if (!fIsHeadless) Process(index);
+
+    // write report
+    if (ok && report) ok = WriteDetectReport(report, method);
+
+    return ok;
+}
+
+//______________________________________________________________________________
+Bool_t TCCalibRunBadScR::WriteDetectReport(const Char_t* report, const Char_t* method) const
+{
+    // Writes the bad scaler reads that were added to or removed from the
+    // database values of all runs to the file 'report'.
+
+    // open the file
+    FILE* fout = fopen(report, "w");
+    if (!fout)
+    {
+        Error("WriteDetectReport", "Could not open report file '%s'!", report);
+        return kFALSE;
+    }
+
+    // header
+    fprintf(fout, "# Bad scaler read detection report\n");
+    fprintf(fout, "# Calibration    : %s\n", fCalibration ? fCalibration->Data() : "");
+    fprintf(fout, "# Data           : %s\n", fCalibData->Data());
+    fprintf(fout, "# Method         : %s\n", method);
+    fprintf(fout, "#\n");
+    fprintf(fout, "#   run   n_scr   n_bad_old   n_bad_new   changes\n");
+
+    // loop over runs
+    Int_t nchanged = 0;
+    for (Int_t i = 0; i < fNRuns; i++)
+    {
+        const TCBadScRElement* o = fBadScROld[i];
+        const TCBadScRElement* n = fBadScRNew[i];
+        if (!n) continue;
+
+        fprintf(fout, "%7d %7d %11d %11d   ", fRuns[i], n->GetNElem(), o ? o->GetNBad() : 0, n->GetNBad());
+
+        // write added (+) and removed (-) intervals
+        Int_t nscr = TMath::Max(n->GetNElem(), o ? o->GetNElem() : 0);
+        Bool_t first = kTRUE;
+        for (Int_t j = 0; j < nscr; j++)
+        {
+            Bool_t b_new = n->IsBad(j);
+            Bool_t b_old = o ? o->IsBad(j) : kFALSE;
+            if (b_new == b_old) continue;
+
+            // find end of interval
+            Int_t k = j;
+            while (k+1 < nscr && n->IsBad(k+1) == b_new && (o ? o->IsBad(k+1) : kFALSE) == b_old) k++;
+
+            // write interval
+            if (k == j) fprintf(fout, "%s%c%d", first ? "" : ",", b_new ? '+' : '-', j);
+            else fprintf(fout, "%s%c%d-%d", first ? "" : ",", b_new ? '+' : '-', j, k);
+            first = kFALSE;
+            j = k;
+        }
+        fprintf(fout, "\n");
+
+        if (!first) nchanged++;
+    }
+
+    // summary
+    fprintf(fout, "#\n");
+    fprintf(fout, "# %d of %d runs changed\n", nchanged, fNRuns);
+
+    // close the file
+    fclose(fout);
+
+    // user info
+    Info("WriteDetectReport", "Report written to '%s' (%d of %d runs changed)", report, nchanged, fNRuns);
+
+    return kTRUE;
 }
 
 // finito
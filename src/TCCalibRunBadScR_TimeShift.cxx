@@ -14,10 +14,11 @@
 //////////////////////////////////////////////////////////////////////////
 
 
+#include <cfloat>
+
 #include "TCCalibRunBadScR_TimeShift.h"
+#include "TCUtils.h"
 #include "TMath.h"
-#include "TGraph.h"
-#include "TF1.h"
 #include "TH1.h"
 #include "TH2.h"
 #include "TCBadScRElement.h"
@@ -28,103 +29,105 @@ ClassImp(TCCalibRunBadScR_TimeShift)
 void TCCalibRunBadScR_TimeShift::CalibMethodDefault()
 {
     // Look for a sudden shift of the time peak, and sets bad scaler reads.
+    // The time projections of the scaler reads are not created: the peak
+    // position and the prefix sums of the integrals of all scaler reads are
+    // calculated in one pass over the bin contents of the main histogram.
 
     // allowed time shift tolerance [in ns]
     const Double_t tolerance = 5;
 
-    // init helpers
-    TGraph* g_peak_pos = new TGraph();
-    Bool_t isbad = kFALSE;
+    // get main histo and its binning
+    TH2* h = fMainHistos[fIndex];
+    Int_t nx = h->GetNbinsX();
+    Int_t ny = h->GetNbinsY();
+    Int_t yfirst = h->GetYaxis()->GetFirst();
+    Int_t ylast = h->GetYaxis()->GetLast();
+
+    // get bin contents
+    Double_t* cells = new Double_t[(nx+2)*(ny+2)];
+    TCUtils::GetCellContents(h, cells);
+
+    // init time peak bin and integral of each scaler read (x-bin)
+    Int_t* peak_bin = new Int_t[nx+2];
+    Double_t* peak_max = new Double_t[nx+2];
+    Double_t* integral = new Double_t[nx+2];
+    for (Int_t x = 0; x < nx+2; x++)
+    {
+        peak_bin[x] = yfirst;
+        peak_max[x] = -DBL_MAX;
+        integral[x] = 0;
+    }
 
-    /* do not fit: is very slow and error-prone
-    // get y-axis range
-    Double_t y_min = fMainHistos[fIndex]->GetYaxis()->GetBinLowEdge(fMainHistos[fIndex]->GetYaxis()->GetFirst());
-    Double_t y_max = fMainHistos[fIndex]->GetYaxis()->GetBinUpEdge(fMainHistos[fIndex]->GetYaxis()->GetLast());
+    // loop over time bins (rows of the contiguous storage)
+    for (Int_t y = yfirst; y <= ylast; y++)
+    {
+        const Double_t* row = cells + y*(nx+2);
+        for (Int_t x = 0; x < nx+2; x++)
+        {
+            integral[x] += row[x];
+            if (row[x] > peak_max[x])
+            {
+                peak_max[x] = row[x];
+                peak_bin[x] = y;
+            }
+        }
+    }
 
-    // fit function
-    TF1 f("f", "[0] + gaus(1)", y_min, y_max);
-    */
+    // prefix sums of the integrals: sum[x] = integral of x-bins 0 to x-1
+    Double_t* sum = new Double_t[nx+3];
+    sum[0] = 0;
+    for (Int_t x = 0; x < nx+2; x++) sum[x+1] = sum[x] + integral[x];
+
+    // init helpers
+    Bool_t isbad = kFALSE;
+    Double_t last_peak = 0;
 
     // loop over all scaler reads
     for (Int_t i = 0; i < fBadScRCurr->GetNElem(); i++)
     {
-        // get time projection
-        TH1* p = fMainHistos[fIndex]->ProjectionY("_px", i+1, i+1);
+        // x-bin of this scaler read
+        Int_t x = TMath::Min(i+1, nx+1);
 
         // process last scr
         if (i == fBadScRCurr->GetNElem() - 1 && i >= 1)
         {
-            // get time projection of last scr
-            TH1* l = fMainHistos[fIndex]->ProjectionY("_px", i, i);
-
-            // check statistics
-            if (l->Integral() < 0.1*p->Integral())
+            // check statistics compared to previous scr
+            if (sum[x] - sum[x-1] < 0.1*(sum[x+1] - sum[x]))
             {
                 // set bad scr
                 if (isbad)
                     if (!fBadScRCurr->IsBad(i)) SetBadScalerRead(i);
 
-                // clean up
-                delete p;
-                delete l;
-
                 // stop
                 break;
             }
         }
 
-        // init peak pos
-        Double_t peak = p->GetXaxis()->GetBinCenter(p->GetMaximumBin());
-
-        /* do not fit: is very slow and error-prone
-        // helpers
-        Double_t mean_y = p->GetMean(2);
-        Double_t max = p->GetMaximum();
+        // peak position
+        Double_t peak = h->GetYaxis()->GetBinCenter(peak_bin[x]);
 
-        // prepare function
-        f.SetParameters(mean_y, max,  peak, 5);
-        f.SetParLimits(0, 0, mean_y);
-        f.SetParLimits(1, max-mean_y, max);
-        f.SetParLimits(2, y_min, y_max);
-        f.SetParLimits(3, 1, 10);
-
-        // try fit max 10 times
-        for (Int_t j = 0; j < 10; j++)
+        // check for sudden shift
+        if (!isbad && i >= 1 && TMath::Abs(peak - last_peak) > tolerance)
         {
-            // fit and set result
-            if (!p->Fit(&f, "RBQ0")) // slow & error-prone
-            {
-                peak = f.GetParameter(2);
-                break;
-            }
-        }
-        */
-
-        // add point
-        g_peak_pos->SetPoint(g_peak_pos->GetN(), 0.5 + i, peak);
+            // set is bad flag
+            isbad = kTRUE;
 
-        // check for time shift
-        if (!isbad && g_peak_pos->GetN() >= 2)
-        {
-            Int_t n = g_peak_pos->GetN();
-
-            // check for sudden shift
-            if (TMath::Abs(g_peak_pos->GetY()[n-1] - g_peak_pos->GetY()[n-2]) > tolerance)
-            {
-                // set is bad flag
-                isbad = kTRUE;
-
-                // set previous bad scaler read
-                if (!fBadScRCurr->IsBad(i-1)) SetBadScalerRead(i-1);
-            }
+            // set previous bad scaler read
+            if (!fBadScRCurr->IsBad(i-1)) SetBadScalerRead(i-1);
         }
+        last_peak = peak;
 
         // set bad scaler read
         if (isbad)
             if (!fBadScRCurr->IsBad(i)) SetBadScalerRead(i);
-
-        delete p;
     }
+
+    // clean up
+    delete [] cells;
+    delete [] peak_bin;
+    delete [] peak_max;
+    delete [] integral;
+    delete [] sum;
 }
 
 // finito
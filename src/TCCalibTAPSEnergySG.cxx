@@ -196,7 +196,7 @@ void TCCalibTAPSEnergySG::Fit(Int_t elem)
         Int_t binMin = h2->GetYaxis()->FindBin(lowLimit1);
         Int_t binMax = h2->GetYaxis()->FindBin(highLimit1);
         fFitHisto = (TH1D*) h2->ProjectionX(tmp, binMin, binMax, "e");
-        TCUtils::FormatHistogram(fFitHisto, "TAPS.Energy.SG.Histo.Fit");
+        TCUtils::FormatHistogram(fFitHisto, fFitFormat);
 
         // delete old function
         if (fFitFunc) delete fFitFunc;
@@ -251,7 +251,7 @@ void TCCalibTAPSEnergySG::Fit(Int_t elem)
         binMin = h2->GetYaxis()->FindBin(lowLimit2);
         binMax = h2->GetYaxis()->FindBin(highLimit2);
         fFitHisto2 = (TH1D*) h2->ProjectionX(tmp, binMin, binMax, "e");
-        TCUtils::FormatHistogram(fFitHisto2, "TAPS.Energy.SG.Histo.Fit");
+        TCUtils::FormatHistogram(fFitHisto2, fFitFormat);
 
         // delete old function
         if (fFitFunc2) delete fFitFunc2;
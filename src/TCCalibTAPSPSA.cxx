@@ -23,6 +23,7 @@
 #include "TCReadConfig.h"
 #include "TCFileManager.h"
 #include "TCUtils.h"
+#include "TCFitFuncPool.h"
 
 ClassImp(TCCalibTAPSPSA)
 
@@ -235,9 +236,7 @@ void TCCalibTAPSPSA::Fit(Int_t elem)
                 Double_t peakPhoton = 45;
 
                 // create fitting function
-                if (fFitFunc) delete fFitFunc;
-                sprintf(tmp, "fFunc_%i", elem);
-                fFitFunc = new TF1(tmp, "gaus(0)+pol1(3)", peakPhoton-2, peakPhoton+2);
+                fFitFunc = fFitFuncPool->Get(TCFitFuncPool::kGausPol1, peakPhoton-2, peakPhoton+2);
                 fFitFunc->SetLineColor(2);
 
                 // prepare fitting function
@@ -20,6 +20,7 @@
 #include "TCMySQLManager.h"
 #include "TCFileManager.h"
 #include "TCUtils.h"
+#include "TCFitFuncPool.h"
 
 ClassImp(TCCalibTime)
 
@@ -35,6 +36,7 @@ TCCalibTime::TCCalibTime(const Char_t* name, const Char_t* title, const Char_t*
     for (Int_t i = 0; i < fNelem; i++) fTimeGain[i] = 0;
     fMean = 0;
     fLine = 0;
+    InitFitPolicy();
 }
 
 //______________________________________________________________________________
@@ -46,6 +48,25 @@ TCCalibTime::~TCCalibTime()
     if (fLine) delete fLine;
 }
 
+//______________________________________________________________________________
+void TCCalibTime::InitFitPolicy()
+{
+    // Set the default fit policy. Detector specific classes override this
+    // method to adjust the fit ranges, parameter limits and the calculation
+    // of the new values.
+
+    fFitRange = 3.8;
+    fFitFactor = 2.5;
+    fFitBackground = kFALSE;
+    fFitSigma = 8;
+    fFitSigmaMin = 0;
+    fFitSigmaMax = 20;
+    fTimeGainData = "";
+    fUseTimeGain = kTRUE;
+    fInvertPWO = kFALSE;
+    fMarkCBHoles = kFALSE;
+}
+
 //______________________________________________________________________________
 void TCCalibTime::Init()
 {
@@ -57,6 +78,9 @@ void TCCalibTime::Init()
     fMean = 0;
     fLine = new TCLine();
 
+    // resolve the detector specific fit policy
+    InitFitPolicy();
+
     // configure line
     fLine->SetLineColor(4);
     fLine->SetLineWidth(3);
@@ -71,28 +95,19 @@ void TCCalibTime::Init()
     else fHistoName = *TCReadConfig::GetReader()->GetConfig(tmp);
 
     // get time gain for TDCs
-    if (this->InheritsFrom("TCCalibTAPSTime"))
+    if (fTimeGainData != "")
     {
-        // get individual time gain for TAPS TDCs (only from first set)
-        TCMySQLManager::GetManager()->ReadParameters("Data.TAPS.T1", fCalibration.Data(), fSet[0], fTimeGain, fNelem);
+        // get individual time gain for TDCs (only from first set)
+        TCMySQLManager::GetManager()->ReadParameters(fTimeGainData.Data(), fCalibration.Data(), fSet[0], fTimeGain, fNelem);
     }
-    else if (this->InheritsFrom("TCCalibVetoTime"))
+    else if (fUseTimeGain)
     {
-        // get individual time gain for Veto TDCs (only from first set)
-        TCMySQLManager::GetManager()->ReadParameters("Data.Veto.T1", fCalibration.Data(), fSet[0], fTimeGain, fNelem);
-    }
-    else
-    {
-        // no time gain for CB rise time
-        if (!this->InheritsFrom("TCCalibCBRiseTime"))
-        {
-            sprintf(tmp, "%s.TDCGain", GetName());
-            Double_t tdc_gain;
-            if (!TCReadConfig::GetReader()->GetConfig(tmp)) tdc_gain = 0.11771;
-            else tdc_gain = TCReadConfig::GetReader()->GetConfigDouble(tmp);
-            for (Int_t i = 0; i < fNelem; i++) fTimeGain[i] = tdc_gain;
-            Info("Init", "Using a TDC gain of %f ns/channel", tdc_gain);
-        }
+        sprintf(tmp, "%s.TDCGain", GetName());
+        Double_t tdc_gain;
+        if (!TCReadConfig::GetReader()->GetConfig(tmp)) tdc_gain = 0.11771;
+        else tdc_gain = TCReadConfig::GetReader()->GetConfigDouble(tmp);
+        for (Int_t i = 0; i < fNelem; i++) fTimeGain[i] = tdc_gain;
+        Info("Init", "Using a TDC gain of %f ns/channel", tdc_gain);
     }
 
     // read old parameters (only from first set)
@@ -144,26 +159,17 @@ void TCCalibTime::Fit(Int_t elem)
     if (fFitHisto) delete fFitHisto;
     fFitHisto = (TH1D*) h2->ProjectionX(tmp, elem+1, elem+1, "e");
 
-    // init variables
-    Double_t factor = 2.5;
-    Double_t range = 3.8;
-
     // draw histogram
     fFitHisto->SetFillColor(35);
     fCanvasFit->cd(2);
-    sprintf(tmp, "%s.Histo.Fit", GetName());
-    TCUtils::FormatHistogram(fFitHisto, tmp);
+    TCUtils::FormatHistogram(fFitHisto, fFitFormat);
     fFitHisto->Draw("hist");
 
     // check for sufficient statistics
     if (fFitHisto->GetEntries() && !IsIgnored(elem))
     {
-        // delete old function
-        if (fFitFunc) delete fFitFunc;
-        sprintf(tmp, "fTime_%i", elem);
-
-        // the fit function
-        fFitFunc = new TF1("fFitFunc", "pol1(0)+gaus(2)");
+        // get the fit function
+        fFitFunc = fFitFuncPool->Get(TCFitFuncPool::kPol1Gaus);
         fFitFunc->SetLineColor(2);
 
         // get important parameter positions
@@ -172,46 +178,17 @@ void TCCalibTime::Fit(Int_t elem)
         Double_t max = fFitHisto->GetBinContent(fFitHisto->GetMaximumBin());
 
         // configure fitting function
-        fFitFunc->SetParameters(1, 0.1, max, fMean, 8);
+        fFitFunc->SetParameters(1, 0.1, max, fMean, fFitSigma);
         fFitFunc->SetParLimits(2, 0.1, max*10);
         fFitFunc->SetParLimits(3, fMean - 2, fMean + 2);
-        fFitFunc->SetParLimits(4, 0, 20);
+        fFitFunc->SetParLimits(4, fFitSigmaMin, fFitSigmaMax);
 
-        // special configuration for certain classes
-         if (!this->InheritsFrom("TCCalibTaggerTime") &&
-             !this->InheritsFrom("TCCalibTAPSTime")   &&
-             !this->InheritsFrom("TCCalibVetoTime")   &&
-             !this->InheritsFrom("TCCalibCBRiseTime"))
+        // only gaussian
+        if (!fFitBackground)
         {
-            // only gaussian
             fFitFunc->FixParameter(0, 0);
             fFitFunc->FixParameter(1, 0);
         }
-        if (this->InheritsFrom("TCCalibTAPSTime"))
-        {
-            fFitFunc->SetParameter(4, 0.5);
-            fFitFunc->SetParLimits(4, 0.001, 1);
-            range = 3;
-            factor = 1.5;
-        }
-        if (this->InheritsFrom("TCCalibPIDTime"))
-        {
-            factor = 1.5;
-        }
-        if (this->InheritsFrom("TCCalibPizzaTime"))
-        {
-            factor = 1.5;
-        }
-        if (this->InheritsFrom("TCCalibCBRiseTime"))
-        {
-            factor = 10;
-        }
-        if (this->InheritsFrom("TCCalibTaggerTime"))
-        {
-            range = 5;
-            factor = 10;
-            fFitFunc->SetParLimits(4, 0.01, 2);
-        }
 
         // check for refit
         if (fIsReFit)
@@ -221,16 +198,16 @@ void TCCalibTime::Fit(Int_t elem)
         else
         {
             // first iteration
-            fFitFunc->SetRange(fMean - range, fMean + range);
-            fFitHisto->Fit(fFitFunc, "RBQ0");
+            fFitFunc->SetRange(fMean - fFitRange, fMean + fFitRange);
+            FitPeak(fFitHisto, fFitFunc, "RBQ0");
             fMean = fFitFunc->GetParameter(3);
         }
 
         // second iteration
         Double_t sigma = fFitFunc->GetParameter(4);
-        fFitFunc->SetRange(fMean -factor*sigma, fMean +factor*sigma);
+        fFitFunc->SetRange(fMean - fFitFactor*sigma, fMean + fFitFactor*sigma);
         for (Int_t i = 0; i < 10; i++)
-            if(!fFitHisto->Fit(fFitFunc, "RBQ0")) break;
+            if (!FitPeak(fFitHisto, fFitFunc, "RBQ0")) break;
 
         // final results
         fMean = fFitFunc->GetParameter(3);
@@ -272,9 +249,9 @@ void TCCalibTime::Calculate(Int_t elem)
         if (fLine->GetPos() != fMean) fMean = fLine->GetPos();
 
         // calculate the new offset
-        if (this->InheritsFrom("TCCalibCBRiseTime"))
+        if (!fUseTimeGain)
             fNewVal[elem] = fOldVal[elem] + fMean;
-        else if (this->InheritsFrom("TCCalibTAPSTime") && TCUtils::IsTAPSPWO(elem, fNelem))
+        else if (fInvertPWO && TCUtils::IsTAPSPWO(elem, fNelem))
             fNewVal[elem] = fOldVal[elem] - fConvergenceFactor * fMean / fTimeGain[elem];
         else
             fNewVal[elem] = fOldVal[elem] + fConvergenceFactor * fMean / fTimeGain[elem];
@@ -296,7 +273,7 @@ void TCCalibTime::Calculate(Int_t elem)
     }
 
     // user information
-    if (this->InheritsFrom("TCCalibCBRiseTime")) strcpy(tmp, "rise time");
+    if (!fUseTimeGain) strcpy(tmp, "rise time");
     else strcpy(tmp, "offset");
 
     printf("Element: %03d    Peak: %12.8f    "
@@ -305,11 +282,7 @@ void TCCalibTime::Calculate(Int_t elem)
            TCUtils::GetDiffPercent(fOldVal[elem], fNewVal[elem]));
     if (unchanged) printf("    -> unchanged");
 
-    if (this->InheritsFrom("TCCalibCBTime") ||
-        this->InheritsFrom("TCCalibCBRiseTime"))
-    {
-        if (TCUtils::IsCBHole(elem)) printf(" (hole)");
-    }
+    if (fMarkCBHoles && TCUtils::IsCBHole(elem)) printf(" (hole)");
     printf("\n");
 
     // show average
@@ -172,7 +172,7 @@ void TCCalibVetoEnergy::FitSlice(TH2* h, Int_t elem)
     Int_t lastBin = h->GetXaxis()->FindBin(highLimit);
     if (fFitHisto) delete fFitHisto;
     fFitHisto = (TH1D*) h->ProjectionY(tmp, firstBin, lastBin, "e");
-    if (h != fMCHisto) TCUtils::FormatHistogram(fFitHisto, "Veto.Energy.Histo.Fit");
+    if (h != fMCHisto) TCUtils::FormatHistogram(fFitHisto, fFitFormat);
 
     // create fitting function
     if (fFitFunc) delete fFitFunc;
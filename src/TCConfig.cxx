@@ -37,7 +37,6 @@ namespace TCConfig
                     "run_note VARCHAR(256),"
                     "size BIGINT DEFAULT 0,"
                     "scr_n INT DEFAULT -1,"
-                    "scr_bad TEXT,"
                     "target VARCHAR(20),"
                     "target_pol VARCHAR(128),"
                     "target_pol_deg DOUBLE DEFAULT 0,"
@@ -57,9 +56,21 @@ namespace TCConfig
     // additional settings for the data tables
     const Char_t* kCalibDataTableSettings = ",PRIMARY KEY (calibration, first_run) ";
 
+    // name of the bad scaler read table
+    const Char_t* kCalibBadScRTableName = "run_bad_scr";
+
+    // format of the bad scaler read table (one row per interval of bad scaler reads)
+    const Char_t* kCalibBadScRTableFormat =
+                    "run INT NOT NULL,"
+                    "data VARCHAR(64) NOT NULL,"
+                    "first_scr INT NOT NULL,"
+                    "last_scr INT NOT NULL,"
+                    "PRIMARY KEY (run, data, first_scr) ";
+
     // version numbers
     const Char_t kCaLibVersion[] = "0.3.0beta";
-    const Int_t kContainerFormatVersion = 4;
+    const Int_t kContainerFormatVersion = 5;
+    const Int_t kContainerFormatVersionOld = 4;
     const Char_t kCaLibDumpName[] = "CaLib_Dump";
     const Int_t kNScREventHBin = 14;
 
@@ -8,17 +8,164 @@
 //                                                                      //
 // Run information and calibration storage class.                       //
 //                                                                      //
+// Since container format version 5 the runs and calibrations are       //
+// saved as the trees '<name>_Runs' and '<name>_Calibrations' next to   //
+// the container object, using variable length strings and one         //
+// contiguous parameter column. They can be saved and loaded entry by   //
+// entry without keeping the full content in memory.                    //
+//                                                                      //
 //////////////////////////////////////////////////////////////////////////
 
 
+#include "TBuffer.h"
 #include "TList.h"
 #include "TFile.h"
+#include "TTree.h"
+#include "TLeaf.h"
 
 #include "TCContainer.h"
 #include "TCConfig.h"
 
+ClassImp(TCRun)
+ClassImp(TCCalibration)
 ClassImp(TCContainer)
 
+
+//______________________________________________________________________________
+static void ReadCharArray(TBuffer& b, TString& s, Int_t n)
+{
+    // Read the fixed size character array of length 'n' from the buffer 'b'
+    // to the string 's'.
+
+    Char_t* tmp = new Char_t[n+1];
+    b.ReadFastArray(tmp, n);
+    tmp[n] = '\0';
+    s = tmp;
+    delete [] tmp;
+}
+
+// leaves of the run tree
+static const Int_t gNRunLeaves = 14;
+static const Char_t* gRunLeaves[gNRunLeaves] = { "run", "path", "filename", "time",
+                                                 "description", "run_note", "size",
+                                                 "scr_n", "scr_bad", "target", "target_pol",
+                                                 "target_pol_deg", "beam_pol", "beam_pol_deg" };
+
+// leaves of the calibration tree
+static const Int_t gNCalibLeaves = 8;
+static const Char_t* gCalibLeaves[gNCalibLeaves] = { "data", "calibration", "description",
+                                                     "first_run", "last_run", "changed",
+                                                     "npar", "par" };
+
+//______________________________________________________________________________
+static Bool_t GetLeafValues(TTree* t, Int_t n, const Char_t** names, void** out)
+{
+    // Save the pointers to the values of the 'n' leaves 'names' of the tree
+    // 't' to 'out'. Return kFALSE if a leaf does not exist or has no value.
+
+    for (Int_t i = 0; i < n; i++)
+    {
+        TLeaf* l = t->GetLeaf(names[i]);
+        out[i] = l ? l->GetValuePointer() : 0;
+        if (!out[i])
+        {
+            ::Error("TCContainer::GetLeafValues", "Branch '%s' of the tree '%s' was not found or not read!",
+                    names[i], t->GetName());
+            return kFALSE;
+        }
+    }
+
+    return kTRUE;
+}
+
+//______________________________________________________________________________
+void TCRun::Streamer(TBuffer& R__b)
+{
+    // Stream an object of class TCRun.
+    // Objects of class version 1 (container format version 4) using fixed
+    // size character arrays are converted when reading.
+
+    if (R__b.IsReading())
+    {
+        UInt_t R__s, R__c;
+        Version_t R__v = R__b.ReadVersion(&R__s, &R__c);
+
+        // current version
+        if (R__v > 1)
+        {
+            R__b.ReadClassBuffer(TCRun::Class(), this, R__v, R__s, R__c);
+            return;
+        }
+
+        // version 1
+        TObject::Streamer(R__b);
+        R__b >> fRun;
+        ReadCharArray(R__b, fPath, 256);
+        ReadCharArray(R__b, fFileName, 256);
+        ReadCharArray(R__b, fTime, 256);
+        ReadCharArray(R__b, fDescription, 256);
+        ReadCharArray(R__b, fRunNote, 256);
+        R__b >> fSize;
+        R__b >> fNScR;
+        ReadCharArray(R__b, fScRBad, 65536);
+        ReadCharArray(R__b, fTarget, 20);
+        ReadCharArray(R__b, fTargetPol, 128);
+        R__b >> fTargetPolDeg;
+        ReadCharArray(R__b, fBeamPol, 128);
+        R__b >> fBeamPolDeg;
+        R__b.CheckByteCount(R__s, R__c, TCRun::IsA());
+    }
+    else
+    {
+        R__b.WriteClassBuffer(TCRun::Class(), this);
+    }
+}
+
+//______________________________________________________________________________
+void TCCalibration::Streamer(TBuffer& R__b)
+{
+    // Stream an object of class TCCalibration.
+    // Objects of class version 1 (container format version 4) using fixed
+    // size character arrays are converted when reading.
+
+    if (R__b.IsReading())
+    {
+        UInt_t R__s, R__c;
+        Version_t R__v = R__b.ReadVersion(&R__s, &R__c);
+
+        // current version
+        if (R__v > 1)
+        {
+            R__b.ReadClassBuffer(TCCalibration::Class(), this, R__v, R__s, R__c);
+            return;
+        }
+
+        // version 1
+        TObject::Streamer(R__b);
+        ReadCharArray(R__b, fData, 256);
+        ReadCharArray(R__b, fCalibration, 256);
+        ReadCharArray(R__b, fDescription, 256);
+        R__b >> fFirstRun;
+        R__b >> fLastRun;
+        ReadCharArray(R__b, fChangeTime, 64);
+        R__b >> fNpar;
+        if (fPar) delete [] fPar;
+        fPar = 0;
+        Char_t isArray;
+        R__b >> isArray;
+        if (isArray && fNpar > 0)
+        {
+            fPar = new Double_t[fNpar];
+            R__b.ReadFastArray(fPar, fNpar);
+        }
+        R__b.CheckByteCount(R__s, R__c, TCCalibration::IsA());
+    }
+    else
+    {
+        R__b.WriteClassBuffer(TCCalibration::Class(), this);
+    }
+}
+
 //______________________________________________________________________________
 TCContainer::TCContainer(const Char_t* name)
     : TNamed(name, name)
@@ -31,6 +178,9 @@ TCContainer::TCContainer(const Char_t* name)
     fRuns->SetOwner(kTRUE);
     fCalibrations = new TList();
     fCalibrations->SetOwner(kTRUE);
+    fFile = 0;
+    fRunTree = 0;
+    fCalibTree = 0;
 }
 
 //______________________________________________________________________________
@@ -40,6 +190,7 @@ TCContainer::~TCContainer()
 
     if (fRuns) delete fRuns;
     if (fCalibrations) delete fCalibrations;
+    if (fFile) delete fFile;
 }
 
 //______________________________________________________________________________
@@ -116,31 +267,392 @@ Bool_t TCContainer::Save(const Char_t* filename, Bool_t silence)
     // Save this container to the ROOT file 'filename'.
     // Return kFALSE if an error occurred, otherwise kTRUE.
 
+    // create the file
+    if (!BeginSave(filename, silence)) return kFALSE;
+
+    // save runs
+    Bool_t ok = kTRUE;
+    TIter next_run(fRuns);
+    TCRun* r;
+    while ((r = (TCRun*)next_run()))
+    {
+        if (!SaveRun(r))
+        {
+            if (!silence) Error("Save", "Could not save run %d!", r->GetRun());
+            ok = kFALSE;
+        }
+    }
+
+    // save calibrations
+    TIter next_calib(fCalibrations);
+    TCCalibration* c;
+    while ((c = (TCCalibration*)next_calib()))
+    {
+        if (!SaveCalibration(c))
+        {
+            if (!silence) Error("Save", "Could not save calibration '%s' of '%s'!",
+                                c->GetCalibration(), c->GetCalibData());
+            ok = kFALSE;
+        }
+    }
+
+    // finish the file
+    if (!EndSave(silence)) ok = kFALSE;
+
+    return ok;
+}
+
+//______________________________________________________________________________
+void TCContainer::SetRunAddresses(TCRun* r)
+{
+    // Set the branch addresses of the run tree to the members of the run 'r'.
+
+    fRunTree->SetBranchAddress("run", &r->fRun);
+    fRunTree->SetBranchAddress("path", (void*)r->fPath.Data());
+    fRunTree->SetBranchAddress("filename", (void*)r->fFileName.Data());
+    fRunTree->SetBranchAddress("time", (void*)r->fTime.Data());
+    fRunTree->SetBranchAddress("description", (void*)r->fDescription.Data());
+    fRunTree->SetBranchAddress("run_note", (void*)r->fRunNote.Data());
+    fRunTree->SetBranchAddress("size", &r->fSize);
+    fRunTree->SetBranchAddress("scr_n", &r->fNScR);
+    fRunTree->SetBranchAddress("scr_bad", (void*)r->fScRBad.Data());
+    fRunTree->SetBranchAddress("target", (void*)r->fTarget.Data());
+    fRunTree->SetBranchAddress("target_pol", (void*)r->fTargetPol.Data());
+    fRunTree->SetBranchAddress("target_pol_deg", &r->fTargetPolDeg);
+    fRunTree->SetBranchAddress("beam_pol", (void*)r->fBeamPol.Data());
+    fRunTree->SetBranchAddress("beam_pol_deg", &r->fBeamPolDeg);
+}
+
+//______________________________________________________________________________
+void TCContainer::SetCalibrationAddresses(TCCalibration* c)
+{
+    // Set the branch addresses of the calibration tree to the members of the
+    // calibration 'c'.
+
+    fCalibTree->SetBranchAddress("data", (void*)c->fData.Data());
+    fCalibTree->SetBranchAddress("calibration", (void*)c->fCalibration.Data());
+    fCalibTree->SetBranchAddress("description", (void*)c->fDescription.Data());
+    fCalibTree->SetBranchAddress("first_run", &c->fFirstRun);
+    fCalibTree->SetBranchAddress("last_run", &c->fLastRun);
+    fCalibTree->SetBranchAddress("changed", (void*)c->fChangeTime.Data());
+    fCalibTree->SetBranchAddress("npar", &c->fNpar);
+    fCalibTree->SetBranchAddress("par", c->fPar);
+}
+
+//______________________________________________________________________________
+Bool_t TCContainer::BeginSave(const Char_t* filename, Bool_t silence)
+{
+    // Create the ROOT file 'filename' for the incremental saving of runs and
+    // calibrations using SaveRun() and SaveCalibration(). The file has to be
+    // completed by calling EndSave().
+    // Return kFALSE if an error occurred, otherwise kTRUE.
+
+    // check for open file
+    if (fFile || fRunTree || fCalibTree)
+    {
+        if (!silence) Error("BeginSave", "Container is already used for saving or loading!");
+        return kFALSE;
+    }
+
     // try to open the ROOT file
     TFile* f = new TFile(filename, "CREATE");
-    if (!f)
+    if (f->IsZombie())
     {
-        if (!silence) Error("Save", "Could not create file '%s'!", filename);
+        if (!silence) Error("BeginSave", "Could not create file '%s'!", filename);
+        delete f;
         return kFALSE;
     }
-    if (f->IsZombie())
+    fFile = f;
+    fFile->cd();
+
+    // create the run tree
+    fRunTree = new TTree(TString::Format("%s_Runs", GetName()), "CaLib runs");
+    fRunTree->Branch("run", 0, "run/I");
+    fRunTree->Branch("path", 0, "path/C");
+    fRunTree->Branch("filename", 0, "filename/C");
+    fRunTree->Branch("time", 0, "time/C");
+    fRunTree->Branch("description", 0, "description/C");
+    fRunTree->Branch("run_note", 0, "run_note/C");
+    fRunTree->Branch("size", 0, "size/L");
+    fRunTree->Branch("scr_n", 0, "scr_n/I");
+    fRunTree->Branch("scr_bad", 0, "scr_bad/C");
+    fRunTree->Branch("target", 0, "target/C");
+    fRunTree->Branch("target_pol", 0, "target_pol/C");
+    fRunTree->Branch("target_pol_deg", 0, "target_pol_deg/D");
+    fRunTree->Branch("beam_pol", 0, "beam_pol/C");
+    fRunTree->Branch("beam_pol_deg", 0, "beam_pol_deg/D");
+
+    // create the calibration tree
+    fCalibTree = new TTree(TString::Format("%s_Calibrations", GetName()), "CaLib calibrations");
+    fCalibTree->Branch("data", 0, "data/C");
+    fCalibTree->Branch("calibration", 0, "calibration/C");
+    fCalibTree->Branch("description", 0, "description/C");
+    fCalibTree->Branch("first_run", 0, "first_run/I");
+    fCalibTree->Branch("last_run", 0, "last_run/I");
+    fCalibTree->Branch("changed", 0, "changed/C");
+    fCalibTree->Branch("npar", 0, "npar/I");
+    fCalibTree->Branch("par", 0, "par[npar]/D");
+
+    return kTRUE;
+}
+
+//______________________________________________________________________________
+Bool_t TCContainer::SaveRun(TCRun* r)
+{
+    // Append the run 'r' to the file opened by BeginSave().
+    // Return kFALSE if an error occurred, otherwise kTRUE.
+
+    // check file
+    if (!fFile || !fRunTree)
     {
-        if (!silence) Error("Save", "Could not create file '%s'!", filename);
+        Error("SaveRun", "No file was opened for saving!");
         return kFALSE;
     }
 
-    // save me
-    this->Write();
+    // fill the tree
+    SetRunAddresses(r);
+    return fRunTree->Fill() > 0;
+}
+
+//______________________________________________________________________________
+Bool_t TCContainer::SaveCalibration(TCCalibration* c)
+{
+    // Append the calibration 'c' to the file opened by BeginSave().
+    // Return kFALSE if an error occurred, otherwise kTRUE.
+
+    // check file
+    if (!fFile || !fCalibTree)
+    {
+        Error("SaveCalibration", "No file was opened for saving!");
+        return kFALSE;
+    }
+
+    // fill the tree
+    SetCalibrationAddresses(c);
+    return fCalibTree->Fill() > 0;
+}
+
+//______________________________________________________________________________
+Bool_t TCContainer::EndSave(Bool_t silence)
+{
+    // Write the container header and the trees to the file opened by
+    // BeginSave() and close it.
+    // Return kFALSE if an error occurred, otherwise kTRUE.
+
+    // check file
+    if (!fFile)
+    {
+        if (!silence) Error("EndSave", "No file was opened for saving!");
+        return kFALSE;
+    }
+
+    // write the container header without the in-memory lists
+    fFile->cd();
+    TCContainer header(GetName());
+    Bool_t ok = header.Write() > 0;
+
+    // write the trees
+    if (fRunTree->Write(0, TObject::kOverwrite) <= 0) ok = kFALSE;
+    if (fCalibTree->Write(0, TObject::kOverwrite) <= 0) ok = kFALSE;
 
     // user information
-    if (!silence) Info("Save", "CaLib data was saved to '%s'", filename);
+    if (!silence)
+    {
+        if (ok)
+            Info("EndSave", "CaLib data (%lld runs, %lld calibrations) was saved to '%s'",
+                 fRunTree->GetEntries(), fCalibTree->GetEntries(), fFile->GetName());
+        else
+            Error("EndSave", "Could not write CaLib data to '%s'!", fFile->GetName());
+    }
+
+    // close file (deletes the trees)
+    delete fFile;
+    fFile = 0;
+    fRunTree = 0;
+    fCalibTree = 0;
+
+    return ok;
+}
+
+//______________________________________________________________________________
+Bool_t TCContainer::BeginLoad(TFile* f)
+{
+    // Prepare the incremental loading of runs and calibrations saved in the
+    // format version 5 or later from the file 'f' using LoadRun() and
+    // LoadCalibration(). The file has to stay open until EndLoad() is called.
+    // Return kFALSE if an error occurred, otherwise kTRUE.
+
+    // check for open file
+    if (fFile || fRunTree || fCalibTree)
+    {
+        Error("BeginLoad", "Container is already used for saving or loading!");
+        return kFALSE;
+    }
+
+    // get the trees
+    fRunTree = (TTree*) f->Get(TString::Format("%s_Runs", GetName()));
+    fCalibTree = (TTree*) f->Get(TString::Format("%s_Calibrations", GetName()));
+    if (!fRunTree || !fCalibTree)
+    {
+        Error("BeginLoad", "CaLib data trees not found in '%s'!", f->GetName());
+        fRunTree = 0;
+        fCalibTree = 0;
+        return kFALSE;
+    }
+
+    // check the branches
+    for (Int_t i = 0; i < gNRunLeaves + gNCalibLeaves; i++)
+    {
+        TTree* t = i < gNRunLeaves ? fRunTree : fCalibTree;
+        const Char_t* name = i < gNRunLeaves ? gRunLeaves[i] : gCalibLeaves[i-gNRunLeaves];
+        if (!t->GetLeaf(name))
+        {
+            Error("BeginLoad", "Branch '%s' of the tree '%s' not found in '%s'!",
+                  name, t->GetName(), f->GetName());
+            fRunTree = 0;
+            fCalibTree = 0;
+            return kFALSE;
+        }
+    }
+
+    return kTRUE;
+}
+
+//______________________________________________________________________________
+Long64_t TCContainer::GetNSavedRuns() const
+{
+    // Return the number of runs in the file opened by BeginLoad().
+
+    return fRunTree ? fRunTree->GetEntries() : 0;
+}
+
+//______________________________________________________________________________
+Long64_t TCContainer::GetNSavedCalibrations() const
+{
+    // Return the number of calibrations in the file opened by BeginLoad().
+
+    return fCalibTree ? fCalibTree->GetEntries() : 0;
+}
 
-    // close file
-    delete f;
+//______________________________________________________________________________
+Bool_t TCContainer::LoadRun(Long64_t n, TCRun* r)
+{
+    // Load the run at index 'n' of the file opened by BeginLoad() to 'r'.
+    // Return kFALSE if an error occurred, otherwise kTRUE.
+
+    // read the entry
+    if (fFile || !fRunTree || fRunTree->GetEntry(n) <= 0) return kFALSE;
+
+    // get the values
+    void* v[gNRunLeaves];
+    if (!GetLeafValues(fRunTree, gNRunLeaves, gRunLeaves, v)) return kFALSE;
+
+    // copy the values
+    r->fRun = *(Int_t*)v[0];
+    r->fPath = (Char_t*)v[1];
+    r->fFileName = (Char_t*)v[2];
+    r->fTime = (Char_t*)v[3];
+    r->fDescription = (Char_t*)v[4];
+    r->fRunNote = (Char_t*)v[5];
+    r->fSize = *(Long64_t*)v[6];
+    r->fNScR = *(Int_t*)v[7];
+    r->fScRBad = (Char_t*)v[8];
+    r->fTarget = (Char_t*)v[9];
+    r->fTargetPol = (Char_t*)v[10];
+    r->fTargetPolDeg = *(Double_t*)v[11];
+    r->fBeamPol = (Char_t*)v[12];
+    r->fBeamPolDeg = *(Double_t*)v[13];
 
     return kTRUE;
 }
 
+//______________________________________________________________________________
+Bool_t TCContainer::LoadCalibration(Long64_t n, TCCalibration* c)
+{
+    // Load the calibration at index 'n' of the file opened by BeginLoad() to
+    // 'c'.
+    // Return kFALSE if an error occurred, otherwise kTRUE.
+
+    // read the entry
+    if (fFile || !fCalibTree || fCalibTree->GetEntry(n) <= 0) return kFALSE;
+
+    // get the values
+    void* v[gNCalibLeaves];
+    if (!GetLeafValues(fCalibTree, gNCalibLeaves, gCalibLeaves, v)) return kFALSE;
+
+    // copy the values
+    c->fData = (Char_t*)v[0];
+    c->fCalibration = (Char_t*)v[1];
+    c->fDescription = (Char_t*)v[2];
+    c->fFirstRun = *(Int_t*)v[3];
+    c->fLastRun = *(Int_t*)v[4];
+    c->fChangeTime = (Char_t*)v[5];
+    c->SetParameters(*(Int_t*)v[6], (Double_t*)v[7]);
+
+    return kTRUE;
+}
+
+//______________________________________________________________________________
+Bool_t TCContainer::LoadAll()
+{
+    // Load all runs and calibrations of the file opened by BeginLoad() to the
+    // in-memory lists.
+    // Return kFALSE if an error occurred, otherwise kTRUE.
+
+    // check trees
+    if (!fRunTree || !fCalibTree) return kFALSE;
+
+    // create lists if needed
+    if (!fRuns)
+    {
+        fRuns = new TList();
+        fRuns->SetOwner(kTRUE);
+    }
+    if (!fCalibrations)
+    {
+        fCalibrations = new TList();
+        fCalibrations->SetOwner(kTRUE);
+    }
+
+    // load runs
+    Long64_t nruns = GetNSavedRuns();
+    for (Long64_t i = 0; i < nruns; i++)
+    {
+        TCRun* r = new TCRun();
+        if (!LoadRun(i, r))
+        {
+            delete r;
+            return kFALSE;
+        }
+        fRuns->Add(r);
+    }
+
+    // load calibrations
+    Long64_t ncalib = GetNSavedCalibrations();
+    for (Long64_t i = 0; i < ncalib; i++)
+    {
+        TCCalibration* c = new TCCalibration();
+        if (!LoadCalibration(i, c))
+        {
+            delete c;
+            return kFALSE;
+        }
+        fCalibrations->Add(c);
+    }
+
+    return kTRUE;
+}
+
+//______________________________________________________________________________
+void TCContainer::EndLoad()
+{
+    // Finish the incremental loading started by BeginLoad(). The trees are
+    // owned by the file and are not deleted.
+
+    fRunTree = 0;
+    fCalibTree = 0;
+}
+
 //______________________________________________________________________________
 void TCContainer::Print(Option_t* option) const
 {
@@ -0,0 +1,336 @@
+/*************************************************************************
+ * Author: Dominik Werthmueller
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TCDataGenerator                                                      //
+//                                                                      //
+// Generate synthetic AcquRoot histogram files with known peak          //
+// positions and bad scaler reads for benchmarks and tests.             //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+
+#include "TList.h"
+#include "TFile.h"
+#include "TH2.h"
+#include "TRandom3.h"
+#include "TMath.h"
+#include "TError.h"
+
+#include "TCDataGenerator.h"
+#include "TCReadConfig.h"
+#include "TCConfig.h"
+
+ClassImp(TCDataGenerator)
+
+// time histograms of the time calibration modules
+struct DataGenHisto
+{
+    const Char_t* module;               // calibration module name
+    const Char_t* name;                 // default histogram name
+    const Int_t* nElem;                 // number of elements
+};
+static const DataGenHisto gDataGenTime[] =
+{
+    { "Tagger.Time", "CaLib_Tagger_Time", &TCConfig::kMaxTAGGER },
+    { "CB.Time",     "CaLib_CB_Time",     &TCConfig::kMaxCB     },
+    { "TAPS.Time",   "CaLib_TAPS_Time",   &TCConfig::kMaxTAPS   },
+    { "PID.Time",    "CaLib_PID_Time",    &TCConfig::kMaxPID    },
+    { "Veto.Time",   "CaLib_Veto_Time",   &TCConfig::kMaxVeto   }
+};
+
+// hit histograms of the bad scaler read modules
+static const DataGenHisto gDataGenBadScR[] =
+{
+    { "BadScR.NaI",     "CaLib_BadScR_NaIHits",     &TCConfig::kMaxCB   },
+    { "BadScR.PID",     "CaLib_BadScR_PIDHits",     &TCConfig::kMaxPID  },
+    { "BadScR.BaF2PWO", "CaLib_BadScR_BaF2PWOHits", &TCConfig::kMaxTAPS },
+    { "BadScR.Veto",    "CaLib_BadScR_VetoHits",    &TCConfig::kMaxVeto }
+};
+
+//______________________________________________________________________________
+static TString GetDataGenHistoName(const Char_t* key, const Char_t* defName)
+{
+    // Return the histogram name configured under the key 'key' or the
+    // default name 'defName' if the key is not set.
+
+    TString* s = TCReadConfig::GetReader()->GetConfig(key);
+    return s ? *s : TString(defName);
+}
+
+//______________________________________________________________________________
+static Int_t GetDataGenScaler(const Char_t* key, Int_t def)
+{
+    // Return the scaler index configured under the key 'key' or the default
+    // index 'def' if the key is not set.
+
+    Int_t h = TCReadConfig::GetReader()->GetHandle(key, kConfigInt);
+    return TCReadConfig::GetReader()->IsSet(h) ? TCReadConfig::GetReader()->GetInt(h) : def;
+}
+
+//______________________________________________________________________________
+TCDataGenerator::TCDataGenerator(const Char_t* filePatt)
+{
+    // Constructor using the output file pattern 'filePatt' (e.g.
+    // '/path/ARHistograms_CBTaggTAPS_RUN.root'), where 'RUN' is replaced by
+    // the run number.
+
+    // init members
+    fFilePatt = filePatt;
+    fNTimeBins = 200;
+    fTimeMin = -100;
+    fTimeMax = 100;
+    fPeakSigma = 4;
+    fPeakCounts = 1000;
+    fBackground = 2;
+    fNScR = 100;
+    fBadScRFraction = 0.05;
+    fBadScRFactor = 0.3;
+    fNoise = kTRUE;
+    fSeed = 4711;
+
+    // check file pattern
+    if (!fFilePatt.Contains("RUN"))
+        Error("TCDataGenerator", "Output file pattern '%s' does not contain 'RUN'!", filePatt);
+}
+
+//______________________________________________________________________________
+UInt_t TCDataGenerator::GetHash(Int_t run, Int_t i) const
+{
+    // Return a hash of the random seed, the run 'run' and the index 'i'.
+
+    UInt_t h = fSeed ^ (2654435761U * (UInt_t)run) ^ (40503U * (UInt_t)i + 0x9e3779b9U);
+    h ^= h >> 16;
+    h *= 0x85ebca6bU;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35U;
+    h ^= h >> 16;
+
+    return h;
+}
+
+//______________________________________________________________________________
+Double_t TCDataGenerator::Sample(TRandom* rand, Double_t mu) const
+{
+    // Return a Poisson distributed value of the mean 'mu' or 'mu' itself if
+    // the fluctuations are disabled.
+
+    return fNoise ? rand->Poisson(mu) : mu;
+}
+
+//______________________________________________________________________________
+Double_t TCDataGenerator::GetPeakPosition(Int_t elem)
+{
+    // Return the injected time peak position of the element 'elem' in ns.
+    // The positions are spread between -10 and 10 ns and are identical for
+    // all detectors.
+
+    Double_t f = elem * 0.6180339887;
+
+    return -10 + 20 * (f - TMath::Floor(f));
+}
+
+//______________________________________________________________________________
+Bool_t TCDataGenerator::IsBadScR(Int_t run, Int_t scr) const
+{
+    // Return kTRUE if the scaler read 'scr' of the run 'run' is generated as
+    // a bad scaler read.
+
+    return GetHash(run, scr) < fBadScRFraction * 4294967295.;
+}
+
+//______________________________________________________________________________
+Int_t TCDataGenerator::GetBadScR(Int_t run, Int_t* outBadScR) const
+{
+    // Save the injected bad scaler reads of the run 'run' to 'outBadScR'
+    // (if non-zero, at least GetNScR() elements) and return their number.
+
+    Int_t n = 0;
+    for (Int_t i = 0; i < fNScR; i++)
+    {
+        if (IsBadScR(run, i))
+        {
+            if (outBadScR) outBadScR[n] = i;
+            n++;
+        }
+    }
+
+    return n;
+}
+
+//______________________________________________________________________________
+void TCDataGenerator::AddTimeHistos(TList* list, TRandom* rand) const
+{
+    // Add the element vs. time histograms of the time calibration modules
+    // to the list 'list' using the random generator 'rand'.
+
+    Double_t binWidth = (fTimeMax - fTimeMin) / fNTimeBins;
+    Double_t norm = fPeakCounts * binWidth / (TMath::Sqrt(2*TMath::Pi()) * fPeakSigma);
+    Double_t* mu = new Double_t[fNTimeBins];
+
+    // loop over modules
+    for (UInt_t m = 0; m < sizeof(gDataGenTime) / sizeof(DataGenHisto); m++)
+    {
+        // get histogram name
+        Char_t tmp[256];
+        sprintf(tmp, "%s.Histo.Fit.Name", gDataGenTime[m].module);
+        TString name = GetDataGenHistoName(tmp, gDataGenTime[m].name);
+
+        // create histogram
+        Int_t nElem = *gDataGenTime[m].nElem;
+        TH2F* h = new TH2F(name.Data(), name.Data(), fNTimeBins, fTimeMin, fTimeMax,
+                           nElem, 0, nElem);
+
+        // fill the Gaussian peaks at the known positions
+        Float_t* bins = h->GetArray();
+        for (Int_t i = 0; i < nElem; i++)
+        {
+            Double_t pos = GetPeakPosition(i);
+            for (Int_t j = 0; j < fNTimeBins; j++)
+            {
+                Double_t x = fTimeMin + (j + 0.5) * binWidth;
+                mu[j] = fBackground + norm * TMath::Exp(-0.5 * (x - pos)*(x - pos) / (fPeakSigma*fPeakSigma));
+            }
+
+            // fill the row (bins include under- and overflow)
+            Float_t* row = bins + (i+1)*(fNTimeBins+2) + 1;
+            for (Int_t j = 0; j < fNTimeBins; j++) row[j] = Sample(rand, mu[j]);
+        }
+        h->SetEntries(h->Integral());
+
+        list->Add(h);
+    }
+
+    // clean-up
+    delete [] mu;
+}
+
+//______________________________________________________________________________
+void TCDataGenerator::AddBadScRHistos(TList* list, TRandom* rand, Int_t run) const
+{
+    // Add the scaler read vs. element hit histograms of the bad scaler read
+    // modules, the scaler histogram and the event information histogram of
+    // the run 'run' to the list 'list' using the random generator 'rand'.
+    // The hit rates of the bad scaler reads are reduced by the bad scaler
+    // read factor, the scalers are not affected.
+
+    // scaler channels
+    Int_t scP2 = GetDataGenScaler("BadScR.Scaler.P2", 151);
+    Int_t scFree = GetDataGenScaler("BadScR.Scaler.Free", 529);
+    Int_t scLive = GetDataGenScaler("BadScR.Scaler.Live", 528);
+    Int_t nSc = TMath::Max(scP2, TMath::Max(scFree, scLive)) + 1;
+
+    // beam intensity of the scaler reads
+    Double_t* beam = new Double_t[fNScR];
+    for (Int_t i = 0; i < fNScR; i++) beam[i] = 1 + 0.2*TMath::Sin(0.3*i + run);
+
+    // scaler histogram
+    TString name = GetDataGenHistoName("BadScR.Histo.Scaler.Name", "CaLib_BadScR_Scalers");
+    TH2F* hsc = new TH2F(name.Data(), name.Data(), fNScR, 0, fNScR, nSc, 0, nSc);
+    for (Int_t i = 0; i < fNScR; i++)
+    {
+        if (scP2 >= 0) hsc->SetBinContent(i+1, scP2+1, Sample(rand, 1e5*beam[i]));
+        if (scFree >= 0) hsc->SetBinContent(i+1, scFree+1, Sample(rand, 1e6*beam[i]));
+        if (scLive >= 0) hsc->SetBinContent(i+1, scLive+1, Sample(rand, 0.8e6*beam[i]));
+    }
+    list->Add(hsc);
+
+    // hit histograms
+    for (UInt_t m = 0; m < sizeof(gDataGenBadScR) / sizeof(DataGenHisto); m++)
+    {
+        // get histogram name
+        Char_t tmp[256];
+        sprintf(tmp, "%s.Histo.Main.Name", gDataGenBadScR[m].module);
+        name = GetDataGenHistoName(tmp, gDataGenBadScR[m].name);
+
+        // create histogram
+        Int_t nElem = *gDataGenBadScR[m].nElem;
+        TH2F* h = new TH2F(name.Data(), name.Data(), fNScR, 0, fNScR, nElem, 0, nElem);
+
+        // fill hits
+        for (Int_t i = 0; i < fNScR; i++)
+        {
+            Double_t f = beam[i] * (IsBadScR(run, i) ? fBadScRFactor : 1.);
+            for (Int_t j = 0; j < nElem; j++)
+                h->SetBinContent(i+1, j+1, Sample(rand, f * (20 + 10*TMath::Sin(j))));
+        }
+        h->SetEntries(h->Integral());
+
+        list->Add(h);
+    }
+
+    // event information histogram
+    TH1F* hev = new TH1F("EventInfo", "EventInfo", 20, 0, 20);
+    hev->SetBinContent(TCConfig::kNScREventHBin, fNScR);
+    list->Add(hev);
+
+    // clean-up
+    delete [] beam;
+}
+
+//______________________________________________________________________________
+Bool_t TCDataGenerator::WriteRun(Int_t run) const
+{
+    // Write the file of the run 'run'. The generated data depends only on
+    // the random seed and the run number.
+    // Return kFALSE if an error occurred, otherwise kTRUE.
+
+    // create the histograms
+    Bool_t addDir = TH1::AddDirectoryStatus();
+    TH1::AddDirectory(kFALSE);
+    TRandom3 rand(GetHash(run, -1));
+    TList histos;
+    histos.SetOwner(kTRUE);
+    AddTimeHistos(&histos, &rand);
+    AddBadScRHistos(&histos, &rand, run);
+    TH1::AddDirectory(addDir);
+
+    // create the file
+    TString filename(fFilePatt);
+    filename.ReplaceAll("RUN", TString::Format("%d", run));
+    TFile* f = TFile::Open(filename.Data(), "RECREATE");
+    if (!f || f->IsZombie())
+    {
+        Error("WriteRun", "Could not create the file '%s'!", filename.Data());
+        if (f) delete f;
+        return kFALSE;
+    }
+
+    // write the histograms
+    TIter next(&histos);
+    TObject* h;
+    while ((h = next())) h->Write();
+
+    // close the file
+    f->Close();
+    delete f;
+
+    return kTRUE;
+}
+
+//______________________________________________________________________________
+Int_t TCDataGenerator::WriteRuns(Int_t first_run, Int_t last_run) const
+{
+    // Write the files of the runs 'first_run' to 'last_run'.
+    // Return the number of written files.
+
+    Int_t nRuns = last_run - first_run + 1;
+    Int_t nWritten = 0;
+    Int_t per = 10;
+    for (Int_t i = 0; i < nRuns; i++)
+    {
+        if (WriteRun(first_run+i)) nWritten++;
+
+        // print progress
+        if (100*(i+1) >= per*nRuns)
+        {
+            Info("WriteRuns", "Progress %d%%...", per);
+            per += 10;
+        }
+    }
+
+    return nWritten;
+}
+
@@ -0,0 +1,147 @@
+/*************************************************************************
+ * Author: Dominik Werthmueller
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TCDataQueue                                                          //
+//                                                                      //
+// Bounded thread-safe queue of objects passed between the stages of a  //
+// producer/consumer pipeline.                                          //
+//                                                                      //
+// Push() blocks while the queue is full, Pop() blocks while the queue  //
+// is empty. The producer calls Close() after the last object. A        //
+// consumer stopping early calls Close() as well to release a blocked   //
+// producer. Objects remaining in the queue are deleted.                //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+
+#include "TList.h"
+#include "TThread.h"
+#include "TMutex.h"
+#include "TCondition.h"
+
+#include "TCDataQueue.h"
+
+ClassImp(TCDataQueue)
+
+
+//______________________________________________________________________________
+TCDataQueue::TCDataQueue(Int_t capacity)
+    : TObject()
+{
+    // Constructor using the maximum number of queued objects 'capacity'.
+
+    // init members
+    fCapacity = capacity > 0 ? capacity : 1;
+    fMaxSize = 0;
+    fClosed = kFALSE;
+    fList = new TList();
+    fList->SetOwner(kTRUE);
+
+    // init synchronization
+    TThread::Initialize();
+    fMutex = new TMutex();
+    fNotEmpty = new TCondition(fMutex);
+    fNotFull = new TCondition(fMutex);
+}
+
+//______________________________________________________________________________
+TCDataQueue::~TCDataQueue()
+{
+    // Destructor.
+
+    if (fNotEmpty) delete fNotEmpty;
+    if (fNotFull) delete fNotFull;
+    if (fMutex) delete fMutex;
+    if (fList) delete fList;
+}
+
+//______________________________________________________________________________
+Bool_t TCDataQueue::Push(TObject* obj)
+{
+    // Append the object 'obj' to the queue. Wait while the queue is full.
+    // The queue takes ownership of the object on success.
+    // Return kFALSE if the queue was closed, otherwise kTRUE.
+
+    fMutex->Lock();
+
+    // wait for free space
+    while (!fClosed && fList->GetSize() >= fCapacity) fNotFull->Wait();
+
+    // check if closed
+    if (fClosed)
+    {
+        fMutex->UnLock();
+        return kFALSE;
+    }
+
+    // add object
+    fList->AddLast(obj);
+    if (fList->GetSize() > fMaxSize) fMaxSize = fList->GetSize();
+    fNotEmpty->Signal();
+
+    fMutex->UnLock();
+
+    return kTRUE;
+}
+
+//______________________________________________________________________________
+TObject* TCDataQueue::Pop()
+{
+    // Remove and return the first object of the queue. Wait while the queue
+    // is empty. The caller takes ownership of the object.
+    // Return 0 if the queue is empty and was closed.
+
+    fMutex->Lock();
+
+    // wait for an object
+    while (!fClosed && !fList->GetSize()) fNotEmpty->Wait();
+
+    // get object
+    TObject* obj = fList->GetSize() ? fList->Remove(fList->FirstLink()) : 0;
+    if (obj) fNotFull->Signal();
+
+    fMutex->UnLock();
+
+    return obj;
+}
+
+//______________________________________________________________________________
+void TCDataQueue::Close()
+{
+    // Close the queue. Further calls of Push() fail and Pop() returns 0 after
+    // the remaining objects were taken.
+
+    fMutex->Lock();
+    fClosed = kTRUE;
+    fNotEmpty->Broadcast();
+    fNotFull->Broadcast();
+    fMutex->UnLock();
+}
+
+//______________________________________________________________________________
+Int_t TCDataQueue::GetSize() const
+{
+    // Return the number of queued objects.
+
+    fMutex->Lock();
+    Int_t n = fList->GetSize();
+    fMutex->UnLock();
+
+    return n;
+}
+
+//______________________________________________________________________________
+Bool_t TCDataQueue::IsClosed() const
+{
+    // Return kTRUE if the queue was closed.
+
+    fMutex->Lock();
+    Bool_t c = fClosed;
+    fMutex->UnLock();
+
+    return c;
+}
+
@@ -13,12 +13,14 @@
 
 #include "TList.h"
 #include "TFile.h"
+#include "TKey.h"
 #include "TH1.h"
 #include "TError.h"
 
 #include "TCFileManager.h"
 #include "TCReadConfig.h"
 #include "TCMySQLManager.h"
+#include "TCInstrument.h"
 
 ClassImp(TCFileManager)
 
@@ -80,6 +82,9 @@ void TCFileManager::BuildFileList()
 {
     // Build the list of files belonging to the runsets.
 
+    TCINSTR_SCOPE("TCFileManager::BuildFileList");
+    Long64_t bytes = TFile::GetFileBytesRead();
+
     // loop over sets
     for (Int_t i = 0; i < fNset; i++)
     {
@@ -116,6 +121,7 @@ void TCFileManager::BuildFileList()
 
             // add good file to list
             fFiles->Add(f);
+            TCINSTR_COUNT(kINSTR_FILES_OPENED, 1);
 
             // user information
             Info("BuildFileList", "%03d : added file '%s'", j, f->GetName());
@@ -124,14 +130,22 @@ void TCFileManager::BuildFileList()
         // clean-up
         delete runs;
     }
+
+    // count bytes read
+    TCINSTR_COUNT(kINSTR_BYTES_READ, TFile::GetFileBytesRead() - bytes);
 }
 
 //______________________________________________________________________________
-TH1* TCFileManager::GetHistogram(const Char_t* name)
+TH1* TCFileManager::GetHistogram(const Char_t* name, Char_t** keys)
 {
-    // Get the summed-up histogram with name 'name'.
+    // Get the summed-up histogram with name 'name'. If 'keys' is non-zero the
+    // histograms are created from the key data read by ReadKeys() instead of
+    // reading them from the files.
     // NOTE: the histogram has to be destroyed by the caller.
 
+    TCINSTR_SCOPE("TCFileManager::GetHistogram");
+    Long64_t bytes = TFile::GetFileBytesRead();
+
     TH1* hOut = 0;
 
     // check if there are some runs
@@ -148,10 +162,15 @@ TH1* TCFileManager::GetHistogram(const Char_t* name)
     TIter next(fFiles);
     TFile* f;
     Bool_t first = kTRUE;
+    Int_t n = 0;
     while ((f = (TFile*)next()))
     {
-        // get histogram
-        TH1* h = (TH1*) f->Get(name);
+        // get histogram (from the key data if available)
+        TH1* h = 0;
+        TKey* key = keys && keys[n] ? f->GetKey(name) : 0;
+        if (key) h = (TH1*) key->ReadObjWithBuffer(keys[n]);
+        else h = (TH1*) f->Get(name);
+        n++;
 
         // check if histogram is there
         if (h)
@@ -168,7 +187,11 @@ TH1* TCFileManager::GetHistogram(const Char_t* name)
                     hOut = (TH1*) h->Clone();
                     first = kFALSE;
                 }
-                else hOut->Add(h);
+                else
+                {
+                    hOut->Add(h);
+                    TCINSTR_COUNT(kINSTR_HISTOS_SUMMED, 1);
+                }
             }
             else
             {
@@ -186,6 +209,139 @@ TH1* TCFileManager::GetHistogram(const Char_t* name)
         }
     } // loop over files
 
+    // count bytes read
+    TCINSTR_COUNT(kINSTR_BYTES_READ, TFile::GetFileBytesRead() - bytes);
+
     return hOut;
 }
 
+//______________________________________________________________________________
+Char_t** TCFileManager::ReadKeys(const Char_t* name)
+{
+    // Read the key data of the object 'name' of all files without creating
+    // the object. The data of the files are returned in the order of the
+    // file list (0 if the object was not found) and can be passed to
+    // GetHistogram().
+    // As no ROOT object is created, this method can be called by a worker
+    // thread as long as no other thread reads from the files at the same
+    // time.
+    // NOTE: the key data have to be destroyed via DeleteKeys().
+
+    TCINSTR_SCOPE("TCFileManager::ReadKeys");
+
+    // create the data array
+    Int_t nFiles = fFiles->GetSize();
+    Char_t** keys = new Char_t*[nFiles > 0 ? nFiles : 1];
+
+    // loop over files
+    TIter next(fFiles);
+    TFile* f;
+    Int_t n = 0;
+    while ((f = (TFile*)next()))
+    {
+        // read the key data
+        TKey* key = f->GetKey(name);
+        keys[n] = 0;
+        if (key)
+        {
+            keys[n] = new Char_t[key->GetNbytes()];
+            if (f->ReadBuffer(keys[n], key->GetSeekKey(), key->GetNbytes()))
+            {
+                delete [] keys[n];
+                keys[n] = 0;
+            }
+            else TCINSTR_COUNT(kINSTR_BYTES_READ, key->GetNbytes());
+        }
+        n++;
+    }
+
+    return keys;
+}
+
+//______________________________________________________________________________
+void TCFileManager::DeleteKeys(Char_t** keys) const
+{
+    // Destroy the key data 'keys' read by ReadKeys().
+
+    if (!keys) return;
+    for (Int_t i = 0; i < fFiles->GetSize(); i++)
+        if (keys[i]) delete [] keys[i];
+    delete [] keys;
+}
+
+//______________________________________________________________________________
+Int_t TCFileManager::GetHistograms(Int_t n, const Char_t* const* names, TH1** outHistos)
+{
+    // Get the summed-up histograms with the 'n' names 'names' in one pass over
+    // the files and save them to 'outHistos' (0 for missing histograms).
+    // Return the number of found histograms.
+    // NOTE: the histograms have to be destroyed by the caller.
+
+    TCINSTR_SCOPE("TCFileManager::GetHistograms");
+    Long64_t bytes = TFile::GetFileBytesRead();
+
+    // init output
+    for (Int_t i = 0; i < n; i++) outHistos[i] = 0;
+
+    // check if there are some runs
+    if (!fFiles->GetSize())
+    {
+        Error("GetHistograms", "ROOT file list is empty!");
+        return 0;
+    }
+
+    // do not keep histograms in memory
+    TH1::AddDirectory(kFALSE);
+
+    // loop over files
+    TIter next(fFiles);
+    TFile* f;
+    while ((f = (TFile*)next()))
+    {
+        // loop over histograms
+        for (Int_t i = 0; i < n; i++)
+        {
+            // get histogram
+            TH1* h = (TH1*) f->Get(names[i]);
+
+            // check if histogram is there
+            if (!h)
+            {
+                Warning("GetHistograms", "Histogram '%s' was not found in file '%s'",
+                                         names[i], f->GetName());
+                continue;
+            }
+
+            // correct destroying
+            h->ResetBit(kMustCleanup);
+
+            // check if object is really a histogram
+            if (!h->InheritsFrom("TH1"))
+            {
+                Error("GetHistograms", "Object '%s' found in file '%s' is not a histogram!",
+                                       names[i], f->GetName());
+                delete h;
+                continue;
+            }
+
+            // keep the first one, add the following ones
+            if (!outHistos[i]) outHistos[i] = h;
+            else
+            {
+                outHistos[i]->Add(h);
+                TCINSTR_COUNT(kINSTR_HISTOS_SUMMED, 1);
+                delete h;
+            }
+        }
+    } // loop over files
+
+    // count bytes read
+    TCINSTR_COUNT(kINSTR_BYTES_READ, TFile::GetFileBytesRead() - bytes);
+
+    // count found histograms
+    Int_t nFound = 0;
+    for (Int_t i = 0; i < n; i++)
+        if (outHistos[i]) nFound++;
+
+    return nFound;
+}
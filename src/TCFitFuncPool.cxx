@@ -0,0 +1,243 @@
+/*************************************************************************
+ * Author: Dominik Werthmueller
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TCFitFuncPool                                                        //
+//                                                                      //
+// Pool of compiled fit functions that are created once per module and  //
+// reset and reused for every element.                                  //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+
+#include "TF1.h"
+#include "TMath.h"
+#include "TROOT.h"
+#include "TList.h"
+
+#include "TCFitFuncPool.h"
+
+ClassImp(TCFitFuncPool)
+
+//______________________________________________________________________________
+TCFitFuncPool::TCFitFuncPool(const Char_t* name)
+    : fName(name)
+{
+    // Constructor. The functions are created on first use. Each pool is meant
+    // to be used by one module or one worker thread at a time.
+
+    // init members
+    for (Int_t i = 0; i < kNFitFuncType; i++) fFunc[i] = 0;
+}
+
+//______________________________________________________________________________
+TCFitFuncPool::~TCFitFuncPool()
+{
+    // Destructor.
+
+    for (Int_t i = 0; i < kNFitFuncType; i++)
+        if (fFunc[i]) delete fFunc[i];
+}
+
+//______________________________________________________________________________
+TF1* TCFitFuncPool::Create(FitFuncType_t type)
+{
+    // Create the compiled function of the type 'type'.
+
+    Char_t tmp[256];
+    TF1* f = 0;
+
+    switch (type)
+    {
+        case kGaus:
+            sprintf(tmp, "%s_Gaus", fName.Data());
+            f = new TF1(tmp, TCFitFuncPool::Gaus, 0, 1, 3);
+            break;
+        case kGausPol1:
+            sprintf(tmp, "%s_GausPol1", fName.Data());
+            f = new TF1(tmp, TCFitFuncPool::GausPol1, 0, 1, 5);
+            break;
+        case kGausPol3:
+            sprintf(tmp, "%s_GausPol3", fName.Data());
+            f = new TF1(tmp, TCFitFuncPool::GausPol3, 0, 1, 7);
+            break;
+        case kPol1Gaus:
+            sprintf(tmp, "%s_Pol1Gaus", fName.Data());
+            f = new TF1(tmp, TCFitFuncPool::Pol1Gaus, 0, 1, 5);
+            break;
+        case kWalkDefault:
+            sprintf(tmp, "%s_WalkDefault", fName.Data());
+            f = new TF1(tmp, TCFitFuncPool::WalkDefault, 0, 1, 4);
+            break;
+        case kWalkStrub:
+            sprintf(tmp, "%s_WalkStrub", fName.Data());
+            f = new TF1(tmp, TCFitFuncPool::WalkStrub, 0, 1, 4);
+            break;
+        default:
+            ::Error("TCFitFuncPool::Create", "Unknown fit function type %d!", (Int_t)type);
+            return 0;
+    }
+
+    // do not register in the global list of functions
+    gROOT->GetListOfFunctions()->Remove(f);
+
+    return f;
+}
+
+//______________________________________________________________________________
+TF1* TCFitFuncPool::Get(FitFuncType_t type)
+{
+    // Return the pooled function of the type 'type' with all parameters,
+    // errors, limits and the range reset. The function is owned by the pool.
+
+    // check type
+    if (type < 0 || type >= kNFitFuncType) return 0;
+
+    // create function on first use
+    if (!fFunc[type])
+    {
+        fFunc[type] = Create(type);
+        if (!fFunc[type]) return 0;
+    }
+
+    // reset function
+    TF1* f = fFunc[type];
+    for (Int_t i = 0; i < f->GetNpar(); i++)
+    {
+        f->ReleaseParameter(i);
+        f->SetParameter(i, 0);
+        f->SetParError(i, 0);
+    }
+    f->SetRange(0, 1);                  // default range of a new TF1
+    f->SetChisquare(0);
+    f->SetNDF(0);
+    f->SetNpx(100);
+    f->SetLineColor(1);
+
+    return f;
+}
+
+//______________________________________________________________________________
+TF1* TCFitFuncPool::Get(FitFuncType_t type, Double_t xmin, Double_t xmax)
+{
+    // Return the reset pooled function of the type 'type' with the range set
+    // to ['xmin', 'xmax'].
+
+    TF1* f = Get(type);
+    if (f) f->SetRange(xmin, xmax);
+
+    return f;
+}
+
+//______________________________________________________________________________
+Bool_t TCFitFuncPool::Owns(const TF1* f) const
+{
+    // Return kTRUE if the function 'f' belongs to this pool.
+
+    if (!f) return kFALSE;
+    for (Int_t i = 0; i < kNFitFuncType; i++)
+        if (fFunc[i] == f) return kTRUE;
+
+    return kFALSE;
+}
+
+//______________________________________________________________________________
+TCFitFuncPool::FitFuncType_t TCFitFuncPool::GetType(const TF1* f) const
+{
+    // Return the type of the pooled function 'f' or kNFitFuncType if the
+    // function does not belong to this pool.
+
+    if (!f) return kNFitFuncType;
+    for (Int_t i = 0; i < kNFitFuncType; i++)
+        if (fFunc[i] == f) return (FitFuncType_t) i;
+
+    return kNFitFuncType;
+}
+
+//______________________________________________________________________________
+Bool_t TCFitFuncPool::GetPeakLayout(FitFuncType_t type, Int_t* outGausPar,
+                                    Int_t* outBgPar, Int_t* outBgDeg)
+{
+    // Save the parameter layout of the peak function type 'type' to
+    // 'outGausPar' (index of the Gaussian constant), 'outBgPar' (index of the
+    // polynomial constant) and 'outBgDeg' (degree of the polynomial
+    // background, -1 if none). Return kFALSE if 'type' is not a peak function.
+
+    switch (type)
+    {
+        case kGaus:
+            *outGausPar = 0; *outBgPar = 0; *outBgDeg = -1;
+            return kTRUE;
+        case kGausPol1:
+            *outGausPar = 0; *outBgPar = 3; *outBgDeg = 1;
+            return kTRUE;
+        case kGausPol3:
+            *outGausPar = 0; *outBgPar = 3; *outBgDeg = 3;
+            return kTRUE;
+        case kPol1Gaus:
+            *outGausPar = 2; *outBgPar = 0; *outBgDeg = 1;
+            return kTRUE;
+        default:
+            return kFALSE;
+    }
+}
+
+//______________________________________________________________________________
+Double_t TCFitFuncPool::Gaus(Double_t* x, Double_t* par)
+{
+    // Gaussian (equivalent to "gaus(0)").
+    //
+    // par[0] : constant
+    // par[1] : mean
+    // par[2] : sigma
+
+    if (par[2] == 0) return 0;
+    Double_t arg = (x[0] - par[1]) / par[2];
+
+    return par[0]*TMath::Exp(-0.5*arg*arg);
+}
+
+//______________________________________________________________________________
+Double_t TCFitFuncPool::GausPol1(Double_t* x, Double_t* par)
+{
+    // Gaussian on a linear background (equivalent to "gaus(0)+pol1(3)").
+
+    return Gaus(x, par) + par[3] + par[4]*x[0];
+}
+
+//______________________________________________________________________________
+Double_t TCFitFuncPool::GausPol3(Double_t* x, Double_t* par)
+{
+    // Gaussian on a cubic background (equivalent to "gaus(0)+pol3(3)").
+
+    return Gaus(x, par) + par[3] + x[0]*(par[4] + x[0]*(par[5] + x[0]*par[6]));
+}
+
+//______________________________________________________________________________
+Double_t TCFitFuncPool::Pol1Gaus(Double_t* x, Double_t* par)
+{
+    // Linear background plus Gaussian (equivalent to "pol1(0)+gaus(2)").
+
+    return par[0] + par[1]*x[0] + Gaus(x, par+2);
+}
+
+//______________________________________________________________________________
+Double_t TCFitFuncPool::WalkDefault(Double_t* x, Double_t* par)
+{
+    // Default time walk function
+    // (equivalent to "[0] + [1] / TMath::Power(x + [2], [3])").
+
+    return par[0] + par[1] / TMath::Power(x[0] + par[2], par[3]);
+}
+
+//______________________________________________________________________________
+Double_t TCFitFuncPool::WalkStrub(Double_t* x, Double_t* par)
+{
+    // Strub time walk function
+    // (equivalent to "[0] + [1] / TMath::Power(x - 1, [3]) + x*[2]").
+
+    return par[0] + par[1] / TMath::Power(x[0] - 1, par[3]) + x[0]*par[2];
+}
+
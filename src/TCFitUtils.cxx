@@ -15,8 +15,10 @@
 #include "TH1.h"
 #include "TF1.h"
 #include "TRandom.h"
+#include "TMath.h"
 
 #include "TCFitUtils.h"
+#include "TCInstrument.h"
 
 
 //______________________________________________________________________________
@@ -108,3 +110,389 @@ void TCFitUtils::RandomizeParameters(TF1* f, Bool_t* isrand /*= 0*/)
     }
 }
 
+
+//______________________________________________________________________________
+static Double_t PeakModel(Double_t x, const Double_t* par, Int_t npar,
+                          Int_t gausPar, Int_t bgPar, Int_t bgDeg, Double_t* deriv)
+{
+    // Return the value of the Gaussian peak plus polynomial background model at
+    // 'x' using the parameters 'par'. If 'deriv' is non-zero, the derivatives
+    // with respect to all 'npar' parameters are saved there.
+
+    const Double_t* g = par + gausPar;
+    Double_t out = 0;
+
+    // init derivatives
+    if (deriv) for (Int_t i = 0; i < npar; i++) deriv[i] = 0;
+
+    // Gaussian
+    if (g[2] != 0)
+    {
+        Double_t u = (x - g[1]) / g[2];
+        Double_t e = TMath::Exp(-0.5*u*u);
+        out += g[0]*e;
+        if (deriv)
+        {
+            deriv[gausPar]   = e;
+            deriv[gausPar+1] = g[0]*e*u / g[2];
+            deriv[gausPar+2] = g[0]*e*u*u / g[2];
+        }
+    }
+
+    // polynomial background
+    Double_t xp = 1;
+    for (Int_t i = 0; i <= bgDeg; i++)
+    {
+        out += par[bgPar+i]*xp;
+        if (deriv) deriv[bgPar+i] = xp;
+        xp *= x;
+    }
+
+    return out;
+}
+
+//______________________________________________________________________________
+static Bool_t InvertMatrix(Double_t* a, Int_t n, Int_t dim)
+{
+    // Invert the 'n'x'n' matrix 'a' stored row-wise with the row length 'dim'
+    // in place using Gauss-Jordan elimination with partial pivoting.
+    // Return kFALSE if the matrix is singular.
+
+    const Int_t kMaxDim = 16;
+    Double_t inv[kMaxDim*kMaxDim];
+
+    // check dimension
+    if (n > kMaxDim) return kFALSE;
+
+    // init inverse with unit matrix
+    for (Int_t r = 0; r < n; r++)
+        for (Int_t c = 0; c < n; c++) inv[r*kMaxDim+c] = r == c ? 1 : 0;
+
+    // loop over columns
+    for (Int_t c = 0; c < n; c++)
+    {
+        // find pivot
+        Int_t piv = c;
+        for (Int_t r = c+1; r < n; r++)
+            if (TMath::Abs(a[r*dim+c]) > TMath::Abs(a[piv*dim+c])) piv = r;
+        if (a[piv*dim+c] == 0) return kFALSE;
+
+        // swap rows
+        if (piv != c)
+        {
+            for (Int_t k = 0; k < n; k++)
+            {
+                Double_t t = a[c*dim+k];
+                a[c*dim+k] = a[piv*dim+k];
+                a[piv*dim+k] = t;
+                t = inv[c*kMaxDim+k];
+                inv[c*kMaxDim+k] = inv[piv*kMaxDim+k];
+                inv[piv*kMaxDim+k] = t;
+            }
+        }
+
+        // normalize pivot row
+        Double_t d = 1. / a[c*dim+c];
+        for (Int_t k = 0; k < n; k++)
+        {
+            a[c*dim+k] *= d;
+            inv[c*kMaxDim+k] *= d;
+        }
+
+        // eliminate column in other rows
+        for (Int_t r = 0; r < n; r++)
+        {
+            if (r == c) continue;
+            Double_t fac = a[r*dim+c];
+            if (fac == 0) continue;
+            for (Int_t k = 0; k < n; k++)
+            {
+                a[r*dim+k] -= fac*a[c*dim+k];
+                inv[r*kMaxDim+k] -= fac*inv[c*kMaxDim+k];
+            }
+        }
+    }
+
+    // copy inverse
+    for (Int_t r = 0; r < n; r++)
+        for (Int_t c = 0; c < n; c++) a[r*dim+c] = inv[r*kMaxDim+c];
+
+    return kTRUE;
+}
+
+//______________________________________________________________________________
+Int_t TCFitUtils::FitPeak(TH1* h, TF1* f, Int_t gausPar, Int_t bgPar, Int_t bgDeg,
+                          Int_t maxIter /*= 100*/)
+{
+    // Fast chi square fit of a Gaussian peak on a polynomial background to the
+    // histogram 'h' using a Levenberg-Marquardt minimization with analytic
+    // derivatives. This is an alternative to h->Fit(f, "RBQ0") for peak
+    // functions like "gaus", "gaus(0)+pol1(3)" or "pol1(0)+gaus(2)".
+    //
+    // The Gaussian constant, mean and sigma are expected at the parameter
+    // indices 'gausPar' to 'gausPar'+2 of the function 'f', the 'bgDeg'+1
+    // coefficients of the polynomial background (none if 'bgDeg' is -1) at
+    // 'bgPar' onwards. Start values, parameter limits, fixed parameters and
+    // the fit range are taken from 'f', the results are saved to 'f'.
+    //
+    // Return 0 on success like TH1::Fit().
+
+    const Int_t kMaxPar = 8;
+
+    // check input
+    if (!h || !f) return -1;
+    Int_t npar = f->GetNpar();
+    if (npar > kMaxPar) return -1;
+
+    // get parameters and limits
+    Double_t par[kMaxPar];
+    Double_t err[kMaxPar];
+    Double_t lo[kMaxPar];
+    Double_t hi[kMaxPar];
+    for (Int_t i = 0; i < npar; i++)
+    {
+        par[i] = f->GetParameter(i);
+        f->GetParLimits(i, lo[i], hi[i]);
+    }
+
+    // read the bins in the fit range into contiguous arrays
+    Double_t xmin, xmax;
+    f->GetRange(xmin, xmax);
+    Int_t first = TMath::Max(1, h->GetXaxis()->FindFixBin(xmin));
+    Int_t last = TMath::Min(h->GetNbinsX(), h->GetXaxis()->FindFixBin(xmax));
+    Int_t nmax = TMath::Max(0, last - first + 1);
+    Double_t* x = new Double_t[nmax];
+    Double_t* y = new Double_t[nmax];
+    Double_t* w = new Double_t[nmax];
+    Int_t n = 0;
+    for (Int_t i = first; i <= last; i++)
+    {
+        // skip bins outside the range and empty bins
+        Double_t xc = h->GetXaxis()->GetBinCenter(i);
+        if (xc < xmin || xc > xmax) continue;
+        Double_t e = h->GetBinError(i);
+        if (e <= 0) continue;
+
+        x[n] = xc;
+        y[n] = h->GetBinContent(i);
+        w[n] = 1. / (e*e);
+        n++;
+    }
+
+    // fit
+    Double_t chi2;
+    Int_t ndf;
+    Int_t res = FitPeak(n, x, y, w, npar, par, err, lo, hi,
+                        gausPar, bgPar, bgDeg, &chi2, &ndf, maxIter);
+
+    // save results
+    if (res == 0 || res == 4)
+    {
+        f->SetParameters(par);
+        f->SetParErrors(err);
+        f->SetChisquare(chi2);
+        f->SetNDF(ndf);
+        f->SetNumberFitPoints(n);
+    }
+
+    // clean-up
+    delete [] x;
+    delete [] y;
+    delete [] w;
+
+    return res;
+}
+
+//______________________________________________________________________________
+Int_t TCFitUtils::FitPeak(Int_t n, const Double_t* x, const Double_t* y, const Double_t* w,
+                          Int_t npar, Double_t* par, Double_t* err,
+                          const Double_t* parMin, const Double_t* parMax,
+                          Int_t gausPar, Int_t bgPar, Int_t bgDeg,
+                          Double_t* outChi2, Int_t* outNDF, Int_t maxIter /*= 100*/)
+{
+    // Fast chi square fit of a Gaussian peak on a polynomial background to the
+    // 'n' data points 'x', 'y' with the weights 'w' (1/error^2). This version
+    // works without ROOT objects and can be called from worker threads.
+    //
+    // See FitPeak(TH1*, TF1*, ...) for the parameter layout. 'par' contains
+    // the 'npar' start values and receives the results, 'err' the errors.
+    // 'parMin' and 'parMax' follow the conventions of TF1::GetParLimits()
+    // (fixed if min >= max unless both are 0). The chi square and the number
+    // of degrees of freedom are saved to 'outChi2' and 'outNDF' if non-zero.
+    //
+    // Return 0 on success, 4 if the minimization did not converge, 1 if there
+    // are too few data points and -1 for bad input.
+
+    const Int_t kMaxPar = 8;
+
+    // check input
+    if (npar > kMaxPar || gausPar+2 >= npar || bgPar+bgDeg >= npar) return -1;
+
+    // get free parameters
+    Double_t lo[kMaxPar];
+    Double_t hi[kMaxPar];
+    Int_t ifree[kMaxPar];
+    Int_t nfree = 0;
+    for (Int_t i = 0; i < npar; i++)
+    {
+        lo[i] = parMin[i];
+        hi[i] = parMax[i];
+        err[i] = 0;
+
+        // check for fixed parameter (see TF1::FixParameter())
+        if (lo[i] >= hi[i] && (lo[i] != 0 || hi[i] != 0)) continue;
+
+        // apply limits to start value
+        if (lo[i] < hi[i]) par[i] = TMath::Max(lo[i], TMath::Min(hi[i], par[i]));
+        ifree[nfree++] = i;
+    }
+
+    // check degrees of freedom
+    if (n <= nfree || nfree == 0) return 1;
+
+    // solve for the start values of the free linear parameters (Gaussian
+    // constant and background coefficients) with fixed peak shape
+    Int_t lin[kMaxPar];
+    Int_t nlin = 0;
+    for (Int_t k = 0; k < nfree; k++)
+        if (ifree[k] != gausPar+1 && ifree[k] != gausPar+2) lin[nlin++] = ifree[k];
+    if (nlin)
+    {
+        Double_t m[kMaxPar*kMaxPar];
+        Double_t v[kMaxPar];
+        Double_t d[kMaxPar];
+        Double_t par_lin[kMaxPar];
+        for (Int_t k = 0; k < npar; k++) par_lin[k] = par[k];
+        for (Int_t k = 0; k < nlin; k++) par_lin[lin[k]] = 0;
+        for (Int_t k = 0; k < nlin*kMaxPar; k++) m[k] = 0;
+        for (Int_t k = 0; k < nlin; k++) v[k] = 0;
+        for (Int_t i = 0; i < n; i++)
+        {
+            // residual of the fixed part and basis functions of the linear part
+            Double_t r = y[i] - PeakModel(x[i], par_lin, npar, gausPar, bgPar, bgDeg, d);
+            for (Int_t k = 0; k < nlin; k++)
+            {
+                v[k] += w[i]*d[lin[k]]*r;
+                for (Int_t l = 0; l < nlin; l++) m[k*kMaxPar+l] += w[i]*d[lin[k]]*d[lin[l]];
+            }
+        }
+        if (InvertMatrix(m, nlin, kMaxPar))
+        {
+            for (Int_t k = 0; k < nlin; k++)
+            {
+                Int_t p = lin[k];
+                Double_t val = 0;
+                for (Int_t l = 0; l < nlin; l++) val += m[k*kMaxPar+l]*v[l];
+                if (lo[p] < hi[p]) val = TMath::Max(lo[p], TMath::Min(hi[p], val));
+                par[p] = val;
+            }
+        }
+    }
+
+    // calculate the start chi square
+    Double_t chi2 = 0;
+    for (Int_t i = 0; i < n; i++)
+    {
+        Double_t r = y[i] - PeakModel(x[i], par, npar, gausPar, bgPar, bgDeg, 0);
+        chi2 += w[i]*r*r;
+    }
+
+    // minimization
+    Double_t lambda = 1e-3;
+    Double_t alpha[kMaxPar*kMaxPar];
+    Double_t beta[kMaxPar];
+    Double_t a[kMaxPar*kMaxPar];
+    Double_t deriv[kMaxPar];
+    Double_t par_new[kMaxPar];
+    Bool_t converged = kFALSE;
+    Int_t nIter = 0;
+    for (Int_t iter = 0; iter < maxIter && !converged; iter++, nIter++)
+    {
+        // build curvature matrix and gradient
+        for (Int_t k = 0; k < nfree*kMaxPar; k++) alpha[k] = 0;
+        for (Int_t k = 0; k < nfree; k++) beta[k] = 0;
+        for (Int_t i = 0; i < n; i++)
+        {
+            Double_t r = y[i] - PeakModel(x[i], par, npar, gausPar, bgPar, bgDeg, deriv);
+            for (Int_t k = 0; k < nfree; k++)
+            {
+                Double_t wd = w[i]*deriv[ifree[k]];
+                beta[k] += wd*r;
+                for (Int_t l = 0; l <= k; l++) alpha[k*kMaxPar+l] += wd*deriv[ifree[l]];
+            }
+        }
+        for (Int_t k = 0; k < nfree; k++)
+            for (Int_t l = 0; l < k; l++) alpha[l*kMaxPar+k] = alpha[k*kMaxPar+l];
+
+        // try steps with increasing damping
+        for (;;)
+        {
+            // damped curvature matrix
+            for (Int_t k = 0; k < nfree*kMaxPar; k++) a[k] = alpha[k];
+            for (Int_t k = 0; k < nfree; k++)
+                a[k*kMaxPar+k] = alpha[k*kMaxPar+k]*(1. + lambda) + 1e-300;
+
+            // calculate new parameters
+            if (!InvertMatrix(a, nfree, kMaxPar))
+            {
+                lambda *= 10;
+                if (lambda > 1e10) { converged = kTRUE; break; }
+                continue;
+            }
+            for (Int_t k = 0; k < npar; k++) par_new[k] = par[k];
+            for (Int_t k = 0; k < nfree; k++)
+            {
+                Int_t p = ifree[k];
+                for (Int_t l = 0; l < nfree; l++) par_new[p] += a[k*kMaxPar+l]*beta[l];
+                if (lo[p] < hi[p]) par_new[p] = TMath::Max(lo[p], TMath::Min(hi[p], par_new[p]));
+            }
+
+            // calculate new chi square
+            Double_t chi2_new = 0;
+            for (Int_t i = 0; i < n; i++)
+            {
+                Double_t r = y[i] - PeakModel(x[i], par_new, npar, gausPar, bgPar, bgDeg, 0);
+                chi2_new += w[i]*r*r;
+            }
+
+            // accept step
+            if (chi2_new <= chi2)
+            {
+                if (chi2 - chi2_new < 1e-8*chi2 + 1e-12) converged = kTRUE;
+                for (Int_t k = 0; k < npar; k++) par[k] = par_new[k];
+                chi2 = chi2_new;
+                lambda = TMath::Max(lambda*0.1, 1e-12);
+                break;
+            }
+
+            // reject step
+            lambda *= 10;
+            if (lambda > 1e10) { converged = kTRUE; break; }
+        }
+    }
+
+    // calculate parameter errors from the undamped curvature matrix
+    for (Int_t k = 0; k < nfree*kMaxPar; k++) alpha[k] = 0;
+    for (Int_t i = 0; i < n; i++)
+    {
+        PeakModel(x[i], par, npar, gausPar, bgPar, bgDeg, deriv);
+        for (Int_t k = 0; k < nfree; k++)
+            for (Int_t l = 0; l < nfree; l++)
+                alpha[k*kMaxPar+l] += w[i]*deriv[ifree[k]]*deriv[ifree[l]];
+    }
+    if (InvertMatrix(alpha, nfree, kMaxPar))
+    {
+        for (Int_t k = 0; k < nfree; k++)
+            err[ifree[k]] = TMath::Sqrt(TMath::Abs(alpha[k*kMaxPar+k]));
+    }
+
+    // save results
+    if (outChi2) *outChi2 = chi2;
+    if (outNDF) *outNDF = n - nfree;
+
+    // count fit
+    TCINSTR_COUNT(kINSTR_FITS, 1);
+    TCINSTR_COUNT(kINSTR_FIT_ITERATIONS, nIter);
+
+    return converged ? 0 : 4;
+}
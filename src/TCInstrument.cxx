@@ -0,0 +1,274 @@
+/*************************************************************************
+ * Author: Dominik Werthmueller
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TCInstrument                                                         //
+//                                                                      //
+// CaLib timing and counter instrumentation namespace.                  //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <unistd.h>
+
+#include "TString.h"
+#include "TDatime.h"
+#include "TMutex.h"
+#include "TError.h"
+
+#include "TCInstrument.h"
+
+// maximum number of timed stages
+static const Int_t gInstrMaxStage = 128;
+
+// counter names
+static const Char_t* gInstrCounterName[kINSTR_NCOUNTER] =
+{
+    "queries",
+    "rows_fetched",
+    "bytes_read",
+    "files_opened",
+    "histograms_summed",
+    "fits",
+    "fit_iterations"
+};
+
+// instrumentation state
+Bool_t TCInstrument::gEnabled = kFALSE;
+static Long64_t gInstrCounter[kINSTR_NCOUNTER];
+static TString gInstrStageName[gInstrMaxStage];
+static Long64_t gInstrStageCalls[gInstrMaxStage];
+static Long64_t gInstrStageTime[gInstrMaxStage];
+static Int_t gInstrNStage = 0;
+static TString gInstrReportFile;
+static Long64_t gInstrStart = 0;
+static Bool_t gInstrExitHandler = kFALSE;
+
+//______________________________________________________________________________
+static TMutex* GetInstrMutex()
+{
+    // Return the mutex of the stage registry. The mutex is created on the
+    // first use to be independent of the static initialization order.
+
+    static TMutex* mutex = new TMutex();
+    return mutex;
+}
+
+//______________________________________________________________________________
+static void WriteInstrReportAtExit()
+{
+    // Write the report file at the program exit if the instrumentation is
+    // still enabled.
+
+    if (TCInstrument::gEnabled && gInstrReportFile.Length())
+        TCInstrument::WriteReport(gInstrReportFile.Data());
+}
+
+//______________________________________________________________________________
+void TCInstrument::Enable(const Char_t* reportFile)
+{
+    // Enable the instrumentation. If 'reportFile' is non-zero the report is
+    // written to this file at the program exit (see WriteReport()). The
+    // placeholder 'PID' in the file name is replaced by the process id.
+
+    // set the report file
+    if (reportFile && reportFile[0])
+    {
+        gInstrReportFile = reportFile;
+        gInstrReportFile.ReplaceAll("PID", TString::Format("%d", (Int_t)getpid()));
+
+        // register the exit handler once
+        if (!gInstrExitHandler)
+        {
+            atexit(WriteInstrReportAtExit);
+            gInstrExitHandler = kTRUE;
+        }
+    }
+
+    // enable
+    if (!gInstrStart) gInstrStart = GetTime();
+    gEnabled = kTRUE;
+}
+
+//______________________________________________________________________________
+void TCInstrument::Disable()
+{
+    // Disable the instrumentation. The collected values are kept.
+
+    gEnabled = kFALSE;
+}
+
+//______________________________________________________________________________
+void TCInstrument::Reset()
+{
+    // Reset all counters and stage timers.
+
+    GetInstrMutex()->Lock();
+    for (Int_t i = 0; i < kINSTR_NCOUNTER; i++) gInstrCounter[i] = 0;
+    for (Int_t i = 0; i < gInstrNStage; i++) gInstrStageCalls[i] = gInstrStageTime[i] = 0;
+    gInstrStart = GetTime();
+    GetInstrMutex()->UnLock();
+}
+
+//______________________________________________________________________________
+void TCInstrument::Count(InstrCounter_t c, Long64_t n)
+{
+    // Add 'n' to the counter 'c'. This method is thread-safe.
+
+    __sync_fetch_and_add(&gInstrCounter[c], n);
+}
+
+//______________________________________________________________________________
+Int_t TCInstrument::GetStageID(const Char_t* name)
+{
+    // Return the id of the timed stage 'name'. The stage is registered if it
+    // does not exist yet. Return -1 if the maximum number of stages is
+    // exceeded. This method is thread-safe.
+
+    Int_t id = -1;
+
+    GetInstrMutex()->Lock();
+
+    // search stage
+    for (Int_t i = 0; i < gInstrNStage; i++)
+    {
+        if (gInstrStageName[i] == name)
+        {
+            id = i;
+            break;
+        }
+    }
+
+    // register stage
+    if (id < 0 && gInstrNStage < gInstrMaxStage)
+    {
+        id = gInstrNStage;
+        gInstrStageName[id] = name;
+        gInstrStageCalls[id] = 0;
+        gInstrStageTime[id] = 0;
+        gInstrNStage++;
+    }
+
+    GetInstrMutex()->UnLock();
+
+    return id;
+}
+
+//______________________________________________________________________________
+void TCInstrument::AddStageTime(Int_t id, Long64_t nsec)
+{
+    // Add one call taking 'nsec' nanoseconds to the timed stage 'id'.
+    // This method is thread-safe.
+
+    if (id < 0 || id >= gInstrMaxStage) return;
+    __sync_fetch_and_add(&gInstrStageCalls[id], (Long64_t)1);
+    __sync_fetch_and_add(&gInstrStageTime[id], nsec);
+}
+
+//______________________________________________________________________________
+Long64_t TCInstrument::GetTime()
+{
+    // Return the time of a monotonic clock in nanoseconds.
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (Long64_t)ts.tv_sec*1000000000LL + ts.tv_nsec;
+}
+
+//______________________________________________________________________________
+Long64_t TCInstrument::GetCounter(InstrCounter_t c)
+{
+    // Return the value of the counter 'c'.
+
+    return gInstrCounter[c];
+}
+
+//______________________________________________________________________________
+const Char_t* TCInstrument::GetCounterName(InstrCounter_t c)
+{
+    // Return the name of the counter 'c'.
+
+    return gInstrCounterName[c];
+}
+
+//______________________________________________________________________________
+void TCInstrument::Print()
+{
+    // Print the counters and the timed stages.
+
+    printf("Instrumentation report (%.3f s)\n", (GetTime() - gInstrStart) / 1e9);
+    printf("Counters:\n");
+    for (Int_t i = 0; i < kINSTR_NCOUNTER; i++)
+        printf("  %-20s : %lld\n", gInstrCounterName[i], gInstrCounter[i]);
+    printf("Stages:\n");
+    for (Int_t i = 0; i < gInstrNStage; i++)
+    {
+        if (!gInstrStageCalls[i]) continue;
+        printf("  %-40s : %10lld calls  %12.3f ms  %10.3f ms/call\n",
+               gInstrStageName[i].Data(), gInstrStageCalls[i], gInstrStageTime[i] / 1e6,
+               gInstrStageTime[i] / 1e6 / gInstrStageCalls[i]);
+    }
+}
+
+//______________________________________________________________________________
+Bool_t TCInstrument::WriteReport(const Char_t* filename)
+{
+    // Write the counters and the timed stages to the file 'filename'. The
+    // report is written in the CSV format if the file name ends with '.csv',
+    // otherwise in the JSON format.
+    // Return kFALSE if an error occurred, otherwise kTRUE.
+
+    // open the file
+    FILE* fout = fopen(filename, "w");
+    if (!fout)
+    {
+        Error("TCInstrument::WriteReport", "Could not open the report file '%s'!", filename);
+        return kFALSE;
+    }
+
+    TDatime now;
+    Double_t wall = (GetTime() - gInstrStart) / 1e9;
+
+    // write CSV
+    if (TString(filename).EndsWith(".csv"))
+    {
+        fprintf(fout, "type,name,calls,value,time_ms\n");
+        fprintf(fout, "run,%s,0,0,%.3f\n", now.AsSQLString(), wall*1e3);
+        for (Int_t i = 0; i < kINSTR_NCOUNTER; i++)
+            fprintf(fout, "counter,%s,0,%lld,0\n", gInstrCounterName[i], gInstrCounter[i]);
+        for (Int_t i = 0; i < gInstrNStage; i++)
+            fprintf(fout, "stage,%s,%lld,0,%.3f\n", gInstrStageName[i].Data(),
+                    gInstrStageCalls[i], gInstrStageTime[i] / 1e6);
+    }
+    // write JSON
+    else
+    {
+        fprintf(fout, "{\n");
+        fprintf(fout, "  \"date\": \"%s\",\n", now.AsSQLString());
+        fprintf(fout, "  \"pid\": %d,\n", (Int_t)getpid());
+        fprintf(fout, "  \"wall_time_s\": %.3f,\n", wall);
+        fprintf(fout, "  \"counters\": {\n");
+        for (Int_t i = 0; i < kINSTR_NCOUNTER; i++)
+            fprintf(fout, "    \"%s\": %lld%s\n", gInstrCounterName[i], gInstrCounter[i],
+                    i < kINSTR_NCOUNTER-1 ? "," : "");
+        fprintf(fout, "  },\n");
+        fprintf(fout, "  \"stages\": [\n");
+        for (Int_t i = 0; i < gInstrNStage; i++)
+            fprintf(fout, "    { \"name\": \"%s\", \"calls\": %lld, \"time_ms\": %.3f }%s\n",
+                    gInstrStageName[i].Data(), gInstrStageCalls[i], gInstrStageTime[i] / 1e6,
+                    i < gInstrNStage-1 ? "," : "");
+        fprintf(fout, "  ]\n");
+        fprintf(fout, "}\n");
+    }
+
+    fclose(fout);
+
+    return kTRUE;
+}
+
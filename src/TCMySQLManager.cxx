@@ -19,9 +19,12 @@
 #include "TSQLServer.h"
 #include "TSQLRow.h"
 #include "TSQLResult.h"
+#include "TSQLStatement.h"
 #include "TObjArray.h"
 #include "TObjString.h"
 #include "TFile.h"
+#include "TMath.h"
+#include "TThread.h"
 
 #include "TCMySQLManager.h"
 #include "TCReadConfig.h"
@@ -32,6 +35,9 @@
 #include "TCCalibType.h"
 #include "TCBadScRElement.h"
 #include "TCContainer.h"
+#include "TCDataQueue.h"
+#include "TCInstrument.h"
+#include "TCQueryLog.h"
 
 ClassImp(TCMySQLManager)
 
@@ -65,6 +71,10 @@ TCMySQLManager::TCMySQLManager()
         return;
     }
 
+    // enable the statement recording
+    Int_t hLog = TCReadConfig::GetReader()->GetHandle("DB.QueryLog", kConfigInt);
+    if (TCReadConfig::GetReader()->IsSet(hLog)) TCQueryLog::Enable(TCReadConfig::GetReader()->GetInt(hLog));
+
     //
     // get database configuration
     //
@@ -165,6 +175,36 @@ TCMySQLManager::TCMySQLManager()
     }
 }
 
+//______________________________________________________________________________
+TCMySQLManager::TCMySQLManager(TSQLServer* db, ServerType_t type)
+{
+    // Constructor using the open database connection 'db' of the type 'type'
+    // instead of the configured database. The connection is owned by the
+    // manager.
+
+    fDB = db;
+    fDBType = type;
+    fSilence = kFALSE;
+    fData = new THashList();
+    fData->SetOwner(kTRUE);
+    fTypes = new THashList();
+    fTypes->SetOwner(kTRUE);
+
+    // read CaLib data
+    if (!ReadCaLibData())
+    {
+        if (!fSilence) Error("TCMySQLManager", "Could not read the CaLib data definitions!");
+        return;
+    }
+
+    // read CaLib types
+    if (!ReadCaLibTypes())
+    {
+        if (!fSilence) Error("TCMySQLManager", "Could not read the CaLib type definitions!");
+        return;
+    }
+}
+
 //______________________________________________________________________________
 TCMySQLManager::~TCMySQLManager()
 {
@@ -402,8 +442,24 @@ TSQLResult* TCMySQLManager::SendQuery(const Char_t* query)
         return 0;
     }
 
+    TCINSTR_SCOPE("TCMySQLManager::SendQuery");
+    TCINSTR_COUNT(kINSTR_QUERIES, 1);
+
     // execute query
-    return fDB->Query(query);
+    Bool_t log = TCQueryLog::IsEnabled();
+    Long64_t start = log ? TCInstrument::GetTime() : 0;
+    TSQLResult* res = fDB->Query(query);
+
+    // record the statement and the calling function
+    if (log)
+        TCQueryLog::GetLog()->Record(query, TCInstrument::GetTime() - start,
+                                     res ? res->GetRowCount() : -1, __builtin_return_address(0));
+
+    // count the rows (not known in advance for all servers)
+    if (res && TCInstrument::IsEnabled() && res->GetRowCount() > 0)
+        TCInstrument::Count(kINSTR_ROWS, res->GetRowCount());
+
+    return res;
 }
 
 //______________________________________________________________________________
@@ -484,8 +540,20 @@ Bool_t TCMySQLManager::SendExec(const Char_t* sql)
         return kFALSE;
     }
 
+    TCINSTR_SCOPE("TCMySQLManager::SendExec");
+    TCINSTR_COUNT(kINSTR_QUERIES, 1);
+
     // execute command
-    return fDB->Exec(sql);
+    Bool_t log = TCQueryLog::IsEnabled();
+    Long64_t start = log ? TCInstrument::GetTime() : 0;
+    Bool_t ret = fDB->Exec(sql);
+
+    // record the statement and the calling function
+    if (log)
+        TCQueryLog::GetLog()->Record(sql, TCInstrument::GetTime() - start, -1,
+                                     __builtin_return_address(0));
+
+    return ret;
 }
 
 //______________________________________________________________________________
@@ -840,6 +908,179 @@ void TCMySQLManager::GetChangeTimeOfSet(const Char_t* data, const Char_t* calibr
     }
 }
 
+//______________________________________________________________________________
+TString TCMySQLManager::GetLastChange()
+{
+    // Return the timestamp of the last change of the run information or of
+    // any set of any calibration data (format 'YYYY-MM-DD HH:MM:SS').
+    // An empty string is returned if the database is empty or an error
+    // occurred.
+    // NOTE: Deleted sets are not taken into account.
+
+    // create the query over all tables (single round trip)
+    TString query = TString::Format("SELECT MAX(c) FROM ( SELECT MAX(changed) AS c FROM %s",
+                                    TCConfig::kCalibMainTableName);
+    TIter next(fData);
+    TCCalibData* d;
+    while ((d = (TCCalibData*)next()))
+        query.Append(TString::Format(" UNION ALL SELECT MAX(changed) AS c FROM %s", d->GetTableName()));
+    query.Append(" ) AS last_change");
+
+    // read from database
+    TSQLResult* res = SendQuery(query.Data());
+    if (!res)
+    {
+        if (!fSilence) Error("GetLastChange", "Could not read the last change!");
+        return "";
+    }
+
+    // get the timestamp
+    TString last;
+    TSQLRow* row = res->Next();
+    if (row && row->GetField(0)) last = row->GetField(0);
+
+    // clean-up
+    if (row) delete row;
+    delete res;
+
+    return last;
+}
+
+//______________________________________________________________________________
+Bool_t TCMySQLManager::HasChanged(const Char_t* since)
+{
+    // Return kTRUE if the run information or any set of any calibration data
+    // was changed after the timestamp 'since' (format 'YYYY-MM-DD HH:MM:SS',
+    // e.g. the value of GetLastChange() at the time of the last check).
+    // NOTE: The timestamps have a resolution of one second, i.e., changes
+    //       within the second of 'since' are not detected. Deleted sets are
+    //       not detected.
+
+    // no reference time
+    if (!since || !since[0]) return kTRUE;
+
+    // compare to last change
+    TString last = GetLastChange();
+
+    return last.CompareTo(since) > 0;
+}
+
+//______________________________________________________________________________
+Int_t* TCMySQLManager::GetChangedRuns(const Char_t* since, Int_t* outNruns)
+{
+    // Return the list of runs whose information (including the bad scaler
+    // reads) was changed at or after the timestamp 'since' (format
+    // 'YYYY-MM-DD HH:MM:SS'), ordered by the time of the change.
+    // If 'outNruns' is not zero the number of runs will be written to this variable.
+    // NOTE: the run array must be destroyed by the caller.
+
+    // create the query
+    TString query = TString::Format("SELECT run FROM %s "
+                                    "WHERE changed >= '%s' "
+                                    "ORDER by changed,run",
+                                    TCConfig::kCalibMainTableName, since);
+
+    // read from database
+    TSQLResult* res = SendQuery(query.Data());
+    if (!res)
+    {
+        if (!fSilence) Error("GetChangedRuns", "Could not read the changed runs!");
+        if (outNruns) *outNruns = 0;
+        return 0;
+    }
+
+    // create list for run numbers
+    TList run_numbers;
+    run_numbers.SetOwner(kTRUE);
+
+    // read all rows/runs
+    TSQLRow* r = res->Next();
+    while (r)
+    {
+        run_numbers.Add(new TObjString(r->GetField(0)));
+        delete r;
+        r = res->Next();
+    }
+
+    // create run array
+    Int_t nruns = run_numbers.GetSize();
+    Int_t* runs = new Int_t[nruns];
+
+    // read all runs
+    TIter next(&run_numbers);
+    TObjString* rn;
+    Int_t n = 0;
+    while ((rn = (TObjString*)next())) runs[n++] = atoi(rn->GetString().Data());
+
+    // clean-up
+    delete res;
+
+    // write number of runs
+    if (outNruns) *outNruns = nruns;
+
+    return runs;
+}
+
+//______________________________________________________________________________
+TList* TCMySQLManager::GetChangedSets(const Char_t* since, const Char_t* calibration)
+{
+    // Return the list of sets of all calibration data that were changed at or
+    // after the timestamp 'since' (format 'YYYY-MM-DD HH:MM:SS'), ordered by
+    // the time of the change. If 'calibration' is non-zero only sets of the
+    // calibration identifier 'calibration' are returned.
+    // The sets are returned as TCCalibration objects without parameters.
+    // Return 0 if an error occurred.
+    // NOTE: the list must be destroyed by the caller. Deleted sets are not
+    //       contained.
+
+    // create the query over all data tables (single round trip)
+    TString query;
+    TIter next(fData);
+    TCCalibData* d;
+    while ((d = (TCCalibData*)next()))
+    {
+        if (query.Length()) query.Append(" UNION ALL ");
+        query.Append(TString::Format("SELECT '%s' AS data, calibration, description, "
+                                     "first_run, last_run, changed FROM %s "
+                                     "WHERE changed >= '%s'",
+                                     d->GetName(), d->GetTableName(), since));
+        if (calibration) query.Append(TString::Format(" AND calibration = '%s'", calibration));
+    }
+    query.Append(" ORDER by changed,data,first_run");
+
+    // read from database
+    TSQLResult* res = SendQuery(query.Data());
+    if (!res)
+    {
+        if (!fSilence) Error("GetChangedSets", "Could not read the changed sets!");
+        return 0;
+    }
+
+    // create the list
+    TList* list = new TList();
+    list->SetOwner(kTRUE);
+
+    // read all sets
+    TSQLRow* r;
+    while ((r = res->Next()))
+    {
+        TCCalibration* c = new TCCalibration();
+        c->SetCalibData(r->GetField(0));
+        c->SetCalibration(r->GetField(1) ? r->GetField(1) : "");
+        c->SetDescription(r->GetField(2) ? r->GetField(2) : "");
+        c->SetFirstRun(atoi(r->GetField(3)));
+        c->SetLastRun(atoi(r->GetField(4)));
+        c->SetChangeTime(r->GetField(5));
+        list->Add(c);
+        delete r;
+    }
+
+    // clean-up
+    delete res;
+
+    return list;
+}
+
 //______________________________________________________________________________
 Int_t* TCMySQLManager::GetRunsOfCalibration(const Char_t* calibration, Int_t* outNruns)
 {
@@ -1103,7 +1344,21 @@ Bool_t TCMySQLManager::ReadParameters(const Char_t* data, const Char_t* calibrat
         return kFALSE;
     }
 
-    for (Int_t i = 0; i < length; i++) par[i] = atof(row->GetField(i+5));
+    // read parameters
+    for (Int_t i = 0; i < length; i++)
+    {
+        // check parameter
+        const Char_t* v = i+5 < res->GetFieldCount() ? row->GetField(i+5) : 0;
+        if (!v)
+        {
+            if (!fSilence) Error("ReadParameters", "Could not read parameter %d of set %d of '%s'!",
+                                 i, set, d->GetTitle());
+            delete row;
+            delete res;
+            return kFALSE;
+        }
+        par[i] = atof(v);
+    }
 
     // clean-up
     delete row;
@@ -1116,6 +1371,116 @@ Bool_t TCMySQLManager::ReadParameters(const Char_t* data, const Char_t* calibrat
     return kTRUE;
 }
 
+//______________________________________________________________________________
+Int_t TCMySQLManager::ReadSets(const Char_t* data, const Char_t* calibration,
+                               Int_t*& outFirst, Int_t*& outLast, Double_t*& outPar, Int_t length)
+{
+    // Read the first and last runs and 'length' parameters of all sets of the
+    // calibration data 'data' for the calibration identifier 'calibration'
+    // using one query. The arrays 'outFirst', 'outLast' and 'outPar' (set
+    // 'i' at 'i*length') are created and must be destroyed by the caller.
+    // Return the number of sets or -1 if an error occurred.
+
+    TString query;
+    Char_t table[256];
+
+    // init results
+    outFirst = 0;
+    outLast = 0;
+    outPar = 0;
+
+    // get data
+    TCCalibData* d = GetCalibData(data);
+    if (!d) return -1;
+
+    // get the data table
+    if (!SearchTable(data, table))
+    {
+        if (!fSilence) Error("ReadSets", "No data table found!");
+        return -1;
+    }
+
+    // create the query
+    query.Form("SELECT * FROM %s WHERE "
+               "calibration = '%s' "
+               "ORDER BY first_run ASC",
+               table, calibration);
+
+    // read from database
+    TSQLResult* res = SendQuery(query.Data());
+
+    // check result
+    if (!res)
+    {
+        if (!fSilence) Error("ReadSets", "No runsets found in table '%s'!", table);
+        return -1;
+    }
+
+    // read rows (parameters start at field 5, the row count is not known
+    // in SQLite)
+    Int_t nsets = 0;
+    Int_t size = 0;
+    TSQLRow* row;
+    while ((row = res->Next()))
+    {
+        // enlarge arrays
+        if (nsets == size)
+        {
+            size = size ? 2*size : 16;
+            Int_t* first = new Int_t[size];
+            Int_t* last = new Int_t[size];
+            Double_t* par = new Double_t[size*length];
+            for (Int_t i = 0; i < nsets; i++)
+            {
+                first[i] = outFirst[i];
+                last[i] = outLast[i];
+            }
+            for (Int_t i = 0; i < nsets*length; i++) par[i] = outPar[i];
+            if (outFirst) delete [] outFirst;
+            if (outLast) delete [] outLast;
+            if (outPar) delete [] outPar;
+            outFirst = first;
+            outLast = last;
+            outPar = par;
+        }
+
+        // read set
+        outFirst[nsets] = atoi(row->GetField(2));
+        outLast[nsets] = atoi(row->GetField(3));
+        for (Int_t i = 0; i < length; i++)
+        {
+            // check parameter
+            const Char_t* v = i+5 < res->GetFieldCount() ? row->GetField(i+5) : 0;
+            if (!v)
+            {
+                if (!fSilence) Error("ReadSets", "Could not read parameter %d of set %d of '%s'!",
+                                     i, nsets, d->GetTitle());
+                delete row;
+                delete res;
+                delete [] outFirst;
+                delete [] outLast;
+                delete [] outPar;
+                outFirst = 0;
+                outLast = 0;
+                outPar = 0;
+                return -1;
+            }
+            outPar[nsets*length + i] = atof(v);
+        }
+        nsets++;
+        delete row;
+    }
+
+    // clean-up
+    delete res;
+
+    // user information
+    if (!fSilence) Info("ReadSets", "Read %d sets of '%s' from the database",
+                        nsets, d->GetTitle());
+
+    return nsets;
+}
+
 //______________________________________________________________________________
 Bool_t TCMySQLManager::WriteParameters(const Char_t* data, const Char_t* calibration, Int_t set,
                                        Double_t* par, Int_t length)
@@ -1223,10 +1588,12 @@ Bool_t TCMySQLManager::InitDatabase(Bool_t interact)
     // create the main table
     CreateMainTable();
 
+    // create the bad scaler read table
+    Bool_t err = !CreateBadScRTable();
+
     // create the data tables
     TIter next(fData);
     TCCalibData* d;
-    Bool_t err = kFALSE;
     while ((d = (TCCalibData*)next()))
     {
         // create the data table
@@ -1248,9 +1615,10 @@ Bool_t TCMySQLManager::InitDatabase(Bool_t interact)
 }
 
 //______________________________________________________________________________
-Bool_t TCMySQLManager::UpgradeDatabase(Int_t version)
+Bool_t TCMySQLManager::UpgradeDatabase(Int_t version, Bool_t interact)
 {
-    // Upgrade the CaLib database to version 'version'.
+    // Upgrade the CaLib database to version 'version' in interactive mode
+    // when 'interact' is kTRUE.
     // Return kTRUE on success, otherwise kFALSE.
 
     // check server connection
@@ -1261,25 +1629,28 @@ Bool_t TCMySQLManager::UpgradeDatabase(Int_t version)
     }
 
     // ask for user confirmation
-    Char_t answer[256];
-    if (fDBType == kSQLite)
-    {
-        printf("\nWARNING: You are about to update your existing CaLib database '%s'\n"
-               "         It is highly recommended to create a complete backup\n"
-               "         before proceeding!\n\n", fDB->GetDB());
-    }
-    else
-    {
-        printf("\nWARNING: You are about to update your existing CaLib database '%s' on '%s'\n"
-               "         It is highly recommended to create a complete backup using\n"
-               "         e.g. mysqldump before proceeding!\n\n", fDB->GetDB(), fDB->GetHost());
-    }
-    printf("Are you sure to continue? (yes/no) : ");
-    Int_t ret = scanf("%s", answer);
-    if (strcmp(answer, "yes"))
+    if (interact)
     {
-        printf("Aborted.\n");
-        return kFALSE;
+        Char_t answer[256] = "";
+        if (fDBType == kSQLite)
+        {
+            printf("\nWARNING: You are about to update your existing CaLib database '%s'\n"
+                   "         It is highly recommended to create a complete backup\n"
+                   "         before proceeding!\n\n", fDB->GetDB());
+        }
+        else
+        {
+            printf("\nWARNING: You are about to update your existing CaLib database '%s' on '%s'\n"
+                   "         It is highly recommended to create a complete backup using\n"
+                   "         e.g. mysqldump before proceeding!\n\n", fDB->GetDB(), fDB->GetHost());
+        }
+        printf("Are you sure to continue? (yes/no) : ");
+        Int_t ret = scanf("%s", answer);
+        if (strcmp(answer, "yes"))
+        {
+            printf("Aborted.\n");
+            return kFALSE;
+        }
     }
 
     // create queries (update only this part in the future)
@@ -1322,6 +1693,40 @@ Bool_t TCMySQLManager::UpgradeDatabase(Int_t version)
 
             break;
         }
+        // version 5:
+        // - move bad scaler reads from run_main.scr_bad to a table of intervals
+        case 5:
+        {
+            // create table and convert existing bad scaler reads
+            if (!CreateBadScRTable() || !MigrateBadScR())
+            {
+                Error("UpgradeDatabase", "Some errors occurred while converting the bad scaler reads!");
+                return kFALSE;
+            }
+
+            break;
+        }
+        // version 6:
+        // - add indices on the change time for the change feed
+        case 6:
+        {
+            // main table
+            Bool_t ok = CreateChangeIndex(TCConfig::kCalibMainTableName);
+
+            // data tables
+            TIter next(fData);
+            TCCalibData* d;
+            while ((d = (TCCalibData*)next()))
+                if (!CreateChangeIndex(d->GetTableName())) ok = kFALSE;
+
+            if (!ok)
+            {
+                Error("UpgradeDatabase", "Some errors occurred while creating the change time indices!");
+                return kFALSE;
+            }
+
+            break;
+        }
         default:
         {
             Error("UpgradeDatabase", "Database upgrade to version %d not implemented!", version);
@@ -1359,25 +1764,92 @@ Bool_t TCMySQLManager::UpgradeDatabase(Int_t version)
 }
 
 //______________________________________________________________________________
-Bool_t TCMySQLManager::AddNewDataTable(const Char_t* data)
+Bool_t TCMySQLManager::MigrateBadScR()
 {
-    // Add a new table for the calibration data 'data' to the database including
-    // a default calibration set for all calibrations found in the database.
+    // Convert the bad scaler reads stored as text in the column 'scr_bad' of
+    // the main table of former databases to the bad scaler read table. The
+    // old column is left untouched.
+    // Return kTRUE on success, otherwise kFALSE.
 
-    Char_t tmp[256];
+    // read all runs with bad scaler reads
+    TSQLResult* res = SendQuery(TString::Format("SELECT run, scr_bad FROM %s "
+                                                "WHERE scr_bad IS NOT NULL AND scr_bad != '' "
+                                                "ORDER BY run",
+                                                TCConfig::kCalibMainTableName).Data());
+    if (!res)
+    {
+        if (!fSilence) Error("MigrateBadScR", "Could not read the bad scaler reads from the main table!");
+        return kFALSE;
+    }
 
-    // get data
-    TCCalibData* d = GetCalibData(data);
-    if (!d) return kFALSE;
+    // read all rows
+    TList rows;
+    rows.SetOwner(kTRUE);
+    TSQLRow* row;
+    while ((row = res->Next())) rows.Add(row);
+    delete res;
 
-    // check if table exists already
-    if (SendExec(TString::Format("SELECT 1 from %s LIMIT 1", d->GetTableName())))
+    // write all intervals within one transaction
+    fDB->StartTransaction();
+
+    // loop over runs
+    Int_t nRun = 0;
+    Int_t nErr = 0;
+    TIter next(&rows);
+    while ((row = (TSQLRow*)next()))
+    {
+        // parse text
+        Int_t run = atoi(row->GetField(0));
+        TCBadScRElement** badscr_data = 0;
+        Int_t ndata = 0;
+        ParseBadScR(row->GetField(1), badscr_data, ndata);
+
+        // write bad scaler reads of all data
+        for (Int_t i = 0; i < ndata; i++)
+        {
+            if (!WriteBadScR(run, badscr_data[i]->GetCalibData(),
+                             badscr_data[i]->GetNBad(), badscr_data[i]->GetBad())) nErr++;
+            delete badscr_data[i];
+        }
+        if (badscr_data) delete [] badscr_data;
+        nRun++;
+    }
+
+    // check for errors
+    if (nErr)
     {
-        if (!fSilence) Error("AddNewDataTable", "Data table for '%s' exists already!", data);
+        fDB->Rollback();
+        if (!fSilence) Error("MigrateBadScR", "Could not convert the bad scaler reads of %d data!", nErr);
         return kFALSE;
     }
+    fDB->Commit();
 
-    // add data table
+    // user information
+    if (!fSilence) Info("MigrateBadScR", "Converted the bad scaler reads of %d runs", nRun);
+
+    return kTRUE;
+}
+
+//______________________________________________________________________________
+Bool_t TCMySQLManager::AddNewDataTable(const Char_t* data)
+{
+    // Add a new table for the calibration data 'data' to the database including
+    // a default calibration set for all calibrations found in the database.
+
+    Char_t tmp[256];
+
+    // get data
+    TCCalibData* d = GetCalibData(data);
+    if (!d) return kFALSE;
+
+    // check if table exists already
+    if (SendExec(TString::Format("SELECT 1 from %s LIMIT 1", d->GetTableName())))
+    {
+        if (!fSilence) Error("AddNewDataTable", "Data table for '%s' exists already!", data);
+        return kFALSE;
+    }
+
+    // add data table
     if (CreateDataTable(d->GetName(), d->GetSize()))
     {
         if (!fSilence) Info("AddNewDataTable", "Added data table for '%s'", data);
@@ -2043,6 +2515,10 @@ Bool_t TCMySQLManager::RemoveAllRuns()
     // read from database
     Bool_t res = SendExec(query.Data());
 
+    // remove the bad scaler reads
+    query.Form("DELETE FROM %s", TCConfig::kCalibBadScRTableName);
+    if (!SendExec(query.Data())) res = kFALSE;
+
     // check result
     if (!res)
     {
@@ -2259,6 +2735,31 @@ void TCMySQLManager::CreateMainTable()
                                  "END",
                                  TCConfig::kCalibMainTableName, TCConfig::kCalibMainTableName, TCConfig::kCalibMainTableName).Data());
     }
+
+    // add index for the change feed
+    CreateChangeIndex(TCConfig::kCalibMainTableName);
+}
+
+//______________________________________________________________________________
+Bool_t TCMySQLManager::CreateBadScRTable()
+{
+    // Create the table for the bad scaler reads.
+
+    // user information
+    if (!fSilence) Info("CreateBadScRTable", "Creating bad scaler read table");
+
+    // delete the old table if it exists
+    SendExec(TString::Format("DROP TABLE IF EXISTS %s", TCConfig::kCalibBadScRTableName).Data());
+
+    // create the table
+    if (!SendExec(TString::Format("CREATE TABLE %s ( %s )",
+                                  TCConfig::kCalibBadScRTableName, TCConfig::kCalibBadScRTableFormat).Data()))
+    {
+        if (!fSilence) Error("CreateBadScRTable", "An error occurred during the creation of the bad scaler read table!");
+        return kFALSE;
+    }
+
+    return kTRUE;
 }
 
 //______________________________________________________________________________
@@ -2329,6 +2830,9 @@ Bool_t TCMySQLManager::CreateDataTable(const Char_t* data, Int_t nElem)
                                  table, table, table).Data());
     }
 
+    // add index for the change feed
+    CreateChangeIndex(table);
+
     return kTRUE;
 }
 
@@ -2942,130 +3446,102 @@ Bool_t TCMySQLManager::MergeDataSets(const Char_t* data, const Char_t* calibrati
 //______________________________________________________________________________
 Bool_t TCMySQLManager::ChangeRunBadScR(Int_t run, Int_t nbadscr, const Int_t* badscr, const Char_t* data)
 {
-    // ...
+    // Replace the bad scaler reads of the calibration data 'data' of the run
+    // 'run' by the 'nbadscr' sorted bad scaler reads in 'badscr'. The bad
+    // scaler reads of other data of the run are not affected.
+    // Returns kTRUE on success, kFALSE otherwise.
 
     // get short name (only last part of calib data, e.g. 'Data.Run.BadScR.NaI' --> 'NaI')
     data = strrchr(data, '.') + 1;
 
-    // read old values from database -------------------------------------------
-
-    // init return values
-    TCBadScRElement** badscr_data = 0;
-    Int_t ndata = 0;
-
-    // read all data
-    if (!ReadAllBadScR(run, badscr_data, ndata)) return kFALSE;
-
-
-    // change scaler reads in list --------------------------------------------
+    // replace the intervals within a transaction
+    fDB->StartTransaction();
 
-    // init flag
-    Bool_t isAdded = kFALSE;
-
-    // loop over data
-    for (Int_t d = 0; d < ndata; d++)
+    // delete old bad scaler reads
+    if (!SendExec(TString::Format("DELETE FROM %s WHERE run = %d AND data = '%s'",
+                                  TCConfig::kCalibBadScRTableName, run, data).Data()))
     {
-        // check whether names match
-        if (strcmp(badscr_data[d]->GetCalibData(), data) == 0)
-        {
-            // remove bad scaler reads
-            badscr_data[d]->RemBad();
-
-            // add new bad scaler reads
-            badscr_data[d]->AddBad(nbadscr, badscr);
-
-            // set flag
-            isAdded = kTRUE;
-        }
+        if (!fSilence) Error("ChangeRunBadScR", "Could not delete the bad scaler reads of '%s' of run %d!",
+                             data, run);
+        fDB->Rollback();
+        return kFALSE;
     }
 
-    // check whether it was added already (if not append a new element)
-    if (!isAdded)
+    // write new bad scaler reads and update the change time of the run
+    if (!WriteBadScR(run, data, nbadscr, badscr) || !TouchRun(run))
     {
-        // create new array
-        TCBadScRElement** badscr_data_tmp = new TCBadScRElement*[ndata+1];
+        fDB->Rollback();
+        return kFALSE;
+    }
 
-        // copy old pointers
-        for (Int_t i = 0; i < ndata; i++)
-            badscr_data_tmp[i] = badscr_data[i];
+    return fDB->Commit();
+}
 
-        // delete old array
-        delete [] badscr_data;
+//______________________________________________________________________________
+Bool_t TCMySQLManager::TouchRun(Int_t run)
+{
+    // Set the change time of the run 'run' in the main table to the current
+    // time. Used for changes of run information stored in other tables
+    // (e.g. bad scaler reads) to be visible in GetChangedRuns().
+    // Returns kTRUE on success, kFALSE otherwise.
 
-        // set pointer
-        badscr_data = badscr_data_tmp;
+    if (!SendExec(TString::Format("UPDATE %s SET changed = CURRENT_TIMESTAMP WHERE run = %d",
+                                  TCConfig::kCalibMainTableName, run).Data()))
+    {
+        if (!fSilence) Error("TouchRun", "Could not update the change time of run %d!", run);
+        return kFALSE;
+    }
 
-        // append the new data (do not need to set totnscr)
-        badscr_data[ndata] = new TCBadScRElement(run, nbadscr, badscr);
+    return kTRUE;
+}
 
-        // set name
-        badscr_data[ndata]->SetCalibData(data);
+//______________________________________________________________________________
+Bool_t TCMySQLManager::CreateChangeIndex(const Char_t* table)
+{
+    // Create the index on the change time of the table 'table' used by the
+    // change feed (GetChangedRuns(), GetChangedSets(), GetLastChange()).
+    // Returns kTRUE on success, kFALSE otherwise.
 
-        // increment number of data
-        ndata++;
+    if (!SendExec(TString::Format("CREATE INDEX %s_changed ON %s (changed)", table, table).Data()))
+    {
+        if (!fSilence) Error("CreateChangeIndex", "Could not create the change time index of table '%s'!", table);
+        return kFALSE;
     }
 
+    return kTRUE;
+}
 
-    // create query string -------------------------------------------------------
-
-    // init query string
-    TString s = "";
+//______________________________________________________________________________
+Bool_t TCMySQLManager::WriteBadScR(Int_t run, const Char_t* data, Int_t nbadscr, const Int_t* badscr)
+{
+    // Write the 'nbadscr' sorted bad scaler reads in 'badscr' of the short
+    // calibration data name 'data' (e.g. 'NaI') of the run 'run' as intervals
+    // to the bad scaler read table. Existing entries are not deleted.
+    // Returns kTRUE on success, kFALSE otherwise.
 
-    // loop over data
-    for (Int_t d = 0; d < ndata; d++)
+    // loop over bad scaler reads
+    for (Int_t i = 0; i < nbadscr; i++)
     {
-        // append name
-        s.Append(badscr_data[d]->GetCalibData());
-        s.Append(":");
-
-        // get bad scaler read values
-        Int_t nbadscr = badscr_data[d]->GetNBad();
-        const Int_t* badscr = badscr_data[d]->GetBad();
+        // find end of interval, i.e., badscr[k]+1 == badscr[k+1]
+        Int_t j = i;
+        while (j < nbadscr - 1 && badscr[j] + 1 == badscr[j+1]) j++;
 
-        // loop over input bad scaler reads list
-        for (Int_t i = 0; i < nbadscr; i++)
+        // write interval
+        if (!SendExec(TString::Format("INSERT INTO %s (run, data, first_scr, last_scr) "
+                                      "VALUES (%d, '%s', %d, %d)",
+                                      TCConfig::kCalibBadScRTableName, run, data,
+                                      badscr[i], badscr[j]).Data()))
         {
-            Char_t tmp[16];
-            Int_t j = 0;
-
-            // loop over subsequent values in order to detect series, i.e., badscr[k]+1 == badscr[k+1]
-            for (j = 0; i + j < nbadscr - 1; j++)
-                if (badscr[i+j] + 1 != badscr[i+j+1]) break;
-
-            // check for series with more than 2 elements
-            if (j > 1)
-            {
-                // separate first and last value of series with ':'
-                sprintf(tmp, "%d-%d,", badscr[i], badscr[i+j]);
-                i += j;
-            }
-            else
-            {
-                // separate with ','
-                sprintf(tmp, "%d,", badscr[i]);
-            }
-
-            // append to query string
-            s.Append(tmp);
+            if (!fSilence) Error("WriteBadScR", "Could not write the bad scaler reads %d-%d of '%s' of run %d!",
+                                 badscr[i], badscr[j], data, run);
+            return kFALSE;
         }
 
-        // remove tailing comma
-        s.Chop();
-
-        // append data delimiter
-        s.Append(";");
+        // skip interval
+        i = j;
     }
 
-
-    // finish ------------------------------------------------------------------
-
-    // clean up
-    for (Int_t i = 0; i < ndata; i++)
-        delete badscr_data[i];
-    delete [] badscr_data;
-
-    // change list of bad scaler reads
-    return ChangeRunEntries(run, run, "scr_bad", s.Data());
+    return kTRUE;
 }
 
 //______________________________________________________________________________
@@ -3080,7 +3556,7 @@ Bool_t TCMySQLManager::GetRunBadScR(Int_t run, Int_t& nbadscr, Int_t*& badscr, c
     // NOTE: The array has to be destroyed by the caller.
 
     // get short name (only last part of calib data, e.g. 'Data.Run.BadScR.NaI' --> 'NaI')
-    data = strrchr(data, '.') + 1;
+    if (data) data = strrchr(data, '.') + 1;
 
     // declare temporary bad scr element
     TCBadScRElement* badscr_tmp = 0;
@@ -3106,7 +3582,7 @@ Bool_t TCMySQLManager::GetRunBadScR(Int_t run, Int_t& nbadscr, Int_t*& badscr, c
             if (!badscr_tmp) badscr_tmp = new TCBadScRElement();
 
             // add bad scr
-            badscr_tmp->AddBad(badscr_data[d]->GetNBad(), badscr_data[d]->GetBad());
+            badscr_tmp->AddBad(*badscr_data[d]);
         }
 
         // clean up
@@ -3136,14 +3612,201 @@ Bool_t TCMySQLManager::GetRunBadScR(Int_t run, Int_t& nbadscr, Int_t*& badscr, c
     return kTRUE;
 }
 
+//______________________________________________________________________________
+Bool_t TCMySQLManager::GetRunsBadScR(Int_t first_run, Int_t last_run, const Char_t* data,
+                                     TCBadScRElement**& badscr_data, Int_t& nrun)
+{
+    // Reads the bad scaler reads of the calibration data 'data' of all runs
+    // from 'first_run' to 'last_run' with a single query. One bad scaler read
+    // element is created for each run having bad scaler reads, ordered by run
+    // number. The number of elements is stored to 'nrun'.
+    // Returns kTRUE if the database readout was successful, kFALSE otherwise.
+    // NOTE: The array and its elements have to be destroyed by the caller.
+
+    // init result variables
+    nrun = 0;
+    badscr_data = 0;
+
+    // get short name (only last part of calib data, e.g. 'Data.Run.BadScR.NaI' --> 'NaI')
+    data = strrchr(data, '.') + 1;
+
+    // read all intervals
+    TSQLResult* res = SendQuery(TString::Format("SELECT run, first_scr, last_scr FROM %s "
+                                                "WHERE run >= %d AND run <= %d AND data = '%s' "
+                                                "ORDER BY run, first_scr",
+                                                TCConfig::kCalibBadScRTableName,
+                                                first_run, last_run, data).Data());
+    if (!res)
+    {
+        if (!fSilence) Error("GetRunsBadScR", "Could not read the bad scaler reads of '%s' of the runs %d to %d!",
+                             data, first_run, last_run);
+        return kFALSE;
+    }
+
+    // read all rows (the row count is not available for all servers)
+    TList rows;
+    rows.SetOwner(kTRUE);
+    TSQLRow* row;
+    while ((row = res->Next())) rows.Add(row);
+    delete res;
+
+    // create element array (at most one element per interval)
+    if (rows.GetSize()) badscr_data = new TCBadScRElement*[rows.GetSize()];
+
+    // loop over intervals
+    TIter next(&rows);
+    while ((row = (TSQLRow*)next()))
+    {
+        // read interval
+        Int_t run = atoi(row->GetField(0));
+        Int_t first = atoi(row->GetField(1));
+        Int_t last = atoi(row->GetField(2));
+
+        // create new element for new run
+        if (!nrun || badscr_data[nrun-1]->GetRunNumber() != run)
+        {
+            badscr_data[nrun] = new TCBadScRElement(run);
+            badscr_data[nrun]->SetCalibData(data);
+            nrun++;
+        }
+
+        // add interval
+        for (Int_t i = first; i <= last; i++) badscr_data[nrun-1]->AddBad(i);
+    }
+
+    return kTRUE;
+}
+
+//______________________________________________________________________________
+Bool_t TCMySQLManager::ReadRunsBadScR(Int_t nrun, const Int_t* runs, const Char_t* data,
+                                      Int_t* outNScR, TCBadScRElement** outBadScR)
+{
+    // Read the number of scaler reads and the bad scaler reads of the
+    // calibration data 'data' of the 'nrun' runs 'runs' with a single query.
+    // The numbers of scaler reads are stored to 'outNScR' (-2 if the run was
+    // not found) and newly created bad scaler read elements without range
+    // restriction are stored to 'outBadScR'.
+    // Returns kTRUE if the database readout was successful, kFALSE otherwise.
+    // NOTE: The elements have to be destroyed by the caller.
+
+    // init output
+    for (Int_t i = 0; i < nrun; i++)
+    {
+        outNScR[i] = -2;
+        outBadScR[i] = new TCBadScRElement(runs[i]);
+    }
+    if (nrun <= 0) return kTRUE;
+
+    // get short name (only last part of calib data, e.g. 'Data.Run.BadScR.NaI' --> 'NaI')
+    data = strrchr(data, '.') + 1;
+    for (Int_t i = 0; i < nrun; i++) outBadScR[i]->SetCalibData(data);
+
+    // sort runs for look-up
+    Int_t* index = new Int_t[nrun];
+    Int_t* sorted = new Int_t[nrun];
+    TMath::Sort(nrun, runs, index, kFALSE);
+    for (Int_t i = 0; i < nrun; i++) sorted[i] = runs[index[i]];
+
+    // read all runs of the range with their intervals
+    TSQLResult* res = SendQuery(TString::Format("SELECT m.run, m.scr_n, b.first_scr, b.last_scr "
+                                                "FROM %s m LEFT JOIN %s b "
+                                                "ON b.run = m.run AND b.data = '%s' "
+                                                "WHERE m.run >= %d AND m.run <= %d "
+                                                "ORDER BY m.run, b.first_scr",
+                                                TCConfig::kCalibMainTableName,
+                                                TCConfig::kCalibBadScRTableName, data,
+                                                sorted[0], sorted[nrun-1]).Data());
+    if (!res)
+    {
+        if (!fSilence) Error("ReadRunsBadScR", "Could not read the bad scaler reads of '%s' of the runs %d to %d!",
+                             data, sorted[0], sorted[nrun-1]);
+        delete [] index;
+        delete [] sorted;
+        return kFALSE;
+    }
+
+    // loop over rows
+    TSQLRow* row;
+    while ((row = res->Next()))
+    {
+        // find run
+        Int_t run = atoi(row->GetField(0));
+        Long64_t pos = TMath::BinarySearch(nrun, sorted, run);
+        if (pos >= 0 && sorted[pos] == run)
+        {
+            // set number of scaler reads
+            Int_t i = index[pos];
+            outNScR[i] = row->GetField(1) ? atoi(row->GetField(1)) : -1;
+
+            // add interval
+            if (row->GetField(2) && row->GetField(3))
+            {
+                Int_t first = atoi(row->GetField(2));
+                Int_t last = atoi(row->GetField(3));
+                for (Int_t j = first; j <= last; j++) outBadScR[i]->AddBad(j);
+            }
+        }
+
+        // clean-up
+        delete row;
+    }
+
+    // clean-up
+    delete res;
+    delete [] index;
+    delete [] sorted;
+
+    return kTRUE;
+}
+
+//______________________________________________________________________________
+Bool_t TCMySQLManager::WriteRunsBadScR(Int_t nrun, TCBadScRElement** badscr, const Char_t* data)
+{
+    // Replace the bad scaler reads of the calibration data 'data' of the runs
+    // of the 'nrun' bad scaler read elements 'badscr' within one transaction.
+    // Nothing is changed if an error occurs.
+    // Returns kTRUE on success, kFALSE otherwise.
+
+    // get short name (only last part of calib data, e.g. 'Data.Run.BadScR.NaI' --> 'NaI')
+    data = strrchr(data, '.') + 1;
+
+    // start transaction
+    fDB->StartTransaction();
+
+    // loop over runs
+    for (Int_t i = 0; i < nrun; i++)
+    {
+        Int_t run = badscr[i]->GetRunNumber();
+
+        // delete old and write new bad scaler reads
+        if (!SendExec(TString::Format("DELETE FROM %s WHERE run = %d AND data = '%s'",
+                                      TCConfig::kCalibBadScRTableName, run, data).Data()) ||
+            !WriteBadScR(run, data, badscr[i]->GetNBad(), badscr[i]->GetBad()) ||
+            !TouchRun(run))
+        {
+            if (!fSilence) Error("WriteRunsBadScR", "Could not write the bad scaler reads of '%s' of run %d - "
+                                 "no run was changed!", data, run);
+            fDB->Rollback();
+            return kFALSE;
+        }
+    }
+
+    // commit changes
+    if (!fDB->Commit())
+    {
+        if (!fSilence) Error("WriteRunsBadScR", "Could not commit the bad scaler reads of '%s'!", data);
+        return kFALSE;
+    }
+
+    return kTRUE;
+}
+
 //______________________________________________________________________________
 Bool_t TCMySQLManager::ReadAllBadScR(Int_t run, TCBadScRElement**& badscr_data, Int_t& ndata)
 {
     // Reads the all bad scaler read of the run 'run'. The number of data found
-    // is stored to 'ndata'. The bad scaler reads of each data is stored to a
-    // bad scaler read element
-    // an array of pointers to bad scaler read elements
-    // If the NULL
+    // is stored to 'ndata'. The bad scaler reads of each data are stored to
+    // the array of bad scaler read elements 'badscr_data'.
     // Returns kTRUE if the database readout was successful, kFALSE otherwise.
     // NOTE: The array has to be destroyed by the caller.
 
@@ -3151,11 +3814,71 @@ Bool_t TCMySQLManager::ReadAllBadScR(Int_t run, TCBadScRElement**& badscr_data,
     ndata = 0;
     badscr_data = 0;
 
-    // init query return string
-    TString tmp;
+    // read all intervals of the run
+    TSQLResult* res = SendQuery(TString::Format("SELECT data, first_scr, last_scr FROM %s "
+                                                "WHERE run = %d "
+                                                "ORDER BY data, first_scr",
+                                                TCConfig::kCalibBadScRTableName, run).Data());
+    if (!res)
+    {
+        if (!fSilence) Error("ReadAllBadScR", "Could not read the bad scaler reads of run %d!", run);
+        return kFALSE;
+    }
+
+    // read all rows (the row count is not available for all servers)
+    TList rows;
+    rows.SetOwner(kTRUE);
+    TSQLRow* row;
+    while ((row = res->Next())) rows.Add(row);
+    delete res;
+
+    // create element array (at most one element per interval)
+    if (rows.GetSize()) badscr_data = new TCBadScRElement*[rows.GetSize()];
+
+    // loop over intervals
+    TIter next(&rows);
+    while ((row = (TSQLRow*)next()))
+    {
+        // read interval
+        const Char_t* name = row->GetField(0);
+        Int_t first = atoi(row->GetField(1));
+        Int_t last = atoi(row->GetField(2));
 
-    // get run entry
-    if (!SearchRunEntry(run, "scr_bad", tmp)) return kFALSE;
+        // create new element for new data
+        if (!ndata || strcmp(badscr_data[ndata-1]->GetCalibData(), name))
+        {
+            badscr_data[ndata] = new TCBadScRElement(run);
+            badscr_data[ndata]->SetCalibData(name);
+            ndata++;
+        }
+
+        // add interval
+        for (Int_t i = first; i <= last; i++) badscr_data[ndata-1]->AddBad(i);
+    }
+
+    return kTRUE;
+}
+
+//______________________________________________________________________________
+Bool_t TCMySQLManager::ParseBadScR(const Char_t* str, TCBadScRElement**& badscr_data, Int_t& ndata)
+{
+    // Parse the bad scaler reads of all data in the string 'str' given in the
+    // text format of the CaLib containers and of former databases (e.g.
+    // "NaI:1,2,5-9;PID:3;"). The number of data found is stored to 'ndata'.
+    // The bad scaler reads of each data are stored to the array of bad scaler
+    // read elements 'badscr_data'.
+    // Returns kTRUE on success.
+    // NOTE: The array has to be destroyed by the caller.
+
+    // init result variables
+    ndata = 0;
+    badscr_data = 0;
+
+    // check string
+    if (!str || !strlen(str)) return kTRUE;
+
+    // copy string for tokenizing
+    TString tmp(str);
 
     // pointers to data tokens
     Char_t** data = 0;
@@ -3237,25 +3960,85 @@ Bool_t TCMySQLManager::ReadAllBadScR(Int_t run, TCBadScRElement**& badscr_data,
         }
     }
 
+    // clean-up
+    delete [] data;
+
     return kTRUE;
 }
 
 //______________________________________________________________________________
-Bool_t TCMySQLManager::MergeSets(const Char_t* type, const Char_t* calibration,
-                                 Int_t set1, Int_t set2)
+TString TCMySQLManager::FormatBadScR(TCBadScRElement** badscr_data, Int_t ndata)
 {
-    // Merge all adjacent pairs of the sets 'set1' and 'set2' of the calibration type 'type' and the
-    // calibration identifier 'calibration' into one set. Description and parameters
-    // of 'set1' will be used in the merged set.
-    // get the first run of the set
-
-    Bool_t ret = kTRUE;
+    // Return the bad scaler reads of the 'ndata' elements 'badscr_data' in the
+    // text format of the CaLib containers (e.g. "NaI:1,2,5-9;PID:3;").
 
-    // get calibration type
-    TCCalibType* t = GetCalibType(type);
-    if (!t) return kFALSE;
+    // init string
+    TString s = "";
 
-    // get data list
+    // loop over data
+    for (Int_t d = 0; d < ndata; d++)
+    {
+        // append name
+        s.Append(badscr_data[d]->GetCalibData());
+        s.Append(":");
+
+        // get bad scaler read values
+        Int_t nbadscr = badscr_data[d]->GetNBad();
+        const Int_t* badscr = badscr_data[d]->GetBad();
+
+        // loop over input bad scaler reads list
+        for (Int_t i = 0; i < nbadscr; i++)
+        {
+            Char_t tmp[32];
+            Int_t j = 0;
+
+            // loop over subsequent values in order to detect series, i.e., badscr[k]+1 == badscr[k+1]
+            for (j = 0; i + j < nbadscr - 1; j++)
+                if (badscr[i+j] + 1 != badscr[i+j+1]) break;
+
+            // check for series with more than 2 elements
+            if (j > 1)
+            {
+                // separate first and last value of series with '-'
+                sprintf(tmp, "%d-%d,", badscr[i], badscr[i+j]);
+                i += j;
+            }
+            else
+            {
+                // separate with ','
+                sprintf(tmp, "%d,", badscr[i]);
+            }
+
+            // append to string
+            s.Append(tmp);
+        }
+
+        // remove tailing comma
+        if (nbadscr) s.Chop();
+
+        // append data delimiter
+        s.Append(";");
+    }
+
+    return s;
+}
+
+//______________________________________________________________________________
+Bool_t TCMySQLManager::MergeSets(const Char_t* type, const Char_t* calibration,
+                                 Int_t set1, Int_t set2)
+{
+    // Merge all adjacent pairs of the sets 'set1' and 'set2' of the calibration type 'type' and the
+    // calibration identifier 'calibration' into one set. Description and parameters
+    // of 'set1' will be used in the merged set.
+    // get the first run of the set
+
+    Bool_t ret = kTRUE;
+
+    // get calibration type
+    TCCalibType* t = GetCalibType(type);
+    if (!t) return kFALSE;
+
+    // get data list
     TList* data = t->GetData();
 
     // loop over calibration data of this calibration type
@@ -3272,15 +4055,14 @@ Bool_t TCMySQLManager::MergeSets(const Char_t* type, const Char_t* calibration,
 }
 
 //______________________________________________________________________________
-Int_t TCMySQLManager::DumpRuns(TCContainer* container, Int_t first_run, Int_t last_run)
+Int_t* TCMySQLManager::GetRunList(Int_t first_run, Int_t last_run, Int_t* outNruns)
 {
-    // Dump the run information from run 'first_run' to run 'last_run' to
-    // the CaLib container 'container'.
-    // If first_run and last_run is zero all available runs will be dumped.
-    // Return the number of dumped runs.
+    // Return the sorted list of all runs from run 'first_run' to run 'last_run'.
+    // If first_run and last_run is zero all available runs are returned.
+    // If 'outNruns' is not zero the number of runs will be written to this variable.
+    // NOTE: the run array must be destroyed by the caller.
 
     TString query;
-    TString tmp;
 
     // create the query
     if (!first_run && !last_run)
@@ -3301,6 +4083,13 @@ Int_t TCMySQLManager::DumpRuns(TCContainer* container, Int_t first_run, Int_t la
     // read from database
     TSQLResult* res = SendQuery(query.Data());
 
+    // check result
+    if (!res)
+    {
+        if (outNruns) *outNruns = 0;
+        return 0;
+    }
+
     // create list for run numbers
     TList run_numbers;
     run_numbers.SetOwner(kTRUE);
@@ -3317,14 +4106,43 @@ Int_t TCMySQLManager::DumpRuns(TCContainer* container, Int_t first_run, Int_t la
     // get number of runs
     Int_t nruns = run_numbers.GetSize();
 
+    // create run array
+    Int_t* runs = new Int_t[nruns];
+
+    // read all runs
+    TIter next(&run_numbers);
+    TObjString* rn;
+    Int_t n = 0;
+    while ((rn = (TObjString*)next())) runs[n++] = atoi(rn->GetString().Data());
+
+    // clean-up
+    delete res;
+
+    // write number of runs
+    if (outNruns) *outNruns = nruns;
+
+    return runs;
+}
+
+//______________________________________________________________________________
+Int_t TCMySQLManager::DumpRuns(TCContainer* container, Int_t first_run, Int_t last_run)
+{
+    // Dump the run information from run 'first_run' to run 'last_run' to
+    // the CaLib container 'container'.
+    // If first_run and last_run is zero all available runs will be dumped.
+    // Return the number of dumped runs.
+
+    TString tmp;
+
+    // get the run numbers
+    Int_t nruns = 0;
+    Int_t* run_numbers = GetRunList(first_run, last_run, &nruns);
+
     // loop over runs
     for (Int_t i = 0; i < nruns; i++)
     {
-        // get next run
-        TObjString* rn = (TObjString*) run_numbers.At(i);
-
         // get run number
-        Int_t run_number = atoi(rn->GetString().Data());
+        Int_t run_number = run_numbers[i];
 
         // add new run
         TCRun* run = container->AddRun(run_number);
@@ -3356,7 +4174,14 @@ Int_t TCMySQLManager::DumpRuns(TCContainer* container, Int_t first_run, Int_t la
         if (SearchRunEntry(run_number, "scr_n", tmp)) run->SetNScalerReads(atoi(tmp.Data()));
 
         // set bad scaler reads
-        if (SearchRunEntry(run_number, "scr_bad", tmp)) run->SetBadScalerReads(tmp.Data());
+        TCBadScRElement** badscr_data = 0;
+        Int_t ndata = 0;
+        if (ReadAllBadScR(run_number, badscr_data, ndata))
+        {
+            run->SetBadScalerReads(FormatBadScR(badscr_data, ndata).Data());
+            for (Int_t j = 0; j < ndata; j++) delete badscr_data[j];
+            if (badscr_data) delete [] badscr_data;
+        }
 
         // set target
         if (SearchRunEntry(run_number, "target", tmp)) run->SetTarget(tmp.Data());
@@ -3378,7 +4203,7 @@ Int_t TCMySQLManager::DumpRuns(TCContainer* container, Int_t first_run, Int_t la
     }
 
     // clean-up
-    delete res;
+    if (run_numbers) delete [] run_numbers;
 
     return nruns;
 }
@@ -3487,7 +4312,7 @@ Int_t TCMySQLManager::ImportRuns(TCContainer* container)
         TCRun* r = container->GetRun(i);
 
         // prepare the insert query
-        TString ins_query = TString::Format("INSERT INTO %s (run, path, filename, time, description, run_note, size, scr_n, scr_bad, "
+        TString ins_query = TString::Format("INSERT INTO %s (run, path, filename, time, description, run_note, size, scr_n, "
                                             "target, target_pol, target_pol_deg, beam_pol, beam_pol_deg) "
                                             "VALUES ( "
                                             "%d, "
@@ -3500,7 +4325,6 @@ Int_t TCMySQLManager::ImportRuns(TCContainer* container)
                                             "%d, "
                                             "'%s', "
                                             "'%s', "
-                                            "'%s', "
                                             "%lf, "
                                             "'%s', "
                                             "%lf )",
@@ -3513,7 +4337,6 @@ Int_t TCMySQLManager::ImportRuns(TCContainer* container)
                                             r->GetRunNote(),
                                             r->GetSize(),
                                             r->GetNScalerReads(),
-                                            r->GetBadScalerReads(),
                                             r->GetTarget(),
                                             r->GetTargetPol(),
                                             r->GetTargetPolDeg(),
@@ -3531,6 +4354,20 @@ Int_t TCMySQLManager::ImportRuns(TCContainer* container)
         {
             if (!fSilence) Info("ImportRuns", "Added run %d to the database", r->GetRun());
             nRunAdded++;
+
+            // write the bad scaler reads
+            TCBadScRElement** badscr_data = 0;
+            Int_t ndata = 0;
+            ParseBadScR(r->GetBadScalerReads(), badscr_data, ndata);
+            for (Int_t j = 0; j < ndata; j++)
+            {
+                if (!WriteBadScR(r->GetRun(), badscr_data[j]->GetCalibData(),
+                                 badscr_data[j]->GetNBad(), badscr_data[j]->GetBad()))
+                    Warning("ImportRuns", "Bad scaler reads of run %d could not be added to the database!",
+                            r->GetRun());
+                delete badscr_data[j];
+            }
+            if (badscr_data) delete [] badscr_data;
         }
     }
 
@@ -3688,11 +4525,310 @@ Bool_t TCMySQLManager::CloneCalibration(const Char_t* calibration, const Char_t*
     }
 }
 
+//______________________________________________________________________________
+// task of the streaming export/import pipeline
+struct StreamTask
+{
+    TCDataQueue* queue;                 // chunk queue
+    TCContainer* source;                // source container file (producer)
+    Bool_t runs;                        // read runs (producer)
+    Bool_t calibrations;                // read calibrations (producer)
+    Int_t chunkSize;                    // number of runs/calibrations per chunk (producer)
+    TCContainer* file;                  // target container file (consumer)
+    TCMySQLManager* db;                 // target database (consumer)
+    const Char_t* newCalibName;         // new calibration name (consumer)
+    const Char_t* location;             // location used for user information
+    Bool_t silence;                     // silence mode toggle
+    Int_t nRunsTotal;                   // total number of runs (0 if unknown)
+    Int_t nRuns;                        // number of written runs
+    Int_t nCalib;                       // number of written calibrations
+    Long64_t start;                     // start time [ms]
+};
+
+//______________________________________________________________________________
+static void* StreamProducer(void* arg)
+{
+    // Producer stage of the streaming import: read the runs and calibrations
+    // from the container file opened by TCContainer::BeginLoad() in chunks and
+    // push them to the queue. Entries that cannot be read are skipped.
+
+    StreamTask* task = (StreamTask*) arg;
+
+    // read runs
+    Long64_t nruns = task->runs ? task->source->GetNSavedRuns() : 0;
+    for (Long64_t i = 0; i < nruns; i += task->chunkSize)
+    {
+        TCContainer* chunk = new TCContainer("chunk");
+        for (Long64_t j = i; j < nruns && j < i + task->chunkSize; j++)
+        {
+            TCRun* r = chunk->AddRun(0);
+            if (!task->source->LoadRun(j, r))
+            {
+                if (!task->silence) Error(task->location, "Could not read the run entry %lld of the container!", j);
+                delete chunk->GetRuns()->Remove(r);
+            }
+        }
+        if (!task->queue->Push(chunk))
+        {
+            delete chunk;
+            break;
+        }
+    }
+
+    // read calibrations
+    Long64_t ncalib = task->calibrations ? task->source->GetNSavedCalibrations() : 0;
+    for (Long64_t i = 0; i < ncalib; i += task->chunkSize)
+    {
+        TCContainer* chunk = new TCContainer("chunk");
+        for (Long64_t j = i; j < ncalib && j < i + task->chunkSize; j++)
+        {
+            TCCalibration* c = chunk->AddCalibration("");
+            if (!task->source->LoadCalibration(j, c))
+            {
+                if (!task->silence) Error(task->location, "Could not read the calibration entry %lld of the container!", j);
+                delete chunk->GetCalibrations()->Remove(c);
+            }
+        }
+        if (!task->queue->Push(chunk))
+        {
+            delete chunk;
+            break;
+        }
+    }
+
+    // no more chunks
+    task->queue->Close();
+
+    return 0;
+}
+
+//______________________________________________________________________________
+static void* StreamConsumer(void* arg)
+{
+    // Consumer stage of the streaming export/import: write the chunks of the
+    // queue to the container file opened by TCContainer::BeginSave() or to
+    // the database and report the progress.
+
+    StreamTask* task = (StreamTask*) arg;
+
+    // loop over chunks
+    TCContainer* chunk;
+    while ((chunk = (TCContainer*) task->queue->Pop()))
+    {
+        // write chunk
+        if (task->file)
+        {
+            for (Int_t i = 0; i < chunk->GetNRuns(); i++)
+                if (task->file->SaveRun(chunk->GetRun(i))) task->nRuns++;
+            for (Int_t i = 0; i < chunk->GetNCalibrations(); i++)
+                if (task->file->SaveCalibration(chunk->GetCalibration(i))) task->nCalib++;
+        }
+        else
+        {
+            if (chunk->GetNRuns()) task->nRuns += task->db->ImportRuns(chunk);
+            if (chunk->GetNCalibrations()) task->nCalib += task->db->ImportCalibrations(chunk, task->newCalibName);
+        }
+        delete chunk;
+
+        // user information
+        if (!task->silence)
+        {
+            Double_t t = TMath::Max((Long64_t)gSystem->Now() - task->start, (Long64_t)1) / 1000.;
+            if (task->nRunsTotal)
+                Info(task->location, "Progress: %d/%d runs, %d calibrations written "
+                     "(%.1f runs/s, %.1f calibrations/s)",
+                     task->nRuns, task->nRunsTotal, task->nCalib, task->nRuns/t, task->nCalib/t);
+            else
+                Info(task->location, "Progress: %d runs, %d calibrations written "
+                     "(%.1f runs/s, %.1f calibrations/s)",
+                     task->nRuns, task->nCalib, task->nRuns/t, task->nCalib/t);
+        }
+    }
+
+    return 0;
+}
+
+//______________________________________________________________________________
+static void InitStreamTask(StreamTask& task, TCDataQueue* queue, const Char_t* location, Bool_t silence)
+{
+    // Init the streaming export/import task 'task' using the queue 'queue'.
+
+    task.queue = queue;
+    task.source = 0;
+    task.runs = kFALSE;
+    task.calibrations = kFALSE;
+    task.chunkSize = TCReadConfig::GetReader()->GetConfigInt("DB.Stream.ChunkSize");
+    if (task.chunkSize <= 0) task.chunkSize = 100;
+    task.file = 0;
+    task.db = 0;
+    task.newCalibName = 0;
+    task.location = location;
+    task.silence = silence;
+    task.nRunsTotal = 0;
+    task.nRuns = 0;
+    task.nCalib = 0;
+    task.start = (Long64_t)gSystem->Now();
+}
+
+//______________________________________________________________________________
+static Int_t GetStreamQueueSize()
+{
+    // Return the maximum number of chunks in the queue of the streaming
+    // export/import pipeline.
+
+    Int_t n = TCReadConfig::GetReader()->GetConfigInt("DB.Stream.QueueSize");
+    return n > 0 ? n : 4;
+}
+
+//______________________________________________________________________________
+void TCMySQLManager::ExportStream(TCContainer* file, TCMySQLManager* db,
+                                  Int_t first_run, Int_t last_run, TList* calibrations,
+                                  const Char_t* location, Int_t* outNRunsDump, Int_t* outNCalibDump,
+                                  Int_t* outNRunsWrite, Int_t* outNCalibWrite)
+{
+    // Export the runs from run 'first_run' to run 'last_run' and all sets of
+    // the calibrations in the list 'calibrations' (TObjString, can be 0) to
+    // the container file 'file' opened by TCContainer::BeginSave() or, if
+    // 'file' is zero, to the database of the manager 'db'.
+    // If first_run and last_run is zero all runs are exported, if one of them
+    // is -1 no runs are exported.
+    // The runs and sets are dumped in chunks while a second thread writes the
+    // chunks to the target. Both stages are connected by a bounded queue.
+    // 'location' is used for the progress information.
+    // The number of dumped and written runs and calibrations is written to
+    // 'outNRunsDump', 'outNCalibDump', 'outNRunsWrite' and 'outNCalibWrite'.
+
+    // get runs
+    Int_t nruns = 0;
+    Int_t* runs = 0;
+    if (first_run != -1 && last_run != -1) runs = GetRunList(first_run, last_run, &nruns);
+
+    // init task
+    TCDataQueue queue(GetStreamQueueSize());
+    StreamTask task;
+    InitStreamTask(task, &queue, location, fSilence);
+    task.file = file;
+    task.db = db;
+    task.nRunsTotal = nruns;
+
+    // start the consumer
+    TThread consumer(TString::Format("TCMySQLManager_%s", location).Data(), StreamConsumer, &task);
+    consumer.Run();
+
+    // dump runs in chunks
+    Int_t nRunsDump = 0;
+    Int_t nCalibDump = 0;
+    for (Int_t i = 0; i < nruns; i += task.chunkSize)
+    {
+        TCContainer* chunk = new TCContainer("chunk");
+        nRunsDump += DumpRuns(chunk, runs[i], runs[TMath::Min(i + task.chunkSize, nruns) - 1]);
+        if (!queue.Push(chunk))
+        {
+            delete chunk;
+            break;
+        }
+    }
+
+    // dump the sets of all calibration data of all calibrations
+    TIter next_calib(calibrations);
+    TObjString* s;
+    while ((s = (TObjString*)next_calib()))
+    {
+        TIter next_data(fData);
+        TCCalibData* d;
+        while ((d = (TCCalibData*)next_data()))
+        {
+            TCContainer* chunk = new TCContainer("chunk");
+            Int_t n = DumpCalibrations(chunk, s->GetString().Data(), d->GetName());
+            nCalibDump += n;
+            if (!n || !queue.Push(chunk)) delete chunk;
+        }
+    }
+
+    // wait for the consumer
+    queue.Close();
+    consumer.Join();
+
+    // user information
+    if (!fSilence)
+    {
+        Double_t t = TMath::Max((Long64_t)gSystem->Now() - task.start, (Long64_t)1) / 1000.;
+        Info(location, "Wrote %d runs and %d calibrations in %.1f s (%.1f runs/s, %.1f calibrations/s)",
+             task.nRuns, task.nCalib, t, task.nRuns/t, task.nCalib/t);
+    }
+
+    // clean-up
+    if (runs) delete [] runs;
+
+    // set results
+    if (outNRunsDump) *outNRunsDump = nRunsDump;
+    if (outNCalibDump) *outNCalibDump = nCalibDump;
+    if (outNRunsWrite) *outNRunsWrite = task.nRuns;
+    if (outNCalibWrite) *outNCalibWrite = task.nCalib;
+}
+
+//______________________________________________________________________________
+void TCMySQLManager::ImportStream(TCContainer* container, Bool_t runs, Bool_t calibrations,
+                                  const Char_t* newCalibName, Int_t* outNRuns, Int_t* outNCalib)
+{
+    // Import the runs (if 'runs' is kTRUE) and/or the calibrations (if
+    // 'calibrations' is kTRUE) of the CaLib container 'container' returned by
+    // OpenContainer() to the database.
+    // If 'newCalibName' is non-zero rename the calibration to 'newCalibName'
+    // Containers of the current format are read in chunks by a second thread
+    // while the chunks are written to the database.
+    // The number of imported runs and calibrations is written to 'outNRuns'
+    // and 'outNCalib'.
+
+    Int_t nRuns = 0;
+    Int_t nCalib = 0;
+
+    // import old format (already in memory)
+    if (container->GetVersion() == TCConfig::kContainerFormatVersionOld)
+    {
+        if (runs) nRuns = ImportRuns(container);
+        if (calibrations) nCalib = ImportCalibrations(container, newCalibName);
+    }
+    else
+    {
+        // init task
+        TCDataQueue queue(GetStreamQueueSize());
+        StreamTask task;
+        InitStreamTask(task, &queue, "Import", fSilence);
+        task.source = container;
+        task.runs = runs;
+        task.calibrations = calibrations;
+        task.db = this;
+        task.newCalibName = newCalibName;
+        task.nRunsTotal = runs ? container->GetNSavedRuns() : 0;
+
+        // start the producer
+        TThread producer("TCMySQLManager_Import", StreamProducer, &task);
+        producer.Run();
+
+        // write the chunks
+        StreamConsumer(&task);
+
+        // wait for the producer
+        queue.Close();
+        producer.Join();
+
+        nRuns = task.nRuns;
+        nCalib = task.nCalib;
+    }
+
+    // set results
+    if (outNRuns) *outNRuns = nRuns;
+    if (outNCalib) *outNCalib = nCalib;
+}
+
 //______________________________________________________________________________
 void TCMySQLManager::Export(const Char_t* filename, Int_t first_run, Int_t last_run,
                             const Char_t* calibration)
 {
-    // Export run and/or calibration data to the ROOT file 'filename'
+    // Export run and/or calibration data to the ROOT file 'filename' or, if
+    // 'filename' starts with 'sqlite://', to the new SQLite database
+    // 'filename' (e.g. 'sqlite://export.db').
     //
     // If 'first_run' is non-zero and 'last_run' is non-zero run information from run
     // 'first_run' to run 'last_run' is exported.
@@ -3702,59 +4838,105 @@ void TCMySQLManager::Export(const Char_t* filename, Int_t first_run, Int_t last_
     // If 'calibration' is non-zero the calibration with the identifier 'calibration'
     // is exported.
 
-    // create new container
-    TCContainer* container = new TCContainer(TCConfig::kCaLibDumpName);
+    // calibrations to export
+    TList calibrations;
+    calibrations.SetOwner(kTRUE);
+    if (calibration) calibrations.Add(new TObjString(calibration));
+
+    // export to an SQLite database
+    Int_t nRuns;
+    Int_t nCalib;
+    TString fn(filename);
+    if (fn.BeginsWith("sqlite://"))
+    {
+        // check if file exists
+        Char_t* fnt = gSystem->ExpandPathName(fn.Data() + 9);
+        Bool_t exists = !gSystem->AccessPathName(fnt);
+        delete fnt;
+        if (exists)
+        {
+            if (!fSilence) Error("Export", "Database '%s' exists already!", filename);
+            return;
+        }
 
-    // dump runs to container
-    if (first_run != -1 && last_run != -1)
-    {
-        DumpRuns(container, first_run, last_run);
-        if (!fSilence)
+        // connect to the database
+        TSQLServer* db = TSQLServer::Connect(filename, "", "");
+        if (!db || db->IsZombie())
         {
-            if (container->GetNRuns())
-                Info("Export", "Dumped %d runs to '%s'", container->GetNRuns(), filename);
-            else
-                Error("Export", "No runs were dumped to '%s'!", filename);
+            if (!fSilence) Error("Export", "Cannot connect to the database '%s'!", filename);
+            if (db) delete db;
+            return;
         }
+
+        // create the target database manager (owns the connection)
+        TCMySQLManager target(db, kSQLite);
+        target.SetSilenceMode(fSilence);
+        if (!target.InitDatabase(kFALSE)) return;
+
+        // export runs and calibrations
+        ExportStream(0, &target, first_run, last_run, &calibrations, "Export",
+                     0, 0, &nRuns, &nCalib);
     }
+    else
+    {
+        // create the container file
+        TCContainer container(TCConfig::kCaLibDumpName);
+        if (!container.BeginSave(filename, fSilence)) return;
+
+        // export runs and calibrations
+        ExportStream(&container, 0, first_run, last_run, &calibrations, "Export",
+                     0, 0, &nRuns, &nCalib);
 
-    // dump runs to container
-    if (calibration)
+        // finish the file
+        container.EndSave(fSilence);
+    }
+
+    // user information
+    if (!fSilence)
     {
-        DumpAllCalibrations(container, calibration);
-        if (!fSilence)
+        if (first_run != -1 && last_run != -1)
+        {
+            if (nRuns)
+                Info("Export", "Dumped %d runs to '%s'", nRuns, filename);
+            else
+                Error("Export", "No runs were dumped to '%s'!", filename);
+        }
+        if (calibration)
         {
-            if (container->GetNCalibrations())
-                Info("Export", "Dumped %d calibrations to '%s'", container->GetNCalibrations(), filename);
+            if (nCalib)
+                Info("Export", "Dumped %d calibrations to '%s'", nCalib, filename);
             else
                 Error("Export", "No calibrations were dumped to '%s'!", filename);
         }
     }
-
-    // save container to ROOT file
-    container->Save(filename, fSilence);
-
-    // clean-up
-    delete container;
 }
 
 //______________________________________________________________________________
-TCContainer* TCMySQLManager::LoadContainer(const Char_t* filename)
+TCContainer* TCMySQLManager::OpenContainer(const Char_t* filename, TFile*& outFile)
 {
-    // Load the CaLib container from the ROOT file 'filename'.
-    // Return the container if found, otherwise 0.
-    // NOTE: The container must be destroyed by the caller.
+    // Open the CaLib container of the ROOT file 'filename' for loading.
+    // Containers of the previous format version (single object with fixed
+    // size strings) are loaded completely, containers of the current format
+    // are prepared for loading via TCContainer::LoadRun() and
+    // TCContainer::LoadCalibration().
+    // Return the container if found, otherwise 0. The opened file is written
+    // to 'outFile'.
+    // NOTE: The container must be destroyed and the file must be closed by
+    //       the caller after calling TCContainer::EndLoad().
+
+    outFile = 0;
 
     // try to open the ROOT file
     TFile* f = new TFile(filename);
     if (!f)
     {
-        if (!fSilence) Error("LoadContainer", "Could not open the ROOT file '%s'!", filename);
+        if (!fSilence) Error("OpenContainer", "Could not open the ROOT file '%s'!", filename);
         return 0;
     }
     if (f->IsZombie())
     {
-        if (!fSilence) Error("LoadContainer", "Could not open the ROOT file '%s'!", filename);
+        if (!fSilence) Error("OpenContainer", "Could not open the ROOT file '%s'!", filename);
+        delete f;
         return 0;
     }
 
@@ -3762,22 +4944,71 @@ TCContainer* TCMySQLManager::LoadContainer(const Char_t* filename)
     TCContainer* c_orig = (TCContainer*) f->Get(TCConfig::kCaLibDumpName);
     if (!c_orig)
     {
-        if (!fSilence) Error("LoadContainer", "No CaLib container found in ROOT file '%s'!", filename);
+        if (!fSilence) Error("OpenContainer", "No CaLib container found in ROOT file '%s'!", filename);
         delete f;
         return 0;
     }
 
-    // clone the container
-    TCContainer* c = (TCContainer*) c_orig->Clone();
-
     // check container format
-    if (c->GetVersion() != TCConfig::kContainerFormatVersion)
+    if (c_orig->GetVersion() != TCConfig::kContainerFormatVersion &&
+        c_orig->GetVersion() != TCConfig::kContainerFormatVersionOld)
     {
-        if (!fSilence) Error("LoadContainer", "Cannot load CaLib container format version %d - "
-                                              "use the corresponding CaLib version instead!", c->GetVersion());
+        if (!fSilence) Error("OpenContainer", "Cannot load CaLib container format version %d - "
+                                              "use the corresponding CaLib version instead!", c_orig->GetVersion());
+        delete c_orig;
+        delete f;
         return 0;
     }
 
+    // clone the container (contains all data in the old format)
+    TCContainer* c = (TCContainer*) c_orig->Clone();
+    delete c_orig;
+
+    // prepare loading the runs and calibrations from the trees
+    if (c->GetVersion() != TCConfig::kContainerFormatVersionOld)
+    {
+        if (!c->BeginLoad(f))
+        {
+            if (!fSilence) Error("OpenContainer", "Could not load CaLib data from ROOT file '%s'!", filename);
+            delete c;
+            delete f;
+            return 0;
+        }
+    }
+
+    outFile = f;
+
+    return c;
+}
+
+//______________________________________________________________________________
+TCContainer* TCMySQLManager::LoadContainer(const Char_t* filename)
+{
+    // Load the CaLib container from the ROOT file 'filename'.
+    // Containers of the previous format version (single object with fixed
+    // size strings) are loaded as well.
+    // Return the container if found, otherwise 0.
+    // NOTE: The container must be destroyed by the caller.
+
+    // open the container
+    TFile* f;
+    TCContainer* c = OpenContainer(filename, f);
+    if (!c) return 0;
+
+    // load the runs and calibrations from the trees
+    if (c->GetVersion() != TCConfig::kContainerFormatVersionOld)
+    {
+        Bool_t ok = c->LoadAll();
+        c->EndLoad();
+        if (!ok)
+        {
+            if (!fSilence) Error("LoadContainer", "Could not load CaLib data from ROOT file '%s'!", filename);
+            delete c;
+            delete f;
+            return 0;
+        }
+    }
+
     // clean-up
     delete f;
 
@@ -3786,56 +5017,62 @@ TCContainer* TCMySQLManager::LoadContainer(const Char_t* filename)
 
 //______________________________________________________________________________
 void TCMySQLManager::Import(const Char_t* filename, Bool_t runs, Bool_t calibrations,
-                            const Char_t* newCalibName)
+                            const Char_t* newCalibName, Bool_t interact)
 {
     // Import run and/or calibration data from the ROOT file 'filename'
     //
     // If 'runs' is kTRUE all run information is imported.
     // If 'calibrations' is kTRUE all calibration information is imported.
     // If 'newCalibName' is non-zero rename the calibration to 'newCalibName'
+    // If 'interact' is kTRUE the user has to confirm the import.
 
-    // try to load the container
-    TCContainer* c = LoadContainer(filename);
+    // try to open the container
+    TFile* f;
+    TCContainer* c = OpenContainer(filename, f);
     if (!c)
     {
         if (!fSilence) Error("Import", "CaLib container could not be loaded from '%s'", filename);
         return;
     }
+    Bool_t oldFormat = c->GetVersion() == TCConfig::kContainerFormatVersionOld;
 
     // import runs
     if (runs)
     {
         // get number of runs
-        Int_t nRun = c->GetNRuns();
+        Int_t nRun = oldFormat ? c->GetNRuns() : (Int_t)c->GetNSavedRuns();
 
         // check if some runs were found
         if (nRun)
         {
             // ask for user confirmation
-            Char_t answer[256];
-            if (fDBType == kSQLite)
-            {
-                printf("\n%d runs were found in the ROOT file '%s'\n"
-                       "They will be added to the database '%s'\n",
-                       nRun, filename, fDB->GetDB());
-            }
-            else
-            {
-                printf("\n%d runs were found in the ROOT file '%s'\n"
-                       "They will be added to the database '%s' on '%s'\n",
-                       nRun, filename, fDB->GetDB(), fDB->GetHost());
-            }
-            printf("Are you sure to continue? (yes/no) : ");
-            Int_t ret = scanf("%s", answer);
-            if (strcmp(answer, "yes"))
-            {
-                printf("Aborted.\n");
-            }
-            else
+            Bool_t confirmed = kTRUE;
+            if (interact)
             {
-                // import all runs
-                ImportRuns(c);
+                Char_t answer[256] = "";
+                if (fDBType == kSQLite)
+                {
+                    printf("\n%d runs were found in the ROOT file '%s'\n"
+                           "They will be added to the database '%s'\n",
+                           nRun, filename, fDB->GetDB());
+                }
+                else
+                {
+                    printf("\n%d runs were found in the ROOT file '%s'\n"
+                           "They will be added to the database '%s' on '%s'\n",
+                           nRun, filename, fDB->GetDB(), fDB->GetHost());
+                }
+                printf("Are you sure to continue? (yes/no) : ");
+                Int_t ret = scanf("%s", answer);
+                if (strcmp(answer, "yes"))
+                {
+                    printf("Aborted.\n");
+                    confirmed = kFALSE;
+                }
             }
+
+            // import all runs
+            if (confirmed) ImportStream(c, kTRUE, kFALSE);
         }
         else
         {
@@ -3847,40 +5084,46 @@ void TCMySQLManager::Import(const Char_t* filename, Bool_t runs, Bool_t calibrat
     if (calibrations)
     {
         // get number of calibrations
-        Int_t nCalib = c->GetNCalibrations();
+        Int_t nCalib = oldFormat ? c->GetNCalibrations() : (Int_t)c->GetNSavedCalibrations();
 
         // check if some calibrations were found
         if (nCalib)
         {
             // get name of calibrations
-            const Char_t* calibName = c->GetCalibration(0)->GetCalibration();
+            TCCalibration first;
+            if (oldFormat) first.SetCalibration(c->GetCalibration(0)->GetCalibration());
+            else c->LoadCalibration(0, &first);
+            const Char_t* calibName = first.GetCalibration();
 
             // ask for user confirmation
-            Char_t answer[256];
-            if (fDBType == kSQLite)
-            {
-                printf("\n%d calibrations named '%s' were found in the ROOT file '%s'\n"
-                       "They will be added to the database '%s'\n",
-                       nCalib, calibName, filename, fDB->GetDB());
-            }
-            else
-            {
-                printf("\n%d calibrations named '%s' were found in the ROOT file '%s'\n"
-                       "They will be added to the database '%s' on '%s'\n",
-                       nCalib, calibName, filename, fDB->GetDB(), fDB->GetHost());
-            }
-            if (newCalibName) printf("The calibrations will be renamed to '%s'\n", newCalibName);
-            printf("Are you sure to continue? (yes/no) : ");
-            Int_t ret = scanf("%s", answer);
-            if (strcmp(answer, "yes"))
-            {
-                printf("Aborted.\n");
-            }
-            else
+            Bool_t confirmed = kTRUE;
+            if (interact)
             {
-                // import all runs
-                ImportCalibrations(c, newCalibName);
+                Char_t answer[256] = "";
+                if (fDBType == kSQLite)
+                {
+                    printf("\n%d calibrations named '%s' were found in the ROOT file '%s'\n"
+                           "They will be added to the database '%s'\n",
+                           nCalib, calibName, filename, fDB->GetDB());
+                }
+                else
+                {
+                    printf("\n%d calibrations named '%s' were found in the ROOT file '%s'\n"
+                           "They will be added to the database '%s' on '%s'\n",
+                           nCalib, calibName, filename, fDB->GetDB(), fDB->GetHost());
+                }
+                if (newCalibName) printf("The calibrations will be renamed to '%s'\n", newCalibName);
+                printf("Are you sure to continue? (yes/no) : ");
+                Int_t ret = scanf("%s", answer);
+                if (strcmp(answer, "yes"))
+                {
+                    printf("Aborted.\n");
+                    confirmed = kFALSE;
+                }
             }
+
+            // import all calibrations
+            if (confirmed) ImportStream(c, kFALSE, kTRUE, newCalibName);
         }
         else
         {
@@ -3889,99 +5132,442 @@ void TCMySQLManager::Import(const Char_t* filename, Bool_t runs, Bool_t calibrat
     }
 
     // clean-up
+    c->EndLoad();
     delete c;
+    delete f;
 }
 
 //______________________________________________________________________________
-Bool_t TCMySQLManager::ExportDatabase(const Char_t* filename)
+// column types used by the database replication
+enum EReplicaType
 {
-    // Export the complete database to the SQLite database 'filename'.
+    kReplicaString,
+    kReplicaInt,
+    kReplicaDouble
+};
 
-    Char_t tmp[256];
-    Char_t fn[256];
+// buffered column value of the database replication
+struct ReplicaValue
+{
+    Bool_t null;                        // null value flag
+    Long64_t i;                         // integer value
+    Double_t d;                         // floating point value
+    TString s;                          // string value
+};
 
-    // expand filename
-    Char_t* fnt = gSystem->ExpandPathName(filename);
-    strcpy(fn, fnt);
-    delete fnt;
+//______________________________________________________________________________
+static EReplicaType GetReplicaType(const Char_t* column)
+{
+    // Return the type used to replicate the column 'column' of the CaLib
+    // tables. Parameters are copied as floating point values to preserve the
+    // full precision, timestamps are copied as strings.
+
+    TString c(column);
+    if (c.BeginsWith("par_") || c.EndsWith("_deg")) return kReplicaDouble;
+    if (c == "run" || c == "size" || c == "scr_n" || c == "first_run" || c == "last_run" ||
+        c == "first_scr" || c == "last_scr") return kReplicaInt;
+    return kReplicaString;
+}
 
-    // check if file exists
-    if (!gSystem->AccessPathName(fn))
+//______________________________________________________________________________
+static TSQLStatement* PrepareReplicaInsert(TSQLServer* db, const Char_t* table,
+                                           const Char_t* columns, Int_t ncol, Int_t nrow)
+{
+    // Prepare the statement inserting 'nrow' rows of the 'ncol' columns
+    // 'columns' into the table 'table' of the database 'db'. Existing rows
+    // with the same primary key are replaced.
+
+    TString sql = TString::Format("REPLACE INTO %s (%s) VALUES ", table, columns);
+    for (Int_t i = 0; i < nrow; i++)
     {
-        if (!fSilence) Error("ExportDatabase", "File '%s' exists already!", fn);
-        return kFALSE;
+        sql.Append(i ? ", (" : "(");
+        for (Int_t j = 0; j < ncol; j++) sql.Append(j ? ", ?" : "?");
+        sql.Append(")");
+    }
+
+    return db->Statement(sql.Data());
+}
+
+//______________________________________________________________________________
+static Bool_t BindReplicaRows(TSQLStatement* stmt, const ReplicaValue* val, const EReplicaType* type,
+                              Int_t ncol, Int_t nrow)
+{
+    // Bind the 'nrow' buffered rows 'val' of 'ncol' columns of the types 'type'
+    // to the next iteration of the prepared statement 'stmt'.
+    // Return kFALSE if an error occurred, otherwise kTRUE.
+
+    if (!stmt->NextIteration()) return kFALSE;
+    for (Int_t i = 0; i < nrow*ncol; i++)
+    {
+        Bool_t ok;
+        if (val[i].null) ok = stmt->SetNull(i);
+        else if (type[i % ncol] == kReplicaInt) ok = stmt->SetLong64(i, val[i].i);
+        else if (type[i % ncol] == kReplicaDouble) ok = stmt->SetDouble(i, val[i].d);
+        else ok = stmt->SetString(i, val[i].s.Data(), TMath::Max(1025, val[i].s.Length() + 1));
+        if (!ok) return kFALSE;
     }
 
-    // open SQLite database
-    sprintf(tmp, "sqlite://%s", fn);
-    TSQLServer* db = TSQLServer::Connect(tmp, "", "");
+    return kTRUE;
+}
+
+//______________________________________________________________________________
+static THashList* GetReplicaKeys(TSQLResult* res)
+{
+    // Return the list of keys (TObjString, must be deleted by the caller) of
+    // all rows of the result 'res' of a query selecting the key columns of
+    // a CaLib table. The columns of a key are separated by tabs.
+
+    THashList* keys = new THashList();
+    keys->SetOwner(kTRUE);
+    if (!res) return keys;
 
-    // check DB connection
-    if (!db || db->IsZombie())
+    // loop over rows
+    TSQLRow* row;
+    while ((row = res->Next()))
     {
-        if (!fSilence) Error("ExportDatabase", "Cannot connect to the database '%s'!", fn);
+        TString key;
+        for (Int_t i = 0; i < res->GetFieldCount(); i++)
+        {
+            if (i) key.Append("\t");
+            key.Append(row->GetField(i) ? row->GetField(i) : "");
+        }
+        keys->Add(new TObjString(key));
+        delete row;
+    }
+
+    return keys;
+}
+
+//______________________________________________________________________________
+Bool_t TCMySQLManager::DeleteReplicaRows(TCMySQLManager* target, const Char_t* table,
+                                         const Char_t* since)
+{
+    // Delete the rows of the table 'table' of the database of the manager
+    // 'target' that are replaced in the incremental replication, i.e., all
+    // rows whose 'changed' timestamp is not older than 'since', and all rows
+    // that do not exist in this database anymore, e.g. sets that were
+    // removed or merged.
+    // Return kFALSE if an error occurred, otherwise kTRUE.
+
+    // key columns of the table (the main table has no primary key)
+    Bool_t main = !strcmp(table, TCConfig::kCalibMainTableName);
+    const Char_t* cols = main ? "run" : "calibration, first_run";
+
+    // remove the rows that are copied again
+    if (!target->SendExec(TString::Format("DELETE FROM %s WHERE changed >= '%s'", table, since).Data()))
+        return kFALSE;
+
+    // get the keys of both tables
+    TString query = TString::Format("SELECT %s FROM %s", cols, table);
+    TSQLResult* res = SendQuery(query.Data());
+    if (!res) return kFALSE;
+    THashList* source = GetReplicaKeys(res);
+    delete res;
+    res = target->SendQuery(query.Data());
+    if (!res)
+    {
+        delete source;
         return kFALSE;
     }
+    THashList* dest = GetReplicaKeys(res);
+    delete res;
+
+    // remove rows that were deleted in this database
+    Bool_t ok = kTRUE;
+    Int_t nDel = 0;
+    TIter next(dest);
+    TObjString* s;
+    while (ok && (s = (TObjString*)next()))
+    {
+        if (source->FindObject(s->GetString().Data())) continue;
+
+        // delete the row
+        TString sql;
+        if (main)
+            sql = TString::Format("DELETE FROM %s WHERE run = %s", table, s->GetString().Data());
+        else
+        {
+            Int_t pos = s->GetString().Index("\t");
+            TString calib = s->GetString()(0, pos);
+            TString first_run = s->GetString()(pos + 1, s->GetString().Length());
+            sql = TString::Format("DELETE FROM %s WHERE calibration = '%s' AND first_run = %s",
+                                  table, calib.Data(), first_run.Data());
+        }
+        ok = target->SendExec(sql.Data());
+        nDel++;
+    }
 
-    // create new container
-    TCContainer* container = new TCContainer(TCConfig::kCaLibDumpName);
+    // user information
+    if (ok && nDel && !fSilence)
+        Info("DeleteReplicaRows", "Deleted %d rows of '%s' that were removed", nDel, table);
 
-    // dump runs to container
-    Int_t nRunExp = TCMySQLManager::GetManager()->DumpRuns(container);
-    if (!fSilence) Info("ExportDatabase", "Exported %d runs to '%s'", nRunExp, fn);
+    // clean-up
+    delete source;
+    delete dest;
 
-    // get all calibrations
-    TList* c = TCMySQLManager::GetManager()->GetAllCalibrations();
+    return ok;
+}
 
-    // dump all calibrations to container
-    Int_t nCalibExp = 0;
-    Int_t nCalib = c->GetSize();
-    if (!fSilence) Info("ExportDatabase", "Exporting %d calibrations to '%s'", nCalib, fn);
-    for (Int_t i = 0; i < nCalib; i++)
+//______________________________________________________________________________
+Long64_t TCMySQLManager::ReplicateTable(TCMySQLManager* target, const Char_t* table,
+                                        Bool_t incremental)
+{
+    // Copy the rows of the table 'table' to the same table of the database
+    // of the manager 'target'.
+    // If 'incremental' is kTRUE only rows whose 'changed' timestamp is not
+    // older than the newest row of the target table are copied and rows of
+    // the target table that were deleted in this database are removed (see
+    // DeleteReplicaRows()). Tables without timestamp are copied completely.
+    // The rows are read via a statement from this database and written via
+    // prepared multi-row statements inside one transaction on the target.
+    // Only the columns of the target table are copied, i.e., obsolete columns
+    // of upgraded databases (e.g. 'scr_bad' of the main table) are skipped.
+    // Existing rows with the same primary key are replaced.
+    // Return the number of copied rows or -1 if an error occurred.
+
+    Long64_t start = (Long64_t)gSystem->Now();
+    Bool_t timestamp = strcmp(table, TCConfig::kCalibBadScRTableName) != 0;
+
+    // get the columns of the target table
+    TSQLResult* res_col = target->SendQuery(TString::Format("SELECT * FROM %s LIMIT 0", table).Data());
+    if (!res_col || !res_col->GetFieldCount())
+    {
+        if (!fSilence) Error("ReplicateTable", "Could not read the columns of the target table '%s'!", table);
+        if (res_col) delete res_col;
+        return -1;
+    }
+    TString columns;
+    for (Int_t i = 0; i < res_col->GetFieldCount(); i++)
     {
-        TObjString* s = (TObjString*) c->At(i);
-        nCalibExp += TCMySQLManager::GetManager()->DumpAllCalibrations(container, s->GetString().Data());
-        if (!fSilence) Info("ExportDatabase", "Exported calibration '%s'", s->GetString().Data());
+        if (i) columns.Append(", ");
+        columns.Append(res_col->GetFieldName(i));
     }
+    delete res_col;
 
-    // backup original database config
-    TSQLServer* db_orig = fDB;
-    ServerType_t type_orig = fDBType;
+    // create the query
+    TString query = TString::Format("SELECT %s FROM %s", columns.Data(), table);
+    TString since;
+    if (incremental && timestamp)
+    {
+        // get the newest row of the target table
+        TSQLResult* res = target->SendQuery(TString::Format("SELECT MAX(changed) FROM %s", table).Data());
+        TSQLRow* row = res ? res->Next() : 0;
+        if (row && row->GetField(0))
+        {
+            since = row->GetField(0);
+            query.Append(TString::Format(" WHERE changed >= '%s'", since.Data()));
+        }
+        if (row) delete row;
+        if (res) delete res;
+    }
 
-    // configure db connection to SQLite database
-    fDB = db;
-    fDBType = kSQLite;
+    // read from source
+    TSQLStatement* sel = fDB->Statement(query.Data());
+    if (!sel || !sel->Process() || !sel->StoreResult())
+    {
+        if (!fSilence) Error("ReplicateTable", "Could not read the table '%s'!", table);
+        if (sel) delete sel;
+        return -1;
+    }
 
-    // init the database
-    InitDatabase(kFALSE);
+    // get column types
+    Int_t ncol = sel->GetNumFields();
+    EReplicaType* type = new EReplicaType[ncol];
+    for (Int_t i = 0; i < ncol; i++) type[i] = GetReplicaType(sel->GetFieldName(i));
 
-    // import runs
-    Int_t nRunImp = TCMySQLManager::GetManager()->ImportRuns(container);
+    // number of rows per statement (the number of statement parameters is
+    // limited to 999 in SQLite)
+    Int_t nrow = TMath::Max(1, TMath::Min(100, 999 / TMath::Max(ncol, 1)));
+    ReplicaValue* val = new ReplicaValue[nrow*ncol];
 
-    // import calibrations
-    Int_t nCalibImp = TCMySQLManager::GetManager()->ImportCalibrations(container);
+    // start transaction
+    Bool_t ok = target->fDB->StartTransaction();
+
+    // remove old rows of tables without timestamp
+    if (ok && incremental && !timestamp)
+        ok = target->SendExec(TString::Format("DELETE FROM %s", table).Data());
+
+    // remove deleted and outdated rows of tables with timestamp
+    if (ok && incremental && timestamp && since.Length())
+        ok = DeleteReplicaRows(target, table, since.Data());
+
+    // copy rows
+    TSQLStatement* ins = ok ? PrepareReplicaInsert(target->fDB, table, columns.Data(), ncol, nrow) : 0;
+    if (!ins) ok = kFALSE;
+    Long64_t nCopy = 0;
+    Int_t nBuf = 0;
+    Bool_t pending = kFALSE;
+    while (ok && sel->NextResultRow())
+    {
+        // buffer row
+        for (Int_t i = 0; i < ncol; i++)
+        {
+            ReplicaValue& v = val[nBuf*ncol + i];
+            v.null = sel->IsNull(i);
+            if (v.null) continue;
+            if (type[i] == kReplicaInt) v.i = sel->GetLong64(i);
+            else if (type[i] == kReplicaDouble) v.d = sel->GetDouble(i);
+            else v.s = sel->GetString(i);
+        }
+        nBuf++;
+        nCopy++;
+
+        // bind full buffer
+        if (nBuf == nrow)
+        {
+            ok = BindReplicaRows(ins, val, type, ncol, nrow);
+            pending = kTRUE;
+            nBuf = 0;
+        }
+    }
 
-    // restore original db connection
-    fDB = db_orig;
-    fDBType = type_orig;
+    // write the last iteration of the full statement
+    if (ok && pending) ok = ins->Process();
+
+    // write remaining rows
+    if (ok && nBuf)
+    {
+        TSQLStatement* rest = PrepareReplicaInsert(target->fDB, table, columns.Data(), ncol, nBuf);
+        ok = rest && BindReplicaRows(rest, val, type, ncol, nBuf) && rest->Process();
+        if (rest) delete rest;
+    }
+
+    // finish transaction
+    if (ok) ok = target->fDB->Commit();
+    else target->fDB->Rollback();
 
     // clean-up
-    delete c;
-    delete container;
-    delete db;
+    if (ins) delete ins;
+    delete sel;
+    delete [] val;
+    delete [] type;
+
+    // check result
+    if (!ok)
+    {
+        if (!fSilence) Error("ReplicateTable", "Could not copy the table '%s'!", table);
+        return -1;
+    }
+
+    // user information
+    if (!fSilence)
+    {
+        Double_t t = TMath::Max((Long64_t)gSystem->Now() - start, (Long64_t)1) / 1000.;
+        Info("ReplicateTable", "Copied %lld rows of '%s' (%.0f rows/s)", nCopy, table, nCopy/t);
+    }
+
+    return nCopy;
+}
+
+//______________________________________________________________________________
+Bool_t TCMySQLManager::Replicate(TCMySQLManager* target, Bool_t incremental)
+{
+    // Copy the main table, the bad scaler read table and all data tables to
+    // the database of the manager 'target' (see ReplicateTable()).
+    // Return kFALSE if an error occurred, otherwise kTRUE.
+
+    // collect tables
+    TList tables;
+    tables.SetOwner(kTRUE);
+    tables.Add(new TObjString(TCConfig::kCalibMainTableName));
+    tables.Add(new TObjString(TCConfig::kCalibBadScRTableName));
+    TIter next_data(fData);
+    TCCalibData* d;
+    while ((d = (TCCalibData*)next_data()))
+        if (!tables.FindObject(d->GetTableName())) tables.Add(new TObjString(d->GetTableName()));
+
+    // copy tables
+    Bool_t ok = kTRUE;
+    Long64_t nCopy = 0;
+    TIter next(&tables);
+    TObjString* s;
+    while ((s = (TObjString*)next()))
+    {
+        Long64_t n = ReplicateTable(target, s->GetString().Data(), incremental);
+        if (n < 0) ok = kFALSE;
+        else nCopy += n;
+    }
+
+    // user information
+    if (!fSilence) Info("Replicate", "Copied %lld rows of %d tables", nCopy, tables.GetSize());
+
+    return ok;
+}
+
+//______________________________________________________________________________
+Bool_t TCMySQLManager::ReplicateDatabase(const Char_t* url, const Char_t* user, const Char_t* pass,
+                                         Bool_t incremental)
+{
+    // Copy the complete database to the database 'url' (e.g. 'sqlite://file.db'
+    // or 'mysql://host/name') using the login 'user' and 'pass'.
+    // If 'incremental' is kTRUE only the rows changed since the last copy are
+    // written to the existing target database and rows deleted in this
+    // database are removed from it. Otherwise the target database is
+    // initialized first, i.e., all existing CaLib tables are deleted!
+    // Return kFALSE if an error occurred, otherwise kTRUE.
 
-    // make some checks
-    if (nRunImp != nRunExp)
+    // get server type
+    ServerType_t type;
+    TString u(url);
+    if (u.BeginsWith("sqlite://")) type = kSQLite;
+    else if (u.BeginsWith("mysql://")) type = kMySQL;
+    else
     {
-        if (!fSilence) Error("ExportDatabase", "Could not export all runs!");
+        if (!fSilence) Error("ReplicateDatabase", "Unsupported database '%s'!", url);
         return kFALSE;
     }
-    if (nCalibImp != nCalibExp)
+
+    // check source
+    if (!IsConnected()) return kFALSE;
+    if (!fDB->HasStatement())
     {
-        if (!fSilence) Error("ExportDatabase", "Could not export all calibrations!");
+        if (!fSilence) Error("ReplicateDatabase", "Database does not support statements!");
         return kFALSE;
     }
 
-    return kTRUE;
+    // connect to the target
+    TSQLServer* db = TSQLServer::Connect(url, user, pass);
+    if (!db || db->IsZombie() || !db->HasStatement())
+    {
+        if (!fSilence) Error("ReplicateDatabase", "Cannot connect to the database '%s'!", url);
+        if (db) delete db;
+        return kFALSE;
+    }
+
+    // create the target database manager (owns the connection)
+    TCMySQLManager target(db, type);
+    target.SetSilenceMode(fSilence);
+
+    // init the target database
+    if (!incremental && !target.InitDatabase(kFALSE)) return kFALSE;
+
+    // copy all tables
+    return Replicate(&target, incremental);
 }
 
+//______________________________________________________________________________
+Bool_t TCMySQLManager::ExportDatabase(const Char_t* filename, Bool_t incremental)
+{
+    // Export the complete database to the SQLite database 'filename'.
+    // If 'incremental' is kTRUE and the file exists, only the rows changed
+    // since the last export are written to it.
+    // The tables are copied directly (see ReplicateDatabase()).
+
+    Char_t fn[256];
+
+    // expand filename
+    Char_t* fnt = gSystem->ExpandPathName(filename);
+    strcpy(fn, fnt);
+    delete fnt;
+
+    // check if file exists
+    Bool_t exists = !gSystem->AccessPathName(fn);
+    if (exists && !incremental)
+    {
+        if (!fSilence) Error("ExportDatabase", "File '%s' exists already!", fn);
+        return kFALSE;
+    }
+
+    // copy the tables
+    return ReplicateDatabase(TString::Format("sqlite://%s", fn).Data(), "", "", exists);
+}
@@ -0,0 +1,412 @@
+/*************************************************************************
+ * Author: Dominik Werthmueller
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TCQueryLog                                                           //
+//                                                                      //
+// Record the SQL statements sent to the database and aggregate them    //
+// into per-pattern latency statistics.                                 //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+
+#include <cstdlib>
+#include <cctype>
+#include <dlfcn.h>
+#include <cxxabi.h>
+
+#include "THashList.h"
+#include "TMutex.h"
+#include "TMath.h"
+
+#include "TCQueryLog.h"
+
+ClassImp(TCQueryPattern)
+ClassImp(TCQueryLog)
+
+// init static class members
+Bool_t TCQueryLog::fgEnabled = kFALSE;
+TCQueryLog* TCQueryLog::fgQueryLog = 0;
+
+//______________________________________________________________________________
+static TString GetCallerName(void* addr)
+{
+    // Return the demangled name of the function containing the address
+    // 'addr' without the argument list or the address itself if the symbol
+    // is unknown.
+
+    // find symbol
+    Dl_info info;
+    if (!addr || !dladdr(addr, &info) || !info.dli_sname)
+        return TString::Format("%p", addr);
+
+    // demangle
+    Int_t status;
+    Char_t* name = abi::__cxa_demangle(info.dli_sname, 0, 0, &status);
+    TString out(status == 0 && name ? name : info.dli_sname);
+    if (name) free(name);
+
+    // remove argument list
+    Ssiz_t pos = out.Index("(");
+    if (pos > 0) out.Remove(pos);
+
+    return out;
+}
+
+//______________________________________________________________________________
+static void PrintQueryLogAtExit()
+{
+    // Print the statement patterns at the program exit.
+
+    if (TCQueryLog::IsEnabled())
+        TCQueryLog::GetLog()->Print(TCQueryLog::GetLog()->GetNPrint());
+}
+
+//______________________________________________________________________________
+TCQueryPattern::TCQueryPattern(const Char_t* pattern)
+    : TNamed(pattern, pattern)
+{
+    // Constructor using the normalised statement 'pattern'.
+
+    fCalls = 0;
+    fTime = 0;
+    fTimeMax = 0;
+    fRows = 0;
+    for (Int_t i = 0; i < kNBins; i++) fHist[i] = 0;
+    fNCaller = 0;
+    for (Int_t i = 0; i < kNCaller; i++)
+    {
+        fCallerAddr[i] = 0;
+        fCallerCalls[i] = 0;
+    }
+    fCallerOther = 0;
+}
+
+//______________________________________________________________________________
+void TCQueryPattern::Add(Long64_t nsec, Long64_t rows, void* caller)
+{
+    // Add a call of the latency 'nsec' nanoseconds returning 'rows' rows
+    // (negative if unknown) from the calling site 'caller'.
+
+    // update statistics
+    fCalls++;
+    fTime += nsec;
+    if (nsec > fTimeMax) fTimeMax = nsec;
+    if (rows > 0) fRows += rows;
+
+    // fill the latency histogram
+    Long64_t usec = nsec / 1000;
+    Int_t bin = 0;
+    while (usec > 1 && bin < kNBins-1)
+    {
+        usec >>= 1;
+        bin++;
+    }
+    fHist[bin]++;
+
+    // count the calling site
+    for (Int_t i = 0; i < fNCaller; i++)
+    {
+        if (fCallerAddr[i] == caller)
+        {
+            fCallerCalls[i]++;
+            return;
+        }
+    }
+    if (fNCaller < kNCaller)
+    {
+        fCallerAddr[fNCaller] = caller;
+        fCallerCalls[fNCaller] = 1;
+        fNCaller++;
+    }
+    else fCallerOther++;
+}
+
+//______________________________________________________________________________
+Double_t TCQueryPattern::GetQuantile(Double_t q) const
+{
+    // Return the upper edge of the latency histogram bin containing the
+    // quantile 'q' in milliseconds.
+
+    if (!fCalls) return 0;
+
+    Long64_t sum = 0;
+    for (Int_t i = 0; i < kNBins; i++)
+    {
+        sum += fHist[i];
+        if (sum >= q*fCalls) return TMath::Power(2., i+1) / 1000.;
+    }
+
+    return TMath::Power(2., kNBins) / 1000.;
+}
+
+//______________________________________________________________________________
+TString TCQueryPattern::GetCallers() const
+{
+    // Return the calling functions and their numbers of calls ordered by
+    // the number of calls.
+
+    // merge calling sites of the same function
+    TString name[kNCaller];
+    Double_t calls[kNCaller];
+    Int_t n = 0;
+    for (Int_t i = 0; i < fNCaller; i++)
+    {
+        TString c = GetCallerName(fCallerAddr[i]);
+        Int_t j;
+        for (j = 0; j < n; j++)
+            if (name[j] == c) break;
+        if (j == n)
+        {
+            name[n] = c;
+            calls[n] = 0;
+            n++;
+        }
+        calls[j] += fCallerCalls[i];
+    }
+
+    // sort by number of calls
+    Int_t index[kNCaller];
+    TMath::Sort(n, calls, index);
+
+    // format
+    TString out;
+    for (Int_t i = 0; i < n; i++)
+    {
+        if (i) out.Append(", ");
+        out.Append(TString::Format("%s (%.0f)", name[index[i]].Data(), calls[index[i]]));
+    }
+    if (fCallerOther) out.Append(TString::Format(", other (%lld)", fCallerOther));
+
+    return out;
+}
+
+//______________________________________________________________________________
+TCQueryLog::TCQueryLog()
+{
+    // Constructor.
+
+    fPatterns = new THashList();
+    fPatterns->SetOwner(kTRUE);
+    fMutex = new TMutex();
+    fNPrint = 0;
+}
+
+//______________________________________________________________________________
+TCQueryLog::~TCQueryLog()
+{
+    // Destructor.
+
+    if (fPatterns) delete fPatterns;
+    if (fMutex) delete fMutex;
+}
+
+//______________________________________________________________________________
+void TCQueryLog::Enable(Int_t nPrint)
+{
+    // Enable the recording of the SQL statements. If 'nPrint' is larger than
+    // zero the 'nPrint' most expensive statement patterns are printed at the
+    // program exit.
+
+    TCQueryLog* log = GetLog();
+
+    // register the exit handler once
+    if (nPrint > 0 && !log->fNPrint) atexit(PrintQueryLogAtExit);
+    if (nPrint > 0) log->fNPrint = nPrint;
+
+    fgEnabled = kTRUE;
+}
+
+//______________________________________________________________________________
+TString TCQueryLog::Normalise(const Char_t* sql)
+{
+    // Return the statement pattern of the SQL statement 'sql'. String and
+    // numeric literals are replaced by '?', whitespace is collapsed and lists
+    // of values and multi-row values are reduced to their first element.
+
+    TString out;
+    Bool_t space = kFALSE;
+    const Char_t* p = sql;
+    while (*p)
+    {
+        // collapse whitespace
+        if (isspace(*p))
+        {
+            space = kTRUE;
+            p++;
+            continue;
+        }
+        if (space && out.Length()) out.Append(' ');
+        space = kFALSE;
+
+        // string literal
+        if (*p == '\'' || *p == '"')
+        {
+            Char_t q = *p++;
+            while (*p)
+            {
+                if (*p == '\\' && p[1]) p += 2;
+                else if (*p == q && p[1] == q) p += 2;
+                else if (*p == q) { p++; break; }
+                else p++;
+            }
+            out.Append('?');
+            continue;
+        }
+
+        // numeric literal (not part of an identifier)
+        Char_t prev = out.Length() ? out[out.Length()-1] : ' ';
+        if ((isdigit(*p) || (*p == '.' && isdigit(p[1]))) && !isalnum(prev) && prev != '_')
+        {
+            while (isalnum(*p) || *p == '.' ||
+                   ((*p == '+' || *p == '-') && (p[-1] == 'e' || p[-1] == 'E'))) p++;
+            out.Append('?');
+            continue;
+        }
+
+        out.Append(*p++);
+    }
+
+    // reduce value lists and multi-row values
+    while (out.Contains("?, ?")) out.ReplaceAll("?, ?", "?");
+    while (out.Contains("?,?")) out.ReplaceAll("?,?", "?");
+    while (out.Contains("(?), (?)")) out.ReplaceAll("(?), (?)", "(?)");
+    while (out.Contains("(?),(?)")) out.ReplaceAll("(?),(?)", "(?)");
+
+    return out;
+}
+
+//______________________________________________________________________________
+void TCQueryLog::Record(const Char_t* sql, Long64_t nsec, Long64_t rows, void* caller)
+{
+    // Record the SQL statement 'sql' of the latency 'nsec' nanoseconds
+    // returning 'rows' rows (negative if unknown) sent from the calling site
+    // 'caller'. This method is thread-safe.
+
+    TString pattern = Normalise(sql);
+
+    fMutex->Lock();
+
+    // get or create the pattern
+    TCQueryPattern* p = (TCQueryPattern*)fPatterns->FindObject(pattern.Data());
+    if (!p)
+    {
+        p = new TCQueryPattern(pattern.Data());
+        fPatterns->Add(p);
+    }
+
+    // add the call
+    p->Add(nsec, rows, caller);
+
+    fMutex->UnLock();
+}
+
+//______________________________________________________________________________
+void TCQueryLog::Reset()
+{
+    // Remove all recorded statement patterns.
+
+    fMutex->Lock();
+    fPatterns->Delete();
+    fMutex->UnLock();
+}
+
+//______________________________________________________________________________
+Int_t TCQueryLog::GetNPatterns() const
+{
+    // Return the number of recorded statement patterns.
+
+    return fPatterns->GetSize();
+}
+
+//______________________________________________________________________________
+TString TCQueryLog::GetReport(Int_t n, Bool_t verbose)
+{
+    // Return the 'n' statement patterns with the largest total latency as
+    // text. If 'verbose' is kTRUE the calling functions and the latency
+    // histograms are added, otherwise one line per pattern is written.
+
+    fMutex->Lock();
+
+    // collect patterns
+    Int_t np = fPatterns->GetSize();
+    TCQueryPattern** pat = new TCQueryPattern*[np];
+    Double_t* time = new Double_t[np];
+    Int_t* index = new Int_t[np];
+    Double_t totTime = 0;
+    Long64_t totCalls = 0;
+    TIter next(fPatterns);
+    TCQueryPattern* p;
+    Int_t i = 0;
+    while ((p = (TCQueryPattern*)next()))
+    {
+        pat[i] = p;
+        time[i] = p->GetTime();
+        totTime += p->GetTime();
+        totCalls += p->GetCalls();
+        i++;
+    }
+
+    // sort by total latency
+    TMath::Sort(np, time, index);
+
+    // header
+    TString out = TString::Format("%lld statements, %d patterns, %.3f ms total\n",
+                                  totCalls, np, totTime / 1e6);
+    out.Append(TString::Format("%4s %8s %11s %6s %9s %9s %9s %9s %9s  %s\n",
+                               "#", "calls", "total[ms]", "[%]", "mean[ms]", "p50[ms]",
+                               "p95[ms]", "max[ms]", "rows", verbose ? "pattern" : "caller / pattern"));
+
+    // patterns
+    for (i = 0; i < np && i < n; i++)
+    {
+        p = pat[index[i]];
+        out.Append(TString::Format("%4d %8lld %11.3f %6.1f %9.3f %9.3f %9.3f %9.3f %9lld  ",
+                                   i+1, p->GetCalls(), p->GetTime() / 1e6,
+                                   totTime > 0 ? 100. * p->GetTime() / totTime : 0.,
+                                   p->GetTime() / 1e6 / p->GetCalls(), p->GetQuantile(0.5),
+                                   p->GetQuantile(0.95), p->GetTimeMax() / 1e6, p->GetRows()));
+        if (!verbose)
+        {
+            TString callers = p->GetCallers();
+            Ssiz_t pos = callers.Index(" (");
+            if (pos > 0) callers.Remove(pos);
+            out.Append(TString::Format("%s / %s\n", callers.Data(), p->GetName()));
+            continue;
+        }
+        out.Append(TString::Format("%s\n", p->GetName()));
+        out.Append(TString::Format("%51s callers: %s\n", "", p->GetCallers().Data()));
+
+        // latency histogram
+        out.Append(TString::Format("%51s latency:", ""));
+        const Long64_t* h = p->GetHistogram();
+        for (Int_t j = 0; j < TCQueryPattern::kNBins; j++)
+        {
+            if (!h[j]) continue;
+            Double_t us = TMath::Power(2., j+1);
+            if (us < 1000) out.Append(TString::Format(" <%.0fus:%lld", us, h[j]));
+            else out.Append(TString::Format(" <%.0fms:%lld", us / 1000, h[j]));
+        }
+        out.Append("\n");
+    }
+
+    fMutex->UnLock();
+
+    // clean-up
+    delete [] pat;
+    delete [] time;
+    delete [] index;
+
+    return out;
+}
+
+//______________________________________________________________________________
+void TCQueryLog::Print(Int_t n)
+{
+    // Print the 'n' statement patterns with the largest total latency.
+
+    printf("SQL statement patterns:\n%s", GetReport(n).Data());
+}
+
@@ -12,12 +12,18 @@
 
 
 #include <sstream>
-#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "TList.h"
 #include "TError.h"
+#include "TMath.h"
+#include "TString.h"
 
 #include "TCReadARCalib.h"
+#include "TCInstrument.h"
 
 ClassImp(TCARElement)
 ClassImp(TCARTimeWalk)
@@ -159,6 +165,66 @@ Bool_t TCARNeighbours::Parse(const Char_t* line)
     return kTRUE;
 }
 
+//______________________________________________________________________________
+static const Char_t* SkipARBlanks(const Char_t* p, const Char_t* end)
+{
+    // Return the first non-blank character of the line part from 'p' to 'end'.
+
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+    return p;
+}
+
+//______________________________________________________________________________
+static const Char_t* SkipARToken(const Char_t* p, const Char_t* end)
+{
+    // Return the first blank character after the token at 'p' of the line part
+    // from 'p' to 'end'.
+
+    while (p < end && *p != ' ' && *p != '\t' && *p != '\r') p++;
+    return p;
+}
+
+//______________________________________________________________________________
+static Bool_t ParseARFields(const Char_t* buffer, const Char_t* p, const Char_t* end,
+                            Int_t nField, const Bool_t* isString, const Bool_t* isInt,
+                            Double_t** outValue, Int_t n, Int_t* outSpan)
+{
+    // Tokenise the 'nField' fields following the statement identifier of the
+    // line part from 'p' to 'end' in place. The numeric values are stored to
+    // 'outValue'[field]['n'], the positions relative to 'buffer' and the
+    // lengths of the fields to 'outSpan'. String fields ('isString') are
+    // only located.
+    // Return kFALSE if a field is missing or not a number.
+
+    // skip the statement identifier
+    p = SkipARToken(SkipARBlanks(p, end), end);
+
+    // loop over fields
+    for (Int_t i = 0; i < nField; i++)
+    {
+        // locate the token
+        p = SkipARBlanks(p, end);
+        if (p >= end) return kFALSE;
+        const Char_t* tokEnd = SkipARToken(p, end);
+        outSpan[2*i] = (Int_t)(p - buffer);
+        outSpan[2*i+1] = (Int_t)(tokEnd - p);
+
+        // convert the number (the token is followed by a blank or a newline)
+        if (!isString[i])
+        {
+            Char_t* e;
+            if (isInt[i]) outValue[i][n] = strtol(p, &e, 10);
+            else outValue[i][n] = strtod(p, &e);
+            if (e != tokEnd) return kFALSE;
+        }
+        else outValue[i][n] = 0;
+
+        p = tokEnd;
+    }
+
+    return kTRUE;
+}
+
 //______________________________________________________________________________
 TCReadARCalib::TCReadARCalib(const Char_t* calibFile, Bool_t isTagger,
                              const Char_t* elemIdent, const Char_t* nebrIdent)
@@ -168,10 +234,7 @@ TCReadARCalib::TCReadARCalib(const Char_t* calibFile, Bool_t isTagger,
     // 'isTagger' has to be kTRUE for tagger calibration files.
 
     // init members
-    fElements = new TList();
-    fElements->SetOwner(kTRUE);
-    fTimeWalks = new TList();
-    fTimeWalks->SetOwner(kTRUE);
+    Init();
     fNeighbours = new TList();
     fNeighbours->SetOwner(kTRUE);
 
@@ -184,32 +247,78 @@ TCReadARCalib::~TCReadARCalib()
 {
     // Destructor.
 
+    // release the file content
+    if (fBuffer)
+    {
+        if (fMapped) munmap(fBuffer, fBufferSize);
+        else delete [] fBuffer;
+    }
+
+    // element table
+    for (Int_t i = 0; i < kARELEM_NFIELD; i++)
+        if (fElemValue[i]) delete [] fElemValue[i];
+    if (fElemLine) delete [] fElemLine;
+    if (fElemSpan) delete [] fElemSpan;
+
+    // time walk table
+    for (Int_t i = 0; i < kARTW_NFIELD; i++)
+        if (fTWValue[i]) delete [] fTWValue[i];
+    if (fTWLine) delete [] fTWLine;
+    if (fTWSpan) delete [] fTWSpan;
+
     if (fElements) delete fElements;
     if (fTimeWalks) delete fTimeWalks;
     if (fNeighbours) delete fNeighbours;
 }
 
 //______________________________________________________________________________
-Int_t TCReadARCalib::GetNelements() const
+void TCReadARCalib::Init()
+{
+    // Init the members.
+
+    fBuffer = 0;
+    fBufferSize = 0;
+    fFileSize = 0;
+    fMapped = kFALSE;
+    fIsTagger = kFALSE;
+    fNElem = 0;
+    for (Int_t i = 0; i < kARELEM_NFIELD; i++) fElemValue[i] = 0;
+    fElemLine = 0;
+    fElemSpan = 0;
+    fNTW = 0;
+    for (Int_t i = 0; i < kARTW_NFIELD; i++) fTWValue[i] = 0;
+    fTWLine = 0;
+    fTWSpan = 0;
+    fElements = 0;
+    fTimeWalks = 0;
+    fNeighbours = 0;
+}
+
+//______________________________________________________________________________
+TList* TCReadARCalib::GetElements() const
 {
-    return fElements ? fElements->GetSize() : 0;
+    MakeElements();
+    return fElements;
 }
 
 //______________________________________________________________________________
 TCARElement* TCReadARCalib::GetElement(Int_t n) const
 {
+    MakeElements();
     return fElements ? (TCARElement*)fElements->At(n) : 0;
 }
 
 //______________________________________________________________________________
-Int_t TCReadARCalib::GetNtimeWalks() const
+TList* TCReadARCalib::GetTimeWalks() const
 {
-    return fTimeWalks ? fTimeWalks->GetSize() : 0;
+    MakeTimeWalks();
+    return fTimeWalks;
 }
 
 //______________________________________________________________________________
 TCARTimeWalk* TCReadARCalib::GetTimeWalk(Int_t n) const
 {
+    MakeTimeWalks();
     return fTimeWalks ? (TCARTimeWalk*)fTimeWalks->At(n) : 0;
 }
 
@@ -225,92 +334,266 @@ TCARNeighbours* TCReadARCalib::GetNeighbour(Int_t n) const
     return fNeighbours ? (TCARNeighbours*)fNeighbours->At(n) : 0;
 }
 
+//______________________________________________________________________________
+void TCReadARCalib::MakeElements() const
+{
+    // Create the list of element objects from the element table if this was
+    // not done before.
+
+    if (fElements) return;
+
+    fElements = new TList();
+    fElements->SetOwner(kTRUE);
+
+    // loop over elements
+    for (Int_t i = 0; i < fNElem; i++)
+    {
+        TCARElement* elem = new TCARElement();
+        Char_t tmp[16];
+
+        // identifiers
+        Int_t len = TMath::Min(GetElementFieldLength(i, kARELEM_ADC), 15);
+        strncpy(tmp, fBuffer + GetElementFieldStart(i, kARELEM_ADC), len);
+        tmp[len] = '\0';
+        elem->SetADC(tmp);
+        len = TMath::Min(GetElementFieldLength(i, kARELEM_TDC), 15);
+        strncpy(tmp, fBuffer + GetElementFieldStart(i, kARELEM_TDC), len);
+        tmp[len] = '\0';
+        elem->SetTDC(tmp);
+
+        // values
+        elem->SetIsTagger(fIsTagger);
+        elem->SetEnergyLow(fElemValue[kARELEM_ELOW][i]);
+        elem->SetEnergyHigh(fElemValue[kARELEM_EHIGH][i]);
+        elem->SetPedestal(fElemValue[kARELEM_PED][i]);
+        elem->SetADCGain(fElemValue[kARELEM_ADCGAIN][i]);
+        elem->SetTimeLow(fElemValue[kARELEM_TLOW][i]);
+        elem->SetTimeHigh(fElemValue[kARELEM_THIGH][i]);
+        elem->SetOffset(fElemValue[kARELEM_OFFSET][i]);
+        elem->SetTDCGain(fElemValue[kARELEM_TDCGAIN][i]);
+        elem->SetX(fElemValue[kARELEM_X][i]);
+        elem->SetY(fElemValue[kARELEM_Y][i]);
+        elem->SetZ(fElemValue[kARELEM_Z][i]);
+        if (fIsTagger)
+        {
+            elem->SetTaggCalib(fElemValue[kARELEM_TAGGCALIB][i]);
+            elem->SetTaggOverlap(fElemValue[kARELEM_TAGGOVERLAP][i]);
+            elem->SetTaggScaler((Int_t)fElemValue[kARELEM_TAGGSCALER][i]);
+        }
+
+        fElements->Add(elem);
+    }
+}
+
+//______________________________________________________________________________
+void TCReadARCalib::MakeTimeWalks() const
+{
+    // Create the list of time walk objects from the time walk table if this
+    // was not done before.
+
+    if (fTimeWalks) return;
+
+    fTimeWalks = new TList();
+    fTimeWalks->SetOwner(kTRUE);
+
+    // loop over time walks
+    for (Int_t i = 0; i < fNTW; i++)
+    {
+        TCARTimeWalk* tw = new TCARTimeWalk();
+        tw->SetIndex((Int_t)fTWValue[kARTW_INDEX][i]);
+        tw->SetPar0(fTWValue[kARTW_PAR0][i]);
+        tw->SetPar1(fTWValue[kARTW_PAR1][i]);
+        tw->SetPar2(fTWValue[kARTW_PAR2][i]);
+        tw->SetPar3(fTWValue[kARTW_PAR3][i]);
+        fTimeWalks->Add(tw);
+    }
+}
+
+//______________________________________________________________________________
+Bool_t TCReadARCalib::MapFile(const Char_t* filename)
+{
+    // Map the content of the file 'filename' into memory. Files not ending
+    // with a newline are read into a buffer with an appended newline
+    // instead, so that every line of the buffer is terminated (the file
+    // size excludes the appended newline).
+    // Return kFALSE if the file could not be read, otherwise kTRUE.
+
+    // open the file
+    Int_t fd = open(filename, O_RDONLY);
+    if (fd < 0) return kFALSE;
+
+    // get the file size
+    struct stat st;
+    if (fstat(fd, &st))
+    {
+        close(fd);
+        return kFALSE;
+    }
+    fBufferSize = st.st_size;
+    fFileSize = st.st_size;
+    TCINSTR_COUNT(kINSTR_FILES_OPENED, 1);
+    TCINSTR_COUNT(kINSTR_BYTES_READ, fFileSize);
+
+    // map the file
+    if (fBufferSize > 0)
+    {
+        void* m = mmap(0, fBufferSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (m != MAP_FAILED)
+        {
+            // use mapping if the last line is terminated
+            if (((Char_t*)m)[fBufferSize-1] == '\n')
+            {
+                fBuffer = (Char_t*)m;
+                fMapped = kTRUE;
+                close(fd);
+                return kTRUE;
+            }
+            munmap(m, fBufferSize);
+        }
+    }
+
+    // read the file and terminate the last line
+    fBuffer = new Char_t[fBufferSize+1];
+    Long64_t n = 0;
+    while (n < fBufferSize)
+    {
+        ssize_t r = read(fd, fBuffer + n, fBufferSize - n);
+        if (r <= 0) break;
+        n += r;
+    }
+    close(fd);
+    fBuffer[n] = '\n';
+    fBufferSize = n + 1;
+    fFileSize = n;
+
+    return kTRUE;
+}
+
 //______________________________________________________________________________
 void TCReadARCalib::ReadCalibFile(const Char_t* filename, Bool_t isTagger,
                                   const Char_t* elemIdent, const Char_t* nebrIdent)
 {
     // Read the calibration file 'filename'.
+    // The file is memory-mapped and tokenised in place. The values and
+    // positions of the element and time walk fields are stored in tables,
+    // the element and time walk objects are created on demand.
 
-    // open the file
-    std::ifstream infile;
-    infile.open(filename);
+    TCINSTR_SCOPE("TCReadARCalib::ReadCalibFile");
 
-    // check if file is open
-    if (!infile.is_open())
+    // map the file
+    if (!MapFile(filename))
     {
         Error("ReadCalibFile", "Could not open calibration file '%s'", filename);
+        return;
     }
-    else
-    {
-        Info("ReadCalibFile", "Reading calibration file '%s'", filename);
 
-        // read the file
-        while (infile.good())
-        {
-            TString line;
-            line.ReadLine(infile);
+    Info("ReadCalibFile", "Reading calibration file '%s'", filename);
 
-            // trim line
-            line.Remove(TString::kBoth, ' ');
+    // set tagger toggle
+    fIsTagger = isTagger;
 
-            // search element statements
-            if (line.BeginsWith(elemIdent))
+    // field types
+    const Bool_t elemString[kARELEM_NFIELD] = { kTRUE,  kFALSE, kFALSE, kFALSE, kFALSE,
+                                                kTRUE,  kFALSE, kFALSE, kFALSE, kFALSE,
+                                                kFALSE, kFALSE, kFALSE, kFALSE, kFALSE, kFALSE };
+    const Bool_t elemInt[kARELEM_NFIELD] = { kFALSE, kFALSE, kFALSE, kFALSE, kFALSE,
+                                             kFALSE, kFALSE, kFALSE, kFALSE, kFALSE,
+                                             kFALSE, kFALSE, kFALSE, kFALSE, kFALSE, kTRUE };
+    const Bool_t twString[kARTW_NFIELD] = { kFALSE, kFALSE, kFALSE, kFALSE, kFALSE };
+    const Bool_t twInt[kARTW_NFIELD] = { kTRUE, kFALSE, kFALSE, kFALSE, kFALSE };
+    Int_t nElemField = isTagger ? kARELEM_NFIELD : kARELEM_TAGGCALIB;
+
+    // count lines (upper limit of the number of statements)
+    const Char_t* end = fBuffer + fBufferSize;
+    Int_t nLines = 0;
+    for (const Char_t* p = fBuffer; (p = (const Char_t*)memchr(p, '\n', end - p)); p++) nLines++;
+
+    // create the tables
+    for (Int_t i = 0; i < kARELEM_NFIELD; i++)
+    {
+        fElemValue[i] = new Double_t[nLines];
+        for (Int_t j = 0; j < nLines; j++) fElemValue[i][j] = 0;
+    }
+    fElemLine = new Int_t[2*nLines];
+    fElemSpan = new Int_t[2*nLines*kARELEM_NFIELD];
+    for (Int_t i = 0; i < 2*nLines*kARELEM_NFIELD; i++) fElemSpan[i] = 0;
+    for (Int_t i = 0; i < kARTW_NFIELD; i++) fTWValue[i] = new Double_t[nLines];
+    fTWLine = new Int_t[2*nLines];
+    fTWSpan = new Int_t[2*nLines*kARTW_NFIELD];
+
+    Int_t elemIdentLen = strlen(elemIdent);
+    Int_t nebrIdentLen = strlen(nebrIdent);
+
+    // loop over lines
+    const Char_t* line = fBuffer;
+    while (line < end)
+    {
+        // get line end
+        const Char_t* eol = (const Char_t*)memchr(line, '\n', end - line);
+
+        // skip leading spaces
+        const Char_t* p = line;
+        while (p < eol && *p == ' ') p++;
+        Int_t len = eol - p;
+
+        // search element statements
+        if (len >= elemIdentLen && !strncmp(p, elemIdent, elemIdentLen))
+        {
+            // try to read parameters
+            if (ParseARFields(fBuffer, p, eol, nElemField, elemString, elemInt,
+                              fElemValue, fNElem, fElemSpan + 2*fNElem*kARELEM_NFIELD))
             {
-                // create element
-                TCARElement* elem = new TCARElement();
-
-                // try to read parameters
-                if (elem->Parse(line, isTagger))
-                {
-                    // add element to list
-                    fElements->Add(elem);
-                }
-                else
-                {
-                    Error("ReadCalibFile", "Could not read element in "
-                          "calibration file '%s'", filename);
-                }
+                // add element to table
+                fElemLine[2*fNElem] = line - fBuffer;
+                fElemLine[2*fNElem+1] = eol - line;
+                fNElem++;
             }
-            // search time walk statements
-            else if (line.BeginsWith("TimeWalk:"))
+            else
             {
-                // create time walk
-                TCARTimeWalk* tw = new TCARTimeWalk();
-
-                // try to read parameters
-                if (tw->Parse(line))
-                {
-                    // add time walk to list
-                    fTimeWalks->Add(tw);
-                }
-                else
-                {
-                    Error("ReadCalibFile", "Could not read time walk in "
-                          "calibration file '%s'", filename);
-                }
+                Error("ReadCalibFile", "Could not read element in "
+                      "calibration file '%s'", filename);
             }
-            // search neighbours statements
-            else if (line.BeginsWith(nebrIdent))
+        }
+        // search time walk statements
+        else if (len >= 9 && !strncmp(p, "TimeWalk:", 9))
+        {
+            // try to read parameters
+            if (ParseARFields(fBuffer, p, eol, kARTW_NFIELD, twString, twInt,
+                              fTWValue, fNTW, fTWSpan + 2*fNTW*kARTW_NFIELD))
+            {
+                // add time walk to table
+                fTWLine[2*fNTW] = line - fBuffer;
+                fTWLine[2*fNTW+1] = eol - line;
+                fNTW++;
+            }
+            else
             {
-                // create element
-                TCARNeighbours* elem = new TCARNeighbours();
-
-                // try to read parameters
-                if (elem->Parse(line))
-                {
-                    // add element to list
-                    fNeighbours->Add(elem);
-                }
-                else
-                {
-                    Error("ReadCalibFile", "Could not read neighbours in "
-                          "calibration file '%s'", filename);
-                }
+                Error("ReadCalibFile", "Could not read time walk in "
+                      "calibration file '%s'", filename);
             }
         }
-    }
+        // search neighbours statements
+        else if (len >= nebrIdentLen && !strncmp(p, nebrIdent, nebrIdentLen))
+        {
+            // create element
+            TCARNeighbours* elem = new TCARNeighbours();
 
-    // close the file
-    infile.close();
+            // try to read parameters
+            if (elem->Parse(TString(p, len).Data()))
+            {
+                // add element to list
+                fNeighbours->Add(elem);
+            }
+            else
+            {
+                Error("ReadCalibFile", "Could not read neighbours in "
+                      "calibration file '%s'", filename);
+                delete elem;
+            }
+        }
+
+        // next line
+        line = eol + 1;
+    }
 }
 
@@ -14,10 +14,13 @@
 #include <fstream>
 
 #include "THashTable.h"
+#include "TMutex.h"
 #include "TSystem.h"
 #include "TError.h"
 
 #include "TCReadConfig.h"
+#include "TCUtils.h"
+#include "TCInstrument.h"
 
 ClassImp(TCReadConfig)
 
@@ -33,6 +36,17 @@ TCReadConfig::TCReadConfig()
     fConfigTable = new THashTable();
     fConfigTable->SetOwner(kTRUE);
 
+    // create the typed values (the first values are the unset values of the
+    // types used for missing keys)
+    // NOTE: the values are stored in blocks that are never moved so that
+    //       handles can be used in other threads while new handles are
+    //       created
+    fMutex = new TMutex();
+    for (Int_t i = 0; i < 256; i++) fValues[i] = 0;
+    fValues[0] = new TCConfigValue[256];
+    for (fNValues = 0; fNValues < kConfigNType; fNValues++)
+        ParseValue(0, (ConfigType_t)fNValues, &Value(fNValues));
+
     // try to get the CaLib source path from the shell variable CALIB
     // otherwise use the current directory
     if (gSystem->Getenv("CALIB")) fCaLibPath = gSystem->Getenv("CALIB");
@@ -40,6 +54,9 @@ TCReadConfig::TCReadConfig()
 
     // read the main configuration file
     ReadConfigFile("config/config.cfg");
+
+    // enable the instrumentation
+    if (TString* r = GetConfig("Misc.Instrument.Report")) TCInstrument::Enable(r->Data());
 }
 
 //______________________________________________________________________________
@@ -48,6 +65,11 @@ TCReadConfig::~TCReadConfig()
     // Destructor.
 
     if (fConfigTable) delete fConfigTable;
+    for (Int_t i = 0; i < fNValues; i++)
+        if (Value(i).list) delete [] Value(i).list;
+    for (Int_t i = 0; i < 256; i++)
+        if (fValues[i]) delete [] fValues[i];
+    if (fMutex) delete fMutex;
 }
 
 //______________________________________________________________________________
@@ -131,7 +153,116 @@ TCConfigElement* TCReadConfig::CreateConfigElement(TString line)
 }
 
 //______________________________________________________________________________
-TString* TCReadConfig::GetConfig(TString configKey)
+Bool_t TCReadConfig::ParseValue(const TString* v, ConfigType_t type, TCConfigValue* out)
+{
+    // Parse the configuration value 'v' as type 'type' and save the result
+    // to 'out'. The value is unset if 'v' is zero.
+    // Return kFALSE if the value could not be parsed, otherwise kTRUE.
+
+    // init value
+    out->set = kFALSE;
+    out->i = 0;
+    out->d[0] = 0;
+    out->d[1] = 0;
+    out->n = 0;
+    out->list = 0;
+    out->s = v;
+
+    // check value
+    if (!v) return kTRUE;
+
+    // parse value
+    switch (type)
+    {
+        case kConfigInt:
+        {
+            out->i = atoi(v->Data());
+            break;
+        }
+        case kConfigDouble:
+        {
+            out->d[0] = atof(v->Data());
+            break;
+        }
+        case kConfigPair:
+        {
+            if (sscanf(v->Data(), "%lf%lf", &out->d[0], &out->d[1]) != 2)
+            {
+                Error("ParseValue", "Problems reading two double values from '%s'", v->Data());
+                out->d[0] = 0;
+                out->d[1] = 0;
+                return kFALSE;
+            }
+            break;
+        }
+        case kConfigList:
+        {
+            // create list (number of entries is at most the number of commas + 1)
+            out->list = new Int_t[v->CountChar(',') + 1];
+            out->n = TCUtils::ReadCommaSepList(v, out->list);
+            break;
+        }
+        default:
+            break;
+    }
+
+    out->set = kTRUE;
+
+    return kTRUE;
+}
+
+//______________________________________________________________________________
+Int_t TCReadConfig::GetHandle(const Char_t* configKey, ConfigType_t type)
+{
+    // Return the handle of the configuration key 'configKey' whose value is
+    // parsed once as type 'type'. The parsed value can be accessed via the
+    // handle without any string operation (see IsSet(), GetInt(), GetDouble(),
+    // GetFirst(), GetSecond(), GetListSize(), GetList() and GetString()).
+    // The value of the handle is unset if the key does not exist or the value
+    // could not be parsed.
+    // This method and the handles can be used in several threads.
+
+    // search the configuration element
+    TCConfigElement* elem = (TCConfigElement*) fConfigTable->FindObject(configKey);
+
+    // return the unset value of the type for missing keys
+    if (!elem) return type;
+
+    // lock the handles
+    fMutex->Lock();
+
+    // check if value was already parsed
+    Int_t h = elem->GetHandle(type);
+    if (h >= 0)
+    {
+        fMutex->UnLock();
+        return h;
+    }
+
+    // check the number of values
+    if (fNValues == 256*256)
+    {
+        fMutex->UnLock();
+        Error("GetHandle", "Too many configuration values, '%s' is ignored!", configKey);
+        return type;
+    }
+
+    // create a new block of values
+    if (!fValues[fNValues >> 8]) fValues[fNValues >> 8] = new TCConfigValue[256];
+
+    // parse the value
+    h = fNValues++;
+    ParseValue(elem->GetValue(), type, &Value(h));
+    elem->SetHandle(type, h);
+
+    // unlock the handles
+    fMutex->UnLock();
+
+    return h;
+}
+
+//______________________________________________________________________________
+TString* TCReadConfig::GetConfig(const Char_t* configKey)
 {
     // Get the configuration value of the configuration key 'configKey'.
     // Return 0 if no such element exists.
@@ -145,64 +276,40 @@ TString* TCReadConfig::GetConfig(TString configKey)
 }
 
 //______________________________________________________________________________
-Int_t TCReadConfig::GetConfigInt(TString configKey)
+Int_t TCReadConfig::GetConfigInt(const Char_t* configKey)
 {
     // Get the configuration value of the configuration key 'configKey'
     // converted to Int_t.
     // Return 0 if no such element exists.
 
-    // get value as string
-    TString* v = GetConfig(configKey);
-
-    // return value
-    if (v) return atoi(v->Data());
-    else return 0;
+    return GetInt(GetHandle(configKey, kConfigInt));
 }
 
 //______________________________________________________________________________
-Double_t TCReadConfig::GetConfigDouble(TString configKey)
+Double_t TCReadConfig::GetConfigDouble(const Char_t* configKey)
 {
     // Get the configuration value of the configuration key 'configKey'
     // converted to Double_t.
     // Return 0 if no such element exists.
 
-    // get value as string
-    TString* v = GetConfig(configKey);
-
-    // return value
-    if (v) return atof(v->Data());
-    else return 0;
+    return GetDouble(GetHandle(configKey, kConfigDouble));
 }
 
 //______________________________________________________________________________
-Bool_t TCReadConfig::GetConfigDoubleDouble(TString configKey, Double_t* out1, Double_t* out2)
+Bool_t TCReadConfig::GetConfigDoubleDouble(const Char_t* configKey, Double_t* out1, Double_t* out2)
 {
     // Read two Double_t values of the configuration key 'configKey' and save them
     // to 'out1' and 'out2'.
 
-    // get value as string
-    TString* v = GetConfig(configKey);
+    // get parsed values
+    Int_t h = GetHandle(configKey, kConfigPair);
 
-    // check value
-    if (!v) return kFALSE;
+    // check values
+    if (!IsSet(h)) return kFALSE;
 
-    // read values
-    Double_t d1, d2;
-    Int_t n = sscanf(v->Data(), "%lf%lf", &d1, &d2);
+    if (out1) *out1 = GetFirst(h);
+    if (out2) *out2 = GetSecond(h);
 
-    // check result
-    if (n == 2)
-    {
-        if (out1) *out1 = d1;
-        if (out2) *out2 = d2;
-
-        return kTRUE;
-    }
-    else
-    {
-        Error("GetConfigDoubleDouble", "Problems reading two double values from '%s'",
-              v->Data());
-        return kFALSE;
-    }
+    return kTRUE;
 }
 
@@ -15,10 +15,178 @@
 #include "TMath.h"
 #include "TObjArray.h"
 #include "TObjString.h"
+#include "TArrayD.h"
+#include "TArrayF.h"
+#include "TProfile.h"
+#include "TProfile2D.h"
+#include "TSystem.h"
+#include "TThread.h"
+#include "TMutex.h"
 
 #include "TCUtils.h"
 #include "TCReadConfig.h"
 
+//______________________________________________________________________________
+template <class T>
+static void DeriveArray(const T* in, Double_t* out, Int_t n, Double_t invDx)
+{
+    // Save the forward differences of the 'n' values in 'in' multiplied by
+    // 'invDx' to the first 'n'-1 elements of 'out'.
+
+    for (Int_t i = 0; i < n-1; i++) out[i] = (in[i+1] - in[i]) * invDx;
+}
+
+//______________________________________________________________________________
+template <class T>
+static Int_t ZeroArray(T* a, Int_t n, Double_t th)
+{
+    // Set all 'n' values in 'a' that are lower than 'th' to zero. Return the
+    // number of changed values.
+
+    Int_t nzero = 0;
+    for (Int_t i = 0; i < n; i++)
+    {
+        Bool_t low = a[i] < th;
+        nzero += low;
+        a[i] = low ? 0 : a[i];
+    }
+
+    return nzero;
+}
+
+//______________________________________________________________________________
+template <class T>
+static Int_t GetArrayMinimumBin(const T* a, Int_t n)
+{
+    // Return the index of the non-zero minimum of the 'n' values in 'a' or -1
+    // if all values are zero.
+
+    Double_t min = 1e100;
+    Int_t minPos = -1;
+    for (Int_t i = 0; i < n; i++)
+    {
+        Double_t c = a[i];
+        if (c < min && c != 0)
+        {
+            min = c;
+            minPos = i;
+        }
+    }
+
+    return minPos;
+}
+
+//______________________________________________________________________________
+static Bool_t HasDirectStorage(TH1* h)
+{
+    // Return kTRUE if the bin contents of the histogram 'h' can be accessed
+    // directly in its contiguous storage.
+
+    // profiles store sums, not bin contents
+    if (dynamic_cast<TProfile*>(h) || dynamic_cast<TProfile2D*>(h)) return kFALSE;
+
+    // flush filling buffer
+    if (h->GetBuffer()) h->BufferEmpty();
+
+    return kTRUE;
+}
+
+//______________________________________________________________________________
+static Double_t* GetArrayD(TH1* h)
+{
+    // Return the contiguous double bin storage of the histogram 'h' or 0
+    // if 'h' does not store doubles.
+
+    TArrayD* a = dynamic_cast<TArrayD*>(h);
+    return a && HasDirectStorage(h) ? a->GetArray() : 0;
+}
+
+//______________________________________________________________________________
+static Float_t* GetArrayF(TH1* h)
+{
+    // Return the contiguous float bin storage of the histogram 'h' or 0
+    // if 'h' does not store floats.
+
+    TArrayF* a = dynamic_cast<TArrayF*>(h);
+    return a && HasDirectStorage(h) ? a->GetArray() : 0;
+}
+
+//______________________________________________________________________________
+static Int_t GetNCells(TH1* h)
+{
+    // Return the number of cells of the histogram 'h' including under- and
+    // overflow bins, i.e., the size of its bin storage.
+
+    return (h->GetNbinsX()+2) * (h->GetDimension() > 1 ? h->GetNbinsY()+2 : 1) *
+                                (h->GetDimension() > 2 ? h->GetNbinsZ()+2 : 1);
+}
+
+//______________________________________________________________________________
+static Int_t GetHistogramMinimumBin(TH1* h)
+{
+    // Return the bin of the non-zero minimum bin content of the 1-dim.
+    // histogram 'h' or 0 if all bins are empty.
+
+    Int_t nBins = h->GetNbinsX();
+    Int_t pos = -1;
+
+    // loop over bins (bin 0 is the underflow bin)
+    if (h->GetDimension() == 1 && GetArrayD(h))
+        pos = GetArrayMinimumBin(GetArrayD(h) + 1, nBins);
+    else if (h->GetDimension() == 1 && GetArrayF(h))
+        pos = GetArrayMinimumBin(GetArrayF(h) + 1, nBins);
+    else
+    {
+        Double_t min = 1e100;
+        for (Int_t i = 1; i <= nBins; i++)
+        {
+            Double_t c = h->GetBinContent(i);
+            if (c < min && c != 0)
+            {
+                min = c;
+                pos = i-1;
+            }
+        }
+    }
+
+    return pos + 1;
+}
+
+// task of TCUtils::ParallelFor()
+struct ParallelForTask
+{
+    Int_t n;                            // number of indices
+    Int_t next;                         // next index to process
+    TMutex* mutex;                      // index mutex
+    void (*func)(Int_t, void*);         // function to call
+    void* arg;                          // function argument
+};
+
+//______________________________________________________________________________
+static void* ParallelForWorker(void* arg)
+{
+    // Worker thread of TCUtils::ParallelFor(): call the task function for the
+    // next free index until all indices are processed.
+
+    ParallelForTask* task = (ParallelForTask*) arg;
+
+    for (;;)
+    {
+        // get next index
+        task->mutex->Lock();
+        Int_t i = task->next++;
+        task->mutex->UnLock();
+
+        // check if done
+        if (i >= task->n) break;
+
+        // process index
+        task->func(i, task->arg);
+    }
+
+    return 0;
+}
+
 //______________________________________________________________________________
 void TCUtils::FindBackground(TH1* h, Double_t peak, Double_t low, Double_t high,
                              Double_t* outPar0, Double_t* outPar1)
@@ -30,13 +198,42 @@ void TCUtils::FindBackground(TH1* h, Double_t peak, Double_t low, Double_t high,
     x1 = peak - low;
     x2 = peak + high;
 
-    y1 = h->Integral(h->FindBin(x1)-1, h->FindBin(x1)+1, "w")/3.;
-    y2 = h->Integral(h->FindBin(x2)-1, h->FindBin(x2)+1, "w")/3.;
+    y1 = GetBinIntegral3(h, h->FindBin(x1))/3.;
+    y2 = GetBinIntegral3(h, h->FindBin(x2))/3.;
 
     *outPar0 = (y1-y2)/(x1-x2);
     *outPar1 = ((y1+y2) - *outPar0*(x1+x2))/2.;
 }
 
+//______________________________________________________________________________
+Double_t TCUtils::GetBinIntegral3(TH1* h, Int_t bin)
+{
+    // Return the sum of the contents of the 1-dim. histogram 'h' over the
+    // bins 'bin'-1 to 'bin'+1 (equivalent to h->Integral(bin-1, bin+1)).
+
+    // check bin range like TH1::Integral()
+    Int_t nBins = h->GetNbinsX();
+    Int_t first = bin - 1;
+    Int_t last = bin + 1;
+    if (first < 0) first = 0;
+    if (last > nBins+1 || last < first) last = nBins+1;
+
+    // get storage
+    const Double_t* ad = h->GetDimension() == 1 ? GetArrayD(h) : 0;
+    const Float_t* af = h->GetDimension() == 1 ? GetArrayF(h) : 0;
+
+    // sum up
+    Double_t sum = 0;
+    for (Int_t i = first; i <= last; i++)
+    {
+        if (ad) sum += ad[i];
+        else if (af) sum += af[i];
+        else sum += h->GetBinContent(i);
+    }
+
+    return sum;
+}
+
 //______________________________________________________________________________
 TH1* TCUtils::DeriveHistogram(TH1* inH)
 {
@@ -49,21 +246,41 @@ TH1* TCUtils::DeriveHistogram(TH1* inH)
 
     // create new histogram
     sprintf(tmp, "%s_Derivative", inH->GetName());
-    TH1* h = new TH1D(tmp, tmp, nBins, inH->GetXaxis()->GetXmin(), inH->GetXaxis()->GetXmax());
+    TH1D* h = new TH1D(tmp, tmp, nBins, inH->GetXaxis()->GetXmin(), inH->GetXaxis()->GetXmax());
+    Double_t* out = h->GetArray() + 1;
+
+    // check for equidistant binning and direct storage access
+    TAxis* axis = inH->GetXaxis();
+    const Double_t* ad = inH->GetDimension() == 1 ? GetArrayD(inH) : 0;
+    const Float_t* af = inH->GetDimension() == 1 ? GetArrayF(inH) : 0;
+    if (!axis->IsVariableBinSize() && nBins > 0 && (ad || af))
+    {
+        // constant difference of bin centers
+        Double_t invDx = nBins / (axis->GetXmax() - axis->GetXmin());
 
-    // loop over bins
-    for (Int_t i = 1; i <= nBins-1; i++)
+        // derive
+        if (ad) DeriveArray(ad + 1, out, nBins, invDx);
+        else DeriveArray(af + 1, out, nBins, invDx);
+    }
+    else
     {
-        // x-difference
-        Double_t xdiff = inH->GetBinCenter(i+1) - inH->GetBinCenter(i);
+        // loop over bins
+        for (Int_t i = 1; i <= nBins-1; i++)
+        {
+            // x-difference
+            Double_t xdiff = inH->GetBinCenter(i+1) - inH->GetBinCenter(i);
 
-        // y-difference
-        Double_t ydiff = inH->GetBinContent(i+1) - inH->GetBinContent(i);
+            // y-difference
+            Double_t ydiff = inH->GetBinContent(i+1) - inH->GetBinContent(i);
 
-        // fill derived histogram
-        h->SetBinContent(i, ydiff / xdiff);
+            // fill derived histogram
+            out[i-1] = ydiff / xdiff;
+        }
     }
 
+    // set number of entries
+    h->SetEntries(nBins > 1 ? nBins-1 : 0);
+
     return h;
 }
 
@@ -76,6 +293,19 @@ void TCUtils::ZeroBins(TH1* inH, Double_t th)
     Int_t nbinsX = inH->GetNbinsX();
     Int_t nbinsY = inH->GetNbinsY();
     Int_t nbinsZ = inH->GetNbinsZ();
+    Int_t nCells = GetNCells(inH);
+
+    // direct storage access
+    if (Double_t* ad = GetArrayD(inH))
+    {
+        ZeroArray(ad, nCells, th);
+        return;
+    }
+    else if (Float_t* af = GetArrayF(inH))
+    {
+        ZeroArray(af, nCells, th);
+        return;
+    }
 
     // loop over bins
     // z bins
@@ -122,20 +352,9 @@ Double_t TCUtils::GetHistogramMinimum(TH1* h)
 {
     // Return the non-zero minimum bin content of the histogram 'h'.
 
-    Double_t min = 1e100;
-
-    // loop over bins
-    Int_t nBins = h->GetNbinsX();
-    for (Int_t i = 1; i <= nBins; i++)
-    {
-        // get bin content
-        Double_t c = h->GetBinContent(i);
-
-        // check bin content
-        if (c < min && c != 0) min = c;
-    }
+    Int_t bin = GetHistogramMinimumBin(h);
 
-    return min;
+    return bin ? h->GetBinContent(bin) : 1e100;
 }
 
 //______________________________________________________________________________
@@ -143,43 +362,104 @@ Double_t TCUtils::GetHistogramMinimumPosition(TH1* h)
 {
     // Return the position of the non-zero minimum bin content of the histogram 'h'.
 
-    Double_t min = 1e100;
-    Double_t minPos = 0;
+    Int_t bin = GetHistogramMinimumBin(h);
 
-    // loop over bins
-    Int_t nBins = h->GetNbinsX();
-    for (Int_t i = 1; i <= nBins; i++)
-    {
-        // get bin content
-        Double_t c = h->GetBinContent(i);
+    return bin ? h->GetBinCenter(bin) : 0;
+}
 
-        // get position
-        Double_t pos = h->GetBinCenter(i);
+//______________________________________________________________________________
+Int_t TCUtils::GetCellContents(TH1* h, Double_t* out)
+{
+    // Copy the contents of all cells of the histogram 'h' including under-
+    // and overflow bins to 'out' in the internal order, i.e., cell
+    // binx + (nx+2)*(biny + (ny+2)*binz). Return the number of cells.
+
+    // number of cells
+    Int_t n = GetNCells(h);
+
+    // copy
+    const Double_t* ad = GetArrayD(h);
+    const Float_t* af = ad ? 0 : GetArrayF(h);
+    if (ad)
+        for (Int_t i = 0; i < n; i++) out[i] = ad[i];
+    else if (af)
+        for (Int_t i = 0; i < n; i++) out[i] = af[i];
+    else
+        for (Int_t i = 0; i < n; i++) out[i] = h->GetBinContent(i);
 
-        // check bin content
-        if (c < min && c != 0)
-        {
-            min = c;
-            minPos = pos;
-        }
-    }
+    return n;
+}
 
-    return minPos;
+//______________________________________________________________________________
+void TCUtils::GetBinContents(TH1* h, Int_t n, Double_t* out)
+{
+    // Copy the contents of the bins 1 to 'n' of the 1-dim. histogram 'h' to
+    // 'out' (equivalent to out[i] = h->GetBinContent(i+1)). Bins above the
+    // overflow bin are set to zero.
+
+    // number of available bins (incl. overflow)
+    Int_t nb = TMath::Min(n, h->GetNbinsX()+1);
+
+    // copy
+    const Double_t* ad = GetArrayD(h);
+    const Float_t* af = ad ? 0 : GetArrayF(h);
+    if (ad)
+        for (Int_t i = 0; i < nb; i++) out[i] = ad[i+1];
+    else if (af)
+        for (Int_t i = 0; i < nb; i++) out[i] = af[i+1];
+    else
+        for (Int_t i = 0; i < nb; i++) out[i] = h->GetBinContent(i+1);
+    for (Int_t i = TMath::Max(nb, 0); i < n; i++) out[i] = 0;
 }
 
 //______________________________________________________________________________
-void TCUtils::FormatHistogram(TH1* h, const Char_t* ident)
+void TCUtils::SetBinContents(TH1* h, Int_t n, const Double_t* in)
 {
-    // Apply the formatting read from the configuration file for the identifier
-    // 'ident' to the histogram 'h'.
+    // Set the contents of the bins 1 to 'n' of the 1-dim. histogram 'h' to
+    // the values in 'in' (equivalent to h->SetBinContent(i+1, in[i])).
+
+    // number of bins
+    n = TMath::Min(n, h->GetNbinsX());
+
+    // copy
+    Double_t* ad = GetArrayD(h);
+    Float_t* af = ad ? 0 : GetArrayF(h);
+    if (ad)
+        for (Int_t i = 0; i < n; i++) ad[i+1] = in[i];
+    else if (af)
+        for (Int_t i = 0; i < n; i++) af[i+1] = in[i];
+    else
+        for (Int_t i = 0; i < n; i++) h->SetBinContent(i+1, in[i]);
 
-    Char_t key[256];
+    // update number of entries like SetBinContent()
+    if (ad || af) h->SetEntries(h->GetEntries() + n);
+}
+
+//______________________________________________________________________________
+void TCUtils::GetHistogramFormat(const Char_t* ident, Int_t* outHandles)
+{
+    // Resolve the configuration handles of the histogram formatting for the
+    // identifier 'ident' and save them to 'outHandles' (3 handles: rebin,
+    // x-axis range, y-axis range).
+
+    TCReadConfig* r = TCReadConfig::GetReader();
+    outHandles[0] = r->GetHandle(TString::Format("%s.Rebin", ident).Data(), kConfigInt);
+    outHandles[1] = r->GetHandle(TString::Format("%s.Xaxis.Range", ident).Data(), kConfigPair);
+    outHandles[2] = r->GetHandle(TString::Format("%s.Yaxis.Range", ident).Data(), kConfigPair);
+}
+
+//______________________________________________________________________________
+void TCUtils::FormatHistogram(TH1* h, const Int_t* handles)
+{
+    // Apply the formatting of the configuration handles 'handles' (see
+    // GetHistogramFormat()) to the histogram 'h'.
+
+    TCReadConfig* r = TCReadConfig::GetReader();
 
     // rebin
-    sprintf(key, "%s.Rebin", ident);
-    if (TString* value = TCReadConfig::GetReader()->GetConfig(key))
+    if (r->IsSet(handles[0]))
     {
-        Int_t rebin = atoi(value->Data());
+        Int_t rebin = r->GetInt(handles[0]);
         if (rebin > 1)
         {
             // only rebin 1-dim. histograms
@@ -189,22 +469,23 @@ void TCUtils::FormatHistogram(TH1* h, const Char_t* ident)
     }
 
     // x-axis range
-    sprintf(key, "%s.Xaxis.Range", ident);
-    if (TString* value = TCReadConfig::GetReader()->GetConfig(key))
-    {
-        Double_t min, max;
-        sscanf(value->Data(), "%lf%lf", &min, &max);
-        h->GetXaxis()->SetRangeUser(min, max);
-    }
+    if (r->IsSet(handles[1]))
+        h->GetXaxis()->SetRangeUser(r->GetFirst(handles[1]), r->GetSecond(handles[1]));
 
     // y-axis range
-    sprintf(key, "%s.Yaxis.Range", ident);
-    if (TString* value = TCReadConfig::GetReader()->GetConfig(key))
-    {
-        Double_t min, max;
-        sscanf(value->Data(), "%lf%lf", &min, &max);
-        h->GetYaxis()->SetRangeUser(min, max);
-    }
+    if (r->IsSet(handles[2]))
+        h->GetYaxis()->SetRangeUser(r->GetFirst(handles[2]), r->GetSecond(handles[2]));
+}
+
+//______________________________________________________________________________
+void TCUtils::FormatHistogram(TH1* h, const Char_t* ident)
+{
+    // Apply the formatting read from the configuration file for the identifier
+    // 'ident' to the histogram 'h'.
+
+    Int_t handles[3];
+    GetHistogramFormat(ident, handles);
+    FormatHistogram(h, handles);
 }
 
 //______________________________________________________________________________
@@ -404,3 +685,69 @@ Int_t TCUtils::ReadCommaSepList(const TString* s, Int_t* outList)
     return n;
 }
 
+//______________________________________________________________________________
+Int_t TCUtils::GetNumberOfThreads()
+{
+    // Return the number of worker threads to use. This is the value of the
+    // configuration key 'Misc.Threads' or the number of CPUs if not set.
+
+    // read from configuration
+    static Int_t h = TCReadConfig::GetReader()->GetHandle("Misc.Threads", kConfigInt);
+    Int_t n = TCReadConfig::GetReader()->GetInt(h);
+    if (n > 0) return n;
+
+    // use number of CPUs
+    SysInfo_t info;
+    if (!gSystem->GetSysInfo(&info) && info.fCpus > 0) return info.fCpus;
+    else return 1;
+}
+
+//______________________________________________________________________________
+void TCUtils::ParallelFor(Int_t n, void (*func)(Int_t, void*), void* arg, Int_t nThreads)
+{
+    // Call 'func'(i, 'arg') for all indices i from 0 to 'n'-1 using 'nThreads'
+    // worker threads (see GetNumberOfThreads() if 'nThreads' is 0). The calls
+    // are distributed dynamically and can be executed in any order, hence
+    // 'func' must be thread-safe (no histogram fitting via MINUIT, no gROOT
+    // or gDirectory access).
+
+    // get number of threads
+    if (nThreads <= 0) nThreads = GetNumberOfThreads();
+    if (nThreads > n) nThreads = n;
+
+    // run sequentially
+    if (nThreads <= 1)
+    {
+        for (Int_t i = 0; i < n; i++) func(i, arg);
+        return;
+    }
+
+    // prepare task
+    TThread::Initialize();
+    TMutex mutex;
+    ParallelForTask task;
+    task.n = n;
+    task.next = 0;
+    task.mutex = &mutex;
+    task.func = func;
+    task.arg = arg;
+
+    // start worker threads
+    TThread** threads = new TThread*[nThreads];
+    for (Int_t i = 0; i < nThreads; i++)
+    {
+        threads[i] = new TThread(TString::Format("TCUtils_ParallelFor_%d", i).Data(),
+                                 ParallelForWorker, &task);
+        threads[i]->Run();
+    }
+
+    // wait for worker threads
+    for (Int_t i = 0; i < nThreads; i++)
+    {
+        threads[i]->Join();
+        delete threads[i];
+    }
+
+    // clean-up
+    delete [] threads;
+}
@@ -11,17 +11,203 @@
 //////////////////////////////////////////////////////////////////////////
 
 
-#include <fstream>
-
 #include "TError.h"
 #include "TString.h"
+#include "TMath.h"
+#include "TMD5.h"
 
 #include "TCWriteARCalib.h"
 #include "TCMySQLManager.h"
 #include "TCReadARCalib.h"
+#include "TCUtils.h"
 
 ClassImp(TCWriteARCalib)
 
+// types of the parameters written to the AcquRoot calibration files
+enum EARParType
+{
+    kAROffset,
+    kARTDCGain,
+    kARPedestal,
+    kARADCGain,
+    kAREnergyLow,
+    kARZ,
+    kARTWPar0,
+    kARTWPar1,
+    kARTWPar2,
+    kARTWPar3,
+    kARSGPedestal,
+    kARSGADCGain
+};
+
+// calibration data written to the AcquRoot calibration files
+struct ARCalibData
+{
+    CalibDetector_t det;                // detector
+    const Char_t* data;                 // calibration data
+    EARParType type;                    // parameter type
+};
+
+// calibration data of all detectors (in the order of the read-out)
+static const ARCalibData gARCalibData[] =
+{
+    { kDETECTOR_TAGG,  "Data.Tagger.T0",    kAROffset },
+    { kDETECTOR_CB,    "Data.CB.T0",        kAROffset },
+    { kDETECTOR_CB,    "Data.CB.E1",        kARADCGain },
+    { kDETECTOR_CB,    "Data.CB.Walk.Par0", kARTWPar0 },
+    { kDETECTOR_CB,    "Data.CB.Walk.Par1", kARTWPar1 },
+    { kDETECTOR_CB,    "Data.CB.Walk.Par2", kARTWPar2 },
+    { kDETECTOR_CB,    "Data.CB.Walk.Par3", kARTWPar3 },
+    { kDETECTOR_TAPS,  "Data.TAPS.T0",      kAROffset },
+    { kDETECTOR_TAPS,  "Data.TAPS.T1",      kARTDCGain },
+    { kDETECTOR_TAPS,  "Data.TAPS.LG.E0",   kARPedestal },
+    { kDETECTOR_TAPS,  "Data.TAPS.LG.E1",   kARADCGain },
+    { kDETECTOR_TAPS,  "Data.TAPS.CFD",     kAREnergyLow },
+    { kDETECTOR_TAPS,  "Data.TAPS.SG.E0",   kARSGPedestal },
+    { kDETECTOR_TAPS,  "Data.TAPS.SG.E1",   kARSGADCGain },
+    { kDETECTOR_PID,   "Data.PID.Phi",      kARZ },
+    { kDETECTOR_PID,   "Data.PID.T0",       kAROffset },
+    { kDETECTOR_PID,   "Data.PID.E0",       kARPedestal },
+    { kDETECTOR_PID,   "Data.PID.E1",       kARADCGain },
+    { kDETECTOR_VETO,  "Data.Veto.T0",      kAROffset },
+    { kDETECTOR_VETO,  "Data.Veto.T1",      kARTDCGain },
+    { kDETECTOR_VETO,  "Data.Veto.E0",      kARPedestal },
+    { kDETECTOR_VETO,  "Data.Veto.E1",      kARADCGain },
+    { kDETECTOR_VETO,  "Data.Veto.LED",     kAREnergyLow },
+    { kDETECTOR_PIZZA, "Data.Pizza.Phi",    kARZ },
+    { kDETECTOR_PIZZA, "Data.Pizza.T0",     kAROffset },
+    { kDETECTOR_PIZZA, "Data.Pizza.E0",     kARPedestal },
+    { kDETECTOR_PIZZA, "Data.Pizza.E1",     kARADCGain }
+};
+static const Int_t gNARCalibData = sizeof(gARCalibData) / sizeof(ARCalibData);
+
+// fields of the parameter types in the element or time walk tables
+static const Int_t gARParField[] =
+{
+    kARELEM_OFFSET, kARELEM_TDCGAIN, kARELEM_PED, kARELEM_ADCGAIN, kARELEM_ELOW, kARELEM_Z,
+    kARTW_PAR0, kARTW_PAR1, kARTW_PAR2, kARTW_PAR3,
+    kARELEM_PED, kARELEM_ADCGAIN
+};
+
+// output formats of the parameter types (precision of TCARElement::Format()
+// and TCARTimeWalk::Format())
+static const Char_t* gARParFormat[] =
+{
+    "%.2lf", "%.6lf", "%.2lf", "%.6lf", "%.3lf", "%.3lf",
+    "%.6lf", "%.6lf", "%.6lf", "%.6lf",
+    "%.2lf", "%.6lf"
+};
+
+// changed fields of a template file
+struct ARPatches
+{
+    Int_t n;                            // number of changed fields
+    Int_t* start;                       // positions of the fields in the template
+    Int_t* length;                      // lengths of the fields in the template
+    Int_t* textStart;                   // positions of the new fields in 'text'
+    Int_t* textLength;                  // lengths of the new fields
+    TString text;                       // new fields
+};
+
+// sets of one calibration data read by TCWriteARCalib::WriteRuns()
+struct ARSetCache
+{
+    const ARCalibData* data;            // calibration data
+    Int_t npar;                         // number of parameters per set
+    Int_t nsets;                        // number of sets
+    Int_t* first;                       // first runs of the sets
+    Int_t* last;                        // last runs of the sets
+    Double_t* par;                      // parameters of the sets
+};
+
+// output file of TCWriteARCalib::WriteRuns()
+struct ARFileJob
+{
+    TString name;                       // file name
+    const TString* content;             // file content
+    Bool_t written;                     // written flag
+    Bool_t error;                       // error flag
+};
+
+//______________________________________________________________________________
+static Int_t FindARSet(const ARSetCache* c, Int_t run)
+{
+    // Return the index of the set of 'c' containing the run 'run' or -1 if
+    // no set contains the run.
+
+    for (Int_t i = 0; i < c->nsets; i++)
+        if (c->first[i] <= run && run <= c->last[i]) return i;
+
+    return -1;
+}
+
+//______________________________________________________________________________
+static void AddARPatch(ARPatches& p, const Char_t* buffer, Int_t start, Int_t length,
+                       const Char_t* format, Double_t value)
+{
+    // Add the field at the position 'start' of length 'length' in the
+    // template 'buffer' with the new value 'value' formatted using 'format'
+    // to the changed fields 'p'. The new field is right-aligned to the width
+    // of the template field. Fields whose formatted value equals the
+    // template text are not added.
+
+    // format the value
+    Char_t tmp[64];
+    Int_t n = snprintf(tmp, sizeof(tmp), format, value);
+    if (n < 0 || n >= (Int_t)sizeof(tmp)) return;
+
+    // skip unchanged text
+    if (n == length && !strncmp(tmp, buffer + start, length)) return;
+
+    // add the field
+    p.start[p.n] = start;
+    p.length[p.n] = length;
+    p.textStart[p.n] = p.text.Length();
+    if (n < length) p.text.Append(' ', length - n);
+    p.text.Append(tmp, n);
+    p.textLength[p.n] = p.text.Length() - p.textStart[p.n];
+    p.n++;
+}
+
+//______________________________________________________________________________
+static void WriteARFile(Int_t i, void* arg)
+{
+    // Write the output file 'i' of the file jobs 'arg' unless the existing
+    // file has the same content hash. Executed in parallel by
+    // TCWriteARCalib::WriteRuns().
+
+    ARFileJob* job = &((ARFileJob*)arg)[i];
+    const TString* content = job->content;
+
+    // hash the new content
+    TMD5 hashNew;
+    hashNew.Update((const UChar_t*)content->Data(), content->Length());
+    hashNew.Final();
+
+    // hash the existing file
+    FILE* fin = fopen(job->name.Data(), "rb");
+    if (fin)
+    {
+        TMD5 hashOld;
+        UChar_t buf[65536];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), fin)) > 0) hashOld.Update(buf, (UInt_t)n);
+        hashOld.Final();
+        fclose(fin);
+
+        // skip unchanged file
+        if (hashOld == hashNew) return;
+    }
+
+    // write the file
+    FILE* fout = fopen(job->name.Data(), "w");
+    if (!fout || fwrite(content->Data(), 1, content->Length(), fout) != (size_t)content->Length())
+        job->error = kTRUE;
+    else
+        job->written = kTRUE;
+    if (fout) fclose(fout);
+}
+
 //______________________________________________________________________________
 TCWriteARCalib::TCWriteARCalib(CalibDetector_t det, const Char_t* templateFile)
 {
@@ -30,195 +216,238 @@ TCWriteARCalib::TCWriteARCalib(CalibDetector_t det, const Char_t* templateFile)
     // init members
     fDetector = det;
     strcpy(fTemplate, templateFile);
+    fReader = 0;
+    fReaderSG = 0;
+    for (Int_t i = 0; i < kARELEM_NFIELD; i++) fElem[i] = fSG[i] = 0;
+    for (Int_t i = 0; i < kARTW_NFIELD; i++) fTW[i] = 0;
 }
 
 //______________________________________________________________________________
-void TCWriteARCalib::Write(const Char_t* calibFile,
-                           const Char_t* calibration, Int_t run)
+TCWriteARCalib::~TCWriteARCalib()
 {
-    // Write the calibration file 'calibFile' for the run 'run' using the
-    // calibration 'calibration'.
+    // Destructor.
 
-    // get MySQL manager
-    TCMySQLManager* m = TCMySQLManager::GetManager();
+    if (fReader) delete fReader;
+    if (fReaderSG) delete fReaderSG;
+    for (Int_t i = 0; i < kARELEM_NFIELD; i++)
+    {
+        if (fElem[i]) delete [] fElem[i];
+        if (fSG[i]) delete [] fSG[i];
+    }
+    for (Int_t i = 0; i < kARTW_NFIELD; i++)
+        if (fTW[i]) delete [] fTW[i];
+}
 
-    // read the template file
+//______________________________________________________________________________
+Bool_t TCWriteARCalib::ReadTemplate()
+{
+    // Read and parse the template file if this was not done before.
+    // Return kFALSE if an error occurred, otherwise kTRUE.
+
+    // check if already read
+    if (fReader) return kTRUE;
+
+    // read the template elements
     Bool_t isTagger = kFALSE;
     if (fDetector == kDETECTOR_TAGG) isTagger = kTRUE;
     TCReadARCalib* r = new TCReadARCalib(fTemplate, isTagger);
 
+    // check if file was read
+    if (!r->GetBuffer())
+    {
+        Error("ReadTemplate", "Could not open template AcquRoot calibration file!");
+        delete r;
+        return kFALSE;
+    }
+    fReader = r;
+
     // read SG for TAPS
-    TCReadARCalib* rSG = 0;
     if (fDetector == kDETECTOR_TAPS)
-        rSG = new TCReadARCalib(fTemplate, kFALSE, "TAPSSG:");
+        fReaderSG = new TCReadARCalib(fTemplate, kFALSE, "TAPSSG:");
+
+    // create the tables of the current values
+    Int_t nElem = fReader->GetNelements();
+    Int_t nTW = fReader->GetNtimeWalks();
+    Int_t nSG = fReaderSG ? fReaderSG->GetNelements() : 0;
+    for (Int_t i = 0; i < kARELEM_NFIELD; i++)
+    {
+        fElem[i] = new Double_t[nElem];
+        fSG[i] = new Double_t[nSG];
+    }
+    for (Int_t i = 0; i < kARTW_NFIELD; i++) fTW[i] = new Double_t[nTW];
 
-    // get the number of detectors
-    Int_t nDet = r->GetNelements();
-    Int_t nDetTW = r->GetNtimeWalks();
-    Int_t nDetSG = 0;
-    if (rSG) nDetSG = rSG->GetNelements();
+    return kTRUE;
+}
 
-    // create parameter array
-    Double_t par[nDet];
+//______________________________________________________________________________
+void TCWriteARCalib::ResetParameters()
+{
+    // Reset the current values to the values of the template file.
 
-    // check the detetector
-    switch (fDetector)
+    Int_t nElem = fReader->GetNelements();
+    Int_t nTW = fReader->GetNtimeWalks();
+    Int_t nSG = fReaderSG ? fReaderSG->GetNelements() : 0;
+
+    for (Int_t i = 0; i < kARELEM_NFIELD; i++)
     {
-        case kDETECTOR_TAGG:
-        {
-            // read time offset
-            if (m->ReadParametersRun("Data.Tagger.T0", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetOffset(par[i]);
+        memcpy(fElem[i], fReader->GetElementValues((ARElementField_t)i), nElem*sizeof(Double_t));
+        if (nSG) memcpy(fSG[i], fReaderSG->GetElementValues((ARElementField_t)i), nSG*sizeof(Double_t));
+    }
+    for (Int_t i = 0; i < kARTW_NFIELD; i++)
+        memcpy(fTW[i], fReader->GetTimeWalkValues((ARTimeWalkField_t)i), nTW*sizeof(Double_t));
+}
 
-            break;
+//______________________________________________________________________________
+Int_t TCWriteARCalib::GetNParameters(Int_t type) const
+{
+    // Return the number of parameters of the parameter type 'type'.
 
-        }
-        case kDETECTOR_CB:
+    switch (type)
+    {
+        case kARTWPar0:
+        case kARTWPar1:
+        case kARTWPar2:
+        case kARTWPar3:
+            return fReader->GetNtimeWalks();
+        case kARSGPedestal:
+        case kARSGADCGain:
+            return fReaderSG ? fReaderSG->GetNelements() : 0;
+        default:
+            return fReader->GetNelements();
+    }
+}
+
+//______________________________________________________________________________
+void TCWriteARCalib::SetParameters(Int_t type, const Double_t* par)
+{
+    // Set the current values of the parameter type 'type' to 'par'.
+
+    Int_t n = GetNParameters(type);
+    if (type >= kARTWPar0 && type <= kARTWPar3)
+        memcpy(fTW[gARParField[type]], par, n*sizeof(Double_t));
+    else if (type == kARSGPedestal || type == kARSGADCGain)
+        memcpy(fSG[gARParField[type]], par, n*sizeof(Double_t));
+    else
+        memcpy(fElem[gARParField[type]], par, n*sizeof(Double_t));
+}
+
+//______________________________________________________________________________
+void TCWriteARCalib::Format(TString& out)
+{
+    // Create the calibration file content using the template file and the
+    // current values in 'out'. Only the fields whose value changed are
+    // replaced in the template, all other bytes are copied unchanged, i.e.,
+    // the template is reproduced exactly if no value changed.
+
+    const Char_t* buffer = fReader->GetBuffer();
+    Int_t size = (Int_t)fReader->GetFileSize();
+    Int_t nElem = fReader->GetNelements();
+    Int_t nTW = fReader->GetNtimeWalks();
+    Int_t nSG = fReaderSG ? fReaderSG->GetNelements() : 0;
+
+    // collect the changed fields
+    ARPatches p;
+    Int_t nMax = 6*nElem + 4*nTW + 2*nSG;
+    p.n = 0;
+    p.start = new Int_t[nMax > 0 ? nMax : 1];
+    p.length = new Int_t[nMax > 0 ? nMax : 1];
+    p.textStart = new Int_t[nMax > 0 ? nMax : 1];
+    p.textLength = new Int_t[nMax > 0 ? nMax : 1];
+    for (Int_t i = 0; i < gNARCalibData; i++)
+    {
+        if (gARCalibData[i].det != fDetector) continue;
+        EARParType type = gARCalibData[i].type;
+        Int_t f = gARParField[type];
+
+        // time walks
+        if (type >= kARTWPar0 && type <= kARTWPar3)
         {
-            // read time offset
-            if (m->ReadParametersRun("Data.CB.T0", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetOffset(par[i]);
-
-            // read ADC gain
-            if (m->ReadParametersRun("Data.CB.E1", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetADCGain(par[i]);
-
-            if (nDetTW)
-            {
-                // read time walk parameter 0
-                if (m->ReadParametersRun("Data.CB.Walk.Par0", calibration, run, par, nDetTW))
-                    for (Int_t i = 0; i < nDetTW; i++) r->GetTimeWalk(i)->SetPar0(par[i]);
-
-                // read time walk parameter 1
-                if (m->ReadParametersRun("Data.CB.Walk.Par1", calibration, run, par, nDetTW))
-                    for (Int_t i = 0; i < nDetTW; i++) r->GetTimeWalk(i)->SetPar1(par[i]);
-
-                // read time walk parameter 2
-                if (m->ReadParametersRun("Data.CB.Walk.Par2", calibration, run, par, nDetTW))
-                    for (Int_t i = 0; i < nDetTW; i++) r->GetTimeWalk(i)->SetPar2(par[i]);
-
-                // read time walk parameter 3
-                if (m->ReadParametersRun("Data.CB.Walk.Par3", calibration, run, par, nDetTW))
-                    for (Int_t i = 0; i < nDetTW; i++) r->GetTimeWalk(i)->SetPar3(par[i]);
-            }
-
-            break;
+            const Double_t* orig = fReader->GetTimeWalkValues((ARTimeWalkField_t)f);
+            for (Int_t j = 0; j < nTW; j++)
+                if (fTW[f][j] != orig[j])
+                    AddARPatch(p, buffer, fReader->GetTimeWalkFieldStart(j, (ARTimeWalkField_t)f),
+                               fReader->GetTimeWalkFieldLength(j, (ARTimeWalkField_t)f),
+                               gARParFormat[type], fTW[f][j]);
         }
-        case kDETECTOR_TAPS:
+        // TAPS SG elements (same file offsets as the elements)
+        else if (type == kARSGPedestal || type == kARSGADCGain)
         {
-            // read time offset
-            if (m->ReadParametersRun("Data.TAPS.T0", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetOffset(par[i]);
-
-            // read TDC gain
-            if (m->ReadParametersRun("Data.TAPS.T1", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetTDCGain(par[i]);
-
-            // read ADC pedestal
-            if (m->ReadParametersRun("Data.TAPS.LG.E0", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetPedestal(par[i]);
-
-            // read ADC gain
-            if (m->ReadParametersRun("Data.TAPS.LG.E1", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetADCGain(par[i]);
-
-            // read CFD threshold
-            if (m->ReadParametersRun("Data.TAPS.CFD", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetEnergyLow(par[i]);
-
-            if (nDetSG)
-            {
-                // read SG ADC pedestal
-                if (m->ReadParametersRun("Data.TAPS.SG.E0", calibration, run, par, nDetSG))
-                    for (Int_t i = 0; i < nDetSG; i++) rSG->GetElement(i)->SetPedestal(par[i]);
-
-                // read SG ADC gain
-                if (m->ReadParametersRun("Data.TAPS.SG.E1", calibration, run, par, nDetSG))
-                    for (Int_t i = 0; i < nDetSG; i++) rSG->GetElement(i)->SetADCGain(par[i]);
-            }
-
-            break;
+            const Double_t* orig = fReaderSG->GetElementValues((ARElementField_t)f);
+            for (Int_t j = 0; j < nSG; j++)
+                if (fSG[f][j] != orig[j])
+                    AddARPatch(p, buffer, fReaderSG->GetElementFieldStart(j, (ARElementField_t)f),
+                               fReaderSG->GetElementFieldLength(j, (ARElementField_t)f),
+                               gARParFormat[type], fSG[f][j]);
         }
-        case kDETECTOR_PID:
+        // elements
+        else
         {
-            // read phi angle
-            if (m->ReadParametersRun("Data.PID.Phi", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetZ(par[i]);
-
-            // read time offset
-            if (m->ReadParametersRun("Data.PID.T0", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetOffset(par[i]);
-
-            // read ADC pedestal
-            if (m->ReadParametersRun("Data.PID.E0", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetPedestal(par[i]);
-
-            // read ADC gain
-            if (m->ReadParametersRun("Data.PID.E1", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetADCGain(par[i]);
-
-            break;
+            const Double_t* orig = fReader->GetElementValues((ARElementField_t)f);
+            for (Int_t j = 0; j < nElem; j++)
+                if (fElem[f][j] != orig[j])
+                    AddARPatch(p, buffer, fReader->GetElementFieldStart(j, (ARElementField_t)f),
+                               fReader->GetElementFieldLength(j, (ARElementField_t)f),
+                               gARParFormat[type], fElem[f][j]);
         }
-        case kDETECTOR_VETO:
-        {
-            // read time offset
-            if (m->ReadParametersRun("Data.Veto.T0", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetOffset(par[i]);
-
-            // read TDC gain
-            if (m->ReadParametersRun("Data.Veto.T1", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetTDCGain(par[i]);
-
-            // read ADC pedestal
-            if (m->ReadParametersRun("Data.Veto.E0", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetPedestal(par[i]);
-
-            // read ADC gain
-            if (m->ReadParametersRun("Data.Veto.E1", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetADCGain(par[i]);
+    }
 
-            // read LED thresholds
-            if (m->ReadParametersRun("Data.Veto.LED", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetEnergyLow(par[i]);
+    // sort the changed fields by their position
+    Int_t* index = new Int_t[p.n > 0 ? p.n : 1];
+    TMath::Sort(p.n, p.start, index, kFALSE);
 
-            break;
-        }
-        case kDETECTOR_PIZZA:
-        {
-            // read phi angle
-            if (m->ReadParametersRun("Data.Pizza.Phi", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetZ(par[i]);
+    // copy the unchanged regions and the new fields
+    out = "";
+    out.Capacity(size + p.text.Length());
+    Int_t pos = 0;
+    for (Int_t i = 0; i < p.n; i++)
+    {
+        Int_t k = index[i];
+        out.Append(buffer + pos, p.start[k] - pos);
+        out.Append(p.text.Data() + p.textStart[k], p.textLength[k]);
+        pos = p.start[k] + p.length[k];
+    }
+    out.Append(buffer + pos, size - pos);
 
-            // read time offset
-            if (m->ReadParametersRun("Data.Pizza.T0", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetOffset(par[i]);
+    // clean-up
+    delete [] p.start;
+    delete [] p.length;
+    delete [] p.textStart;
+    delete [] p.textLength;
+    delete [] index;
+}
 
-            // read ADC pedestal
-            if (m->ReadParametersRun("Data.Pizza.E0", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetPedestal(par[i]);
+//______________________________________________________________________________
+void TCWriteARCalib::Write(const Char_t* calibFile,
+                           const Char_t* calibration, Int_t run)
+{
+    // Write the calibration file 'calibFile' for the run 'run' using the
+    // calibration 'calibration'.
 
-            // read ADC gain
-            if (m->ReadParametersRun("Data.Pizza.E1", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetADCGain(par[i]);
+    // get MySQL manager
+    TCMySQLManager* m = TCMySQLManager::GetManager();
 
-            break;
-        }
-        case kDETECTOR_NODET:
-        {
-            break;
-        }
-    }
+    // read the template file
+    if (!ReadTemplate()) return;
+    ResetParameters();
 
-    // open the template file
-    std::ifstream ftemp;
-    ftemp.open(fTemplate);
+    // create parameter array
+    Int_t nMax = TMath::Max(fReader->GetNelements(), fReader->GetNtimeWalks());
+    if (fReaderSG) nMax = TMath::Max(nMax, fReaderSG->GetNelements());
+    Double_t* par = new Double_t[nMax > 0 ? nMax : 1];
 
-    // check if file is open
-    if (!ftemp.is_open())
+    // read the parameters of the detector
+    for (Int_t i = 0; i < gNARCalibData; i++)
     {
-        Error("Write", "Could not open template AcquRoot calibration file!");
-        return;
+        if (gARCalibData[i].det != fDetector) continue;
+        Int_t n = GetNParameters(gARCalibData[i].type);
+        if (n && m->ReadParametersRun(gARCalibData[i].data, calibration, run, par, n))
+            SetParameters(gARCalibData[i].type, par);
     }
+    delete [] par;
+
+    // format the file
+    TString out;
+    Format(out);
 
     // open the output file
     FILE* fout = fopen(calibFile, "w");
@@ -227,47 +456,157 @@ void TCWriteARCalib::Write(const Char_t* calibFile,
         return;
     }
 
-    // read template file
-    Char_t out[245];
-    Int_t nElem = 0;
-    Int_t nElemTW = 0;
-    Int_t nElemSG = 0;
+    // write and close the file
+    fwrite(out.Data(), 1, out.Length(), fout);
+    fclose(fout);
+}
 
-    // read the file
-    while (ftemp.good())
+//______________________________________________________________________________
+Int_t TCWriteARCalib::WriteRuns(const Char_t* calibFiles, const Char_t* calibration,
+                                Int_t first_run, Int_t last_run, Bool_t perRun)
+{
+    // Write the calibration files for the runs 'first_run' to 'last_run' using
+    // the calibration 'calibration'. The template file is parsed once and the
+    // run ranges and parameters of all sets of a calibration data are read
+    // with one query.
+    // One file is created for each distinct combination of sets of the
+    // calibration data of the detector and named after its first run, or,
+    // if 'perRun' is kTRUE, one file for each run of the calibration. The
+    // file names are created by formatting the run number with 'calibFiles'
+    // (e.g. 'NaI_%d.dat').
+    // The files are written in parallel (see TCUtils::ParallelFor()). Files
+    // whose content hash equals the one of the new content are not written.
+    // Return the number of written files or -1 if an error occurred.
+
+    // get MySQL manager
+    TCMySQLManager* m = TCMySQLManager::GetManager();
+
+    // read the template file
+    if (!ReadTemplate()) return -1;
+
+    // read the sets of the calibration data of the detector
+    ARSetCache cache[gNARCalibData];
+    Int_t nCache = 0;
+    Int_t nSetsTot = 0;
+    for (Int_t i = 0; i < gNARCalibData; i++)
     {
-        TString line;
-        line.ReadLine(ftemp, kFALSE);
+        if (gARCalibData[i].det != fDetector) continue;
+        Int_t n = GetNParameters(gARCalibData[i].type);
+        if (!n) continue;
+
+        // read the set ranges and parameters
+        ARSetCache& c = cache[nCache++];
+        c.data = &gARCalibData[i];
+        c.npar = n;
+        c.nsets = m->ReadSets(c.data->data, calibration, c.first, c.last, c.par, n);
+        if (c.nsets < 0) c.nsets = 0;
+        nSetsTot += c.nsets;
+    }
 
-        // check for element line
-        if(line.BeginsWith("Element:"))
+    // collect the boundaries of the distinct set combinations
+    Int_t* bound = new Int_t[2*nSetsTot + 2];
+    Int_t nBound = 0;
+    bound[nBound++] = first_run;
+    bound[nBound++] = last_run + 1;
+    for (Int_t i = 0; i < nCache; i++)
+    {
+        for (Int_t j = 0; j < cache[i].nsets; j++)
         {
-            r->GetElement(nElem++)->Format(out);
-            fprintf(fout, "Element: %s\n", out);
+            if (cache[i].first[j] > first_run && cache[i].first[j] <= last_run)
+                bound[nBound++] = cache[i].first[j];
+            if (cache[i].last[j] >= first_run && cache[i].last[j] < last_run)
+                bound[nBound++] = cache[i].last[j] + 1;
         }
-        else if(line.BeginsWith("TimeWalk:"))
+    }
+    Int_t* index = new Int_t[nBound];
+    TMath::Sort(nBound, bound, index, kFALSE);
+    Int_t* start = new Int_t[nBound];
+    Int_t nSeg = 0;
+    for (Int_t i = 0; i < nBound; i++)
+        if (!nSeg || bound[index[i]] != start[nSeg-1]) start[nSeg++] = bound[index[i]];
+    nSeg--;
+
+    // format the files of the set combinations (the last entry of 'start'
+    // is the end of the run range)
+    TString* content = new TString[nSeg > 0 ? nSeg : 1];
+    Bool_t* covered = new Bool_t[nSeg > 0 ? nSeg : 1];
+    for (Int_t i = 0; i < nSeg; i++)
+    {
+        ResetParameters();
+        covered[i] = kFALSE;
+        for (Int_t j = 0; j < nCache; j++)
         {
-            r->GetTimeWalk(nElemTW++)->Format(out);
-            fprintf(fout, "TimeWalk: %s\n", out);
+            Int_t set = FindARSet(&cache[j], start[i]);
+            if (set < 0) continue;
+            SetParameters(cache[j].data->type, cache[j].par + set*cache[j].npar);
+            covered[i] = kTRUE;
         }
-        else if(line.BeginsWith("TAPSSG:"))
+        if (covered[i]) Format(content[i]);
+    }
+
+    // create the file jobs
+    Int_t nRuns = 0;
+    Int_t* runs = perRun ? m->GetRunsOfCalibration(calibration, &nRuns) : 0;
+    Int_t nJobMax = perRun ? nRuns : nSeg;
+    ARFileJob* jobs = new ARFileJob[nJobMax > 0 ? nJobMax : 1];
+    Int_t nJob = 0;
+    if (perRun)
+    {
+        for (Int_t i = 0; i < nRuns; i++)
         {
-            rSG->GetElement(nElemSG++)->Format(out);
-            fprintf(fout, "TAPSSG: %s\n", out);
+            if (runs[i] < first_run || runs[i] > last_run) continue;
+            Int_t seg = TMath::BinarySearch(nSeg, start, runs[i]);
+            if (seg < 0 || seg >= nSeg || !covered[seg]) continue;
+            jobs[nJob].name = TString::Format(calibFiles, runs[i]);
+            jobs[nJob].content = &content[seg];
+            nJob++;
         }
-        else
+    }
+    else
+    {
+        for (Int_t i = 0; i < nSeg; i++)
         {
-            // write normal line
-            fprintf(fout, "%s\n", line.Data());
+            if (!covered[i]) continue;
+            jobs[nJob].name = TString::Format(calibFiles, start[i]);
+            jobs[nJob].content = &content[i];
+            nJob++;
         }
     }
+    for (Int_t i = 0; i < nJob; i++) jobs[i].written = jobs[i].error = kFALSE;
 
-    // close the files
-    ftemp.close();
-    fclose(fout);
+    // write the files
+    TCUtils::ParallelFor(nJob, WriteARFile, jobs);
+
+    // check the results
+    Int_t nWritten = 0;
+    Int_t nError = 0;
+    for (Int_t i = 0; i < nJob; i++)
+    {
+        if (jobs[i].written) nWritten++;
+        if (jobs[i].error)
+        {
+            Error("WriteRuns", "Could not write AcquRoot calibration file '%s'!", jobs[i].name.Data());
+            nError++;
+        }
+    }
+    Info("WriteRuns", "Wrote %d of %d AcquRoot calibration files (%d set combinations, %d unchanged)",
+         nWritten, nJob, nSeg, nJob - nWritten - nError);
 
     // clean-up
-    delete r;
-    if (rSG) delete rSG;
+    for (Int_t i = 0; i < nCache; i++)
+    {
+        delete [] cache[i].first;
+        delete [] cache[i].last;
+        delete [] cache[i].par;
+    }
+    delete [] bound;
+    delete [] index;
+    delete [] start;
+    delete [] content;
+    delete [] covered;
+    delete [] jobs;
+    if (runs) delete [] runs;
+
+    return nError ? -1 : nWritten;
 }
 